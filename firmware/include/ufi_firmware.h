@@ -62,7 +62,8 @@ typedef enum {
     CAPTURE_WAITING_INDEX,  // Warte auf Index-Puls
     CAPTURE_RUNNING,        // Erfasse Flux-Daten
     CAPTURE_COMPLETE,       // Track fertig
-    CAPTURE_ERROR
+    CAPTURE_ERROR,
+    CAPTURE_SEEKING         // Kopf fährt (nicht-blockierend), danach Start
 } capture_state_t;
 
 typedef struct {
@@ -102,6 +103,30 @@ typedef struct {
     uint16_t rpm;           // Gemessene Drehzahl
 } drive_status_t;
 
+// Überwachte Laufwerk-Signale (Event-Bitmaske)
+#define DRIVE_SIG_DISK_CHANGE   (1 << 0)
+#define DRIVE_SIG_READY         (1 << 1)
+#define DRIVE_SIG_WRITE_PROT    (1 << 2)
+#define DRIVE_SIG_INDEX         (1 << 3)    // Index-Pulse vorhanden
+
+// Drehzahl-Monitor (Index-Perioden im Hintergrund, ufi_drive.c)
+#define RPM_WINDOW          32      // Perioden im Fenster (Zweierpotenz)
+#define RPM_FLUTTER_BINS    (RPM_WINDOW / 2)
+
+typedef struct __packed {
+    uint16_t samples;               // Perioden im Fenster (0 = kein Index)
+    uint16_t bins;                  // Gültige Flutter-Bins (nur volles Fenster)
+    uint32_t period_last_ns;
+    uint32_t period_mean_ns;
+    uint32_t period_min_ns;
+    uint32_t period_max_ns;
+    uint32_t period_std_ns;
+    uint32_t rpm_x100;              // Mittlere Drehzahl × 100
+    uint32_t wow_rms_ppm;           // Standardabweichung / Mittel
+    uint32_t wow_pp_ppm;            // (Max - Min) / Mittel
+    uint16_t flutter_ppm[RPM_FLUTTER_BINS]; // Amplitude Bin k = k/RPM_WINDOW pro Umdrehung
+} rpm_monitor_t;
+
 // Laufwerk-Befehle
 typedef enum {
     CMD_MOTOR_ON,
@@ -114,6 +139,50 @@ typedef enum {
     CMD_RECALIBRATE         // Zu Track 0 fahren
 } drive_command_t;
 
+/* ============================================================================
+ * IEC LEITUNGSTREIBER (direkte Register, Port D)
+ * ============================================================================ */
+
+#define IEC_PORT            GPIOD
+#define IEC_ATN_PIN         GPIO_PIN_0
+#define IEC_CLK_PIN         GPIO_PIN_1
+#define IEC_DATA_PIN        GPIO_PIN_2
+#define IEC_SRQ_PIN         GPIO_PIN_3
+#define IEC_RESET_PIN       GPIO_PIN_4
+#define IEC_BUS_PINS        (IEC_ATN_PIN | IEC_CLK_PIN | IEC_DATA_PIN | IEC_SRQ_PIN)
+
+/**
+ * Leitungen mit einem BSRR-Zugriff freigeben (high) und ziehen (low).
+ * Open-Drain: beide Änderungen werden im selben Takt wirksam.
+ */
+static inline void iec_lines_set(uint16_t release, uint16_t pull) {
+    IEC_PORT->BSRR = release | ((uint32_t)pull << 16);
+}
+
+/**
+ * Gezogene (low) Bus-Leitungen als Bitmaske, alle im selben IDR-Zugriff
+ */
+static inline uint16_t iec_lines_asserted(void) {
+    return (uint16_t)(~IEC_PORT->IDR) & IEC_BUS_PINS;
+}
+
+// Asynchroner Empfang/Versand (TIM7 Tick, ufi_iec.c)
+#define IEC_RX_TICK_US      5       // Abtastraster der Sende-/Empfangs-State-Machine
+
+// Flags für ufi_iec_tx_start()
+#define IEC_TX_ATN          0x01    // Vorher ATN ziehen (Befehlsbytes)
+#define IEC_TX_EOI          0x02    // EOI mit dem letzten Byte
+#define IEC_TX_RELEASE_ATN  0x04    // Danach ATN freigeben
+#define IEC_TX_TURNAROUND   0x08    // Danach Turnaround (nach TALK)
+
+// Status von Empfangs- und Sendejob
+typedef enum {
+    IEC_RX_IDLE = 0,
+    IEC_RX_BUSY,
+    IEC_RX_DONE,                    // EOI empfangen
+    IEC_RX_ERROR
+} iec_rx_status_t;
+
 /* ============================================================================
  * USB PROTOKOLL (zu CM5)
  * ============================================================================ */
@@ -128,6 +197,8 @@ typedef enum {
     UFI_CMD_NOP             = 0x00,
     UFI_CMD_GET_INFO        = 0x01,
     UFI_CMD_GET_STATUS      = 0x02,
+    UFI_CMD_SET_EVENTS      = 0x03, // [mask] DRIVE_SIG_* Events an/aus
+    UFI_CMD_GET_TELEMETRY   = 0x04, // [reset] → ufi_telemetry_t, 1 = danach nullen
     
     // Laufwerk-Steuerung
     UFI_CMD_SELECT_DRIVE    = 0x10,
@@ -136,6 +207,7 @@ typedef enum {
     UFI_CMD_SEEK            = 0x13,
     UFI_CMD_RECALIBRATE     = 0x14,
     UFI_CMD_SELECT_SIDE     = 0x15,
+    UFI_CMD_SEEK_QTRACK     = 0x16, // Apple II: Viertel-Track
     
     // Flux-Capture
     UFI_CMD_READ_TRACK      = 0x20,
@@ -151,16 +223,34 @@ typedef enum {
     UFI_CMD_IEC_RESET       = 0x40,
     UFI_CMD_IEC_SEND        = 0x41,
     UFI_CMD_IEC_RECEIVE     = 0x42,
+    UFI_CMD_IEC_LISTEN      = 0x43, // [dev, sa] LISTEN + Secondary
+    UFI_CMD_IEC_TALK        = 0x44, // [dev, sa] TALK + Secondary + Turnaround
+    UFI_CMD_IEC_UNLISTEN    = 0x45,
+    UFI_CMD_IEC_UNTALK      = 0x46,
+    UFI_CMD_IEC_SEND_BUF    = 0x47, // [eoi, len_lo, len_hi, data...]
+    UFI_CMD_IEC_RECV_BUF    = 0x48, // [max_lo, max_hi] bis EOI → Daten
+    UFI_CMD_IEC_LOAD        = 0x49, // [dev, name_len, name...] → Datei
+    UFI_CMD_IEC_MEM_WRITE   = 0x4A, // [dev, addr_lo, addr_hi, len, data...] M-W
+    UFI_CMD_IEC_MEM_EXEC    = 0x4B, // [dev, addr_lo, addr_hi] M-E
+    UFI_CMD_IEC_FAST_LOAD   = 0x4C, // [dev, name_len, name...] → [jiffy, Datei]
+    UFI_CMD_IEC_FAST_RECV   = 0x4D, // [mode, cnt_lo, cnt_hi] → Daten
+    UFI_CMD_IEC_DISK_BEGIN  = 0x4E, // [dev, type] Drive-Code hochladen
+    UFI_CMD_IEC_DISK_TRACK  = 0x4F, // [track, side] → n × [sec, status, 256]
     
     // Debug
     UFI_CMD_DEBUG_GPIO      = 0xD0,
-    UFI_CMD_DEBUG_TIMER     = 0xD1,
+    UFI_CMD_DEBUG_TIMER     = 0xD1, // [sub] 0-3 Messung, 4 Trace [op], 5 Trace-Dump
     
     // System
     UFI_CMD_RESET           = 0xF0,
     UFI_CMD_BOOTLOADER      = 0xFF
 } ufi_command_t;
 
+// Asynchrone Events (ohne Befehl, gleicher Header wie Antworten)
+typedef enum {
+    UFI_EVT_DRIVE_SIGNALS   = 0xE0
+} ufi_event_t;
+
 // Antwort-Header
 typedef struct __packed {
     uint8_t command;        // Echo des Befehls
@@ -168,6 +258,15 @@ typedef struct __packed {
     uint16_t length;        // Länge der Daten
 } ufi_response_header_t;
 
+// Event-Daten UFI_EVT_DRIVE_SIGNALS
+typedef struct __packed {
+    uint8_t drive;          // drive_type_t
+    uint8_t signals;        // Aktueller Zustand (DRIVE_SIG_*)
+    uint8_t changed;        // Geänderte Bits
+    uint8_t reserved;
+    uint32_t timestamp_ms;  // HAL_GetTick()
+} drive_event_t;
+
 // Flux-Daten Paket
 typedef struct __packed {
     uint8_t track;
@@ -191,10 +290,12 @@ void ufi_usb_init(void);
 
 // Hauptschleife
 void ufi_main_loop(void);
+void ufi_main_poll(void);       // Ein Scheduler-Durchlauf
 
 // Flux-Capture
 int ufi_capture_start(uint8_t track, uint8_t side, uint8_t revolutions);
 int ufi_capture_abort(void);
+void ufi_capture_poll(void);
 capture_state_t ufi_capture_get_state(void);
 flux_revolution_t* ufi_capture_get_data(uint8_t revolution);
 
@@ -206,16 +307,115 @@ int ufi_drive_seek(uint8_t track);
 int ufi_drive_recalibrate(void);
 int ufi_drive_select_side(uint8_t side);
 drive_status_t ufi_drive_get_status(void);
+drive_type_t ufi_drive_get_current(void);
+
+// Apple Disk II (Viertel-Track Positionierung)
+int ufi_drive_apple_step(int direction);
+int ufi_drive_apple_seek_qtrack(uint16_t qtrack);
+uint16_t ufi_drive_apple_get_qtrack(void);
+int ufi_drive_apple_recalibrate(void);
+
+// Spin-up Erkennung (Index-Periode statt fester Wartezeit)
+void ufi_drive_index_event(uint32_t cycles);  // aus EXTI0 (DWT-Zeitstempel)
+int ufi_drive_wait_spinup(uint32_t timeout_ms, uint16_t* rpm);
+int ufi_drive_spinup_poll(uint16_t* rpm);
+void ufi_drive_rpm_monitor(rpm_monitor_t* out);
+void ufi_drive_set_spinup_timeout(uint16_t timeout_ms);
+int ufi_drive_seek_begin(uint8_t track);
+int ufi_drive_seek_poll(void);
+
+// Signal-Events (EXTI, asynchron an CM5)
+void ufi_drive_events_init(void);
+void ufi_drive_signal_irq(void);
+uint8_t ufi_drive_read_signals(void);
+void ufi_drive_set_event_mask(uint8_t mask);
+void ufi_drive_poll_events(void);
+bool ufi_drive_at_track0(void);
+bool ufi_drive_disk_changed(void);
+bool ufi_drive_ready(void);
+bool ufi_drive_write_protected(void);
 
 // IEC Bus (C64)
 int ufi_iec_reset(void);
 int ufi_iec_send_byte(uint8_t byte, bool eoi);
-int ufi_iec_receive_byte(uint8_t* byte);
+int ufi_iec_receive_byte(uint8_t* byte, bool* eoi);
 int ufi_iec_atn(bool state);
 
+// IEC Transaktionen (ein USB-Roundtrip pro Transaktion)
+#define IEC_XFER_BUFFER_SIZE    65535   // Max. Antwort-Länge (uint16_t)
+
+int ufi_iec_listen_sa(uint8_t device, uint8_t sa);
+int ufi_iec_talk_sa(uint8_t device, uint8_t sa);
+int ufi_iec_unlisten(void);
+int ufi_iec_untalk(void);
+int ufi_iec_send_buffer(const uint8_t* data, uint32_t len, bool eoi_last);
+int ufi_iec_receive_buffer(uint8_t* buffer, uint32_t max_len, uint32_t* len);
+int ufi_iec_load_file(uint8_t device, const char* name, uint8_t name_len,
+                      uint8_t* buffer, uint32_t max_len, uint32_t* len);
+int ufi_iec_load_begin(uint8_t device, const char* name, uint8_t name_len,
+                       uint8_t* buffer, uint32_t max_len);
+int ufi_iec_load_poll(uint32_t* len);
+int ufi_iec_rx_start(uint8_t* buffer, uint32_t max_len);
+iec_rx_status_t ufi_iec_rx_poll(uint32_t* len, int* error);
+void ufi_iec_rx_abort(void);
+int ufi_iec_tx_start(const uint8_t* data, uint32_t len, uint8_t flags);
+iec_rx_status_t ufi_iec_tx_poll(uint32_t* len, int* error);
+int ufi_iec_listen_sa_begin(uint8_t device, uint8_t sa);
+int ufi_iec_talk_sa_begin(uint8_t device, uint8_t sa);
+int ufi_iec_unlisten_begin(void);
+int ufi_iec_untalk_begin(void);
+int ufi_iec_open_begin(uint8_t device, uint8_t channel);
+int ufi_iec_close_begin(uint8_t device, uint8_t channel);
+int ufi_iec_command_begin(uint8_t device, const char* cmd, uint8_t len);
+int ufi_iec_command_poll(void);
+void ufi_iec_tick(void);
+int ufi_iec_listen(uint8_t device);
+int ufi_iec_open(uint8_t channel);
+int ufi_iec_close(uint8_t channel);
+int ufi_iec_command(uint8_t device, const char* cmd, uint8_t len);
+
+// IEC Fast-Transfer (ufi_iec_fast.c)
+typedef enum {
+    IEC_FAST_NONE       = 0,
+    IEC_FAST_JIFFY      = 1,    // JiffyDOS (Laufwerk-ROM)
+    IEC_FAST_UFI_2BIT   = 2     // 2-Bit mit hochgeladenem Drive-Code
+} iec_fast_mode_t;
+
+int ufi_iec_jiffy_atn_byte(uint8_t byte, bool* jiffy);
+int ufi_iec_jiffy_talk_sa(uint8_t device, uint8_t sa, bool* jiffy);
+int ufi_iec_fast_receive_byte(iec_fast_mode_t mode, uint8_t* byte, bool* eoi);
+int ufi_iec_fast_send_byte(iec_fast_mode_t mode, uint8_t byte);
+int ufi_iec_mem_write_begin(uint8_t device, uint16_t addr, const uint8_t* data, uint32_t len);
+int ufi_iec_mem_exec_begin(uint8_t device, uint16_t addr);
+int ufi_iec_fast_load_begin(uint8_t device, const char* name, uint8_t name_len,
+                            uint8_t* buffer, uint32_t max_len);
+bool ufi_iec_fast_load_jiffy(void);
+int ufi_iec_fast_recv_begin(iec_fast_mode_t mode, uint8_t* buffer,
+                            uint32_t max_len, uint32_t count);
+int ufi_iec_job_poll(uint32_t* len);
+int ufi_iec_read_block(uint8_t device, uint8_t track, uint8_t sector,
+                       uint8_t* buffer, uint16_t* len);
+int ufi_iec_read_status(uint8_t device, char* buffer, uint8_t max_len);
+
+// Disk-Image über IEC
+typedef enum {
+    IEC_DISK_NONE   = 0,
+    IEC_DISK_D64    = 1,    // 1541, 35 Tracks
+    IEC_DISK_D71    = 2,    // 1571, 2 × 35 Tracks
+    IEC_DISK_D81    = 3     // 1581, 80 Tracks × 40 Sektoren
+} iec_disk_type_t;
+
+int ufi_iec_disk_begin(uint8_t device, iec_disk_type_t type);
+int ufi_iec_disk_track_begin(uint8_t track, uint8_t side, uint8_t* buffer,
+                             uint32_t max_len);
+
 // USB Kommunikation
 int ufi_usb_send_flux(flux_packet_header_t* header, flux_sample_t* data);
+int ufi_usb_send_event(uint8_t event, const void* data, uint16_t len);
+void ufi_usb_flush(void);
 int ufi_usb_process_command(void);
+void ufi_usb_iec_poll(void);
+void ufi_usb_drive_poll(void);
 
 /* ============================================================================
  * WRITE SUPPORT (ufi_write.c)
@@ -224,9 +424,9 @@ int ufi_usb_process_command(void);
 // Write State Machine
 typedef enum {
     WRITE_IDLE,
-    WRITE_RECEIVING,
-    WRITE_WAITING_INDEX,
-    WRITE_ACTIVE,
+    WRITE_RECEIVING,        // Empfange Flux-Daten
+    WRITE_WAITING_INDEX,    // Warte auf Index für Sync
+    WRITE_ACTIVE,           // Schreibe Daten
     WRITE_COMPLETE,
     WRITE_VERIFYING,
     WRITE_ERROR
@@ -253,28 +453,28 @@ void ufi_write_set_precomp(bool enable);
 
 // GPIO Debug Strukturen
 typedef struct __packed {
-    uint16_t fdd_inputs;
-    uint16_t fdd_outputs;
-    uint16_t iec_signals;
-    uint16_t leds;
+    uint16_t fdd_inputs;    // Bit0=INDEX, Bit1=TRK0, Bit2=WPROT, Bit3=RDATA, Bit4=DKCHG
+    uint16_t fdd_outputs;   // Bit0=MOTOR_A, Bit1=MOTOR_B, Bit2=SEL_A, Bit3=SEL_B, etc.
+    uint16_t iec_signals;   // Bit0=ATN, Bit1=CLK, Bit2=DATA, Bit3=SRQ, Bit4=RESET
+    uint16_t leds;          // Bit0=PWR, Bit1=ACT, Bit2=FDD, Bit3=USB
 } gpio_status_t;
 
 typedef struct __packed {
-    uint32_t tim2_counter;
-    uint32_t tim2_prescaler;
-    uint32_t tim2_period;
-    uint32_t sysclk_freq;
-    uint32_t hclk_freq;
-    uint32_t pclk1_freq;
-    uint32_t uptime_ms;
+    uint32_t tim2_counter;      // Aktueller TIM2 Zählerwert
+    uint32_t tim2_prescaler;    // TIM2 Prescaler
+    uint32_t tim2_period;       // TIM2 Period
+    uint32_t sysclk_freq;       // System Clock Frequenz
+    uint32_t hclk_freq;         // AHB Clock
+    uint32_t pclk1_freq;        // APB1 Clock (Timer)
+    uint32_t uptime_ms;         // Uptime in ms
 } timer_status_t;
 
 typedef struct __packed {
-    uint32_t flash_size;
-    uint32_t ram_size;
-    uint32_t unique_id[3];
-    uint16_t revision;
-    uint16_t device_id;
+    uint32_t flash_size;        // Flash Größe in KB
+    uint32_t ram_size;          // RAM Größe (DTCM + SRAM)
+    uint32_t unique_id[3];      // 96-bit Unique ID
+    uint16_t revision;          // Device Revision
+    uint16_t device_id;         // Device ID
 } memory_info_t;
 
 // Debug Funktionen
@@ -287,6 +487,118 @@ memory_info_t ufi_debug_memory_read(void);
 void ufi_debug_led_test(void);
 uint8_t ufi_debug_selftest(void);
 
+/* ============================================================================
+ * ISR / MAIN-LOOP TRACE (ufi_trace.c)
+ * ============================================================================ */
+
+#define TRACE_RING_SIZE     1024        // Einträge (Zweierpotenz)
+
+// Trace-Quellen (Host: software/tools/ufi-trace)
+typedef enum {
+    TRACE_ID_EXTI0          = 0x01,     // Index-Puls
+    TRACE_ID_DMA1_S0        = 0x02,     // Flux-DMA
+    TRACE_ID_OTG_HS         = 0x03,     // USB
+    TRACE_ID_TIM2           = 0x04,     // Flux-Timer
+    TRACE_ID_TIM7           = 0x05,     // IEC Sende-/Empfangs-Tick
+    TRACE_ID_TASK           = 0x10,     // + Task-Index (Scheduler)
+    TRACE_ID_LOOP           = 0x20,     // Hauptschleifen-Durchlauf
+    TRACE_ID_USB_CMD        = 0x21,     // Befehl empfangen (arg = Befehl)
+    TRACE_ID_CAPTURE_ARM    = 0x22,     // DMA scharf (arg = Track)
+    TRACE_ID_CAPTURE_DONE   = 0x23,     // Revolution gesendet (arg = Rev)
+} trace_id_t;
+
+typedef enum {
+    TRACE_ENTER = 0,
+    TRACE_EXIT  = 1,
+    TRACE_MARK  = 2
+} trace_type_t;
+
+typedef struct __packed {
+    uint32_t cycles;        // DWT->CYCCNT
+    uint8_t id;             // trace_id_t
+    uint8_t type;           // trace_type_t
+    uint16_t arg;
+} trace_entry_t;
+
+// Antwort auf DEBUG_TIMER Subcmd 5, danach count Einträge (älteste zuerst)
+typedef struct __packed {
+    uint32_t cpu_hz;        // DWT Takt
+    uint32_t total;         // Seit Start aufgezeichnet (> count = überschrieben)
+    uint16_t count;
+    uint16_t entry_size;
+} trace_dump_header_t;
+
+extern volatile bool g_trace_enabled;
+
+void ufi_trace_record(uint8_t id, uint8_t type, uint16_t arg);
+void ufi_trace_enable(bool enable);
+void ufi_trace_clear(void);
+uint32_t ufi_trace_dump(uint8_t* out, uint32_t max_len);
+
+// Nur ein Flag-Test wenn Trace aus
+#define UFI_TRACE_ENTER(id)         do { if (g_trace_enabled) ufi_trace_record((id), TRACE_ENTER, 0); } while (0)
+#define UFI_TRACE_EXIT(id)          do { if (g_trace_enabled) ufi_trace_record((id), TRACE_EXIT, 0); } while (0)
+#define UFI_TRACE_MARK(id, arg)     do { if (g_trace_enabled) ufi_trace_record((id), TRACE_MARK, (arg)); } while (0)
+
+/* ============================================================================
+ * TELEMETRIE (ufi_telemetry.c)
+ * ============================================================================ */
+
+#define TELEMETRY_VERSION   2
+
+// Min/Max/Mittel einer Messgröße (Mittel = sum / count, Host)
+typedef struct __packed {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t last;
+    uint64_t sum;
+} telemetry_gauge_t;
+
+// Antwort auf UFI_CMD_GET_TELEMETRY (neue Felder nur hinten anfügen)
+typedef struct __packed {
+    uint16_t size;              // sizeof(ufi_telemetry_t)
+    uint16_t version;
+    uint32_t cpu_hz;            // Takt der Zyklen-Gauges
+    uint32_t uptime_ms;
+    uint32_t since_reset_ms;
+    
+    // Flux-Capture
+    uint32_t dma_half;          // DMA Half-Transfer
+    uint32_t dma_complete;      // DMA Transfer-Complete
+    uint32_t dma_errors;        // error_code 2
+    uint32_t flux_overruns;     // error_code 1 / Revolution > MAX_FLUX_PER_REV
+    uint32_t index_pulses;
+    uint32_t revolutions;
+    
+    // USB
+    uint32_t usb_tx_bytes;
+    uint32_t usb_tx_packets;
+    uint32_t usb_tx_stalls;     // Flush-Timeout (Host liest nicht)
+    uint32_t usb_rx_commands;
+    uint32_t usb_rx_dropped;    // Befehl größer als cmd_buffer
+    uint32_t flux_drops;        // send_flux: Ring voll, Frame verzögert
+    uint32_t event_drops;       // send_event: UFI_ERR_BUFFER_FULL
+    
+    // Gauges
+    telemetry_gauge_t cmd_latency;  // Zyklen: Empfang bis Antwort
+    telemetry_gauge_t loop_time;    // Zyklen pro Hauptschleifen-Durchlauf
+    telemetry_gauge_t usb_tx_fill;  // Bytes im TX-Ring beim Flush
+    
+    // Version 2
+    rpm_monitor_t rpm;              // Drehzahl, Wow & Flutter
+} ufi_telemetry_t;
+
+extern ufi_telemetry_t g_telemetry;
+
+#define UFI_TELEM_INC(field)        (g_telemetry.field++)
+#define UFI_TELEM_ADD(field, n)     (g_telemetry.field += (n))
+
+void ufi_telemetry_init(void);
+void ufi_telemetry_reset(void);
+void ufi_telemetry_gauge(telemetry_gauge_t* gauge, uint32_t value);
+void ufi_telemetry_snapshot(ufi_telemetry_t* out);
+
 /* ============================================================================
  * INTERRUPT HANDLER
  * ============================================================================ */
@@ -303,6 +615,9 @@ void EXTI0_IRQHandler(void);
 // USB High-Speed
 void OTG_HS_IRQHandler(void);
 
+// IEC Sende-/Empfangs-Tick
+void TIM7_IRQHandler(void);
+
 /* ============================================================================
  * SYSTEM FUNCTIONS
  * ============================================================================ */
@@ -6,6 +6,8 @@
 #ifndef UFI_FIXES_H
 #define UFI_FIXES_H
 
+#include "stm32h7xx_hal.h"  /* GPIO/DWT für die Helfer unten */
+
 /* Fix #4: __packed Definition */
 #ifndef __packed
   #ifdef __GNUC__
@@ -32,9 +34,13 @@ typedef enum {
     UFI_ERR_IEC_NOACK   = -9,
     UFI_ERR_BUFFER_FULL = -10,
     UFI_ERR_NOT_IMPL    = -11,
+    UFI_ERR_INVALID_PARAM = -12,
 } ufi_error_t;
 
 /* Fix #2: IEC Timeout Helpers */
+#ifndef SYSCLK_FREQ
+#define SYSCLK_FREQ         550000000UL  /* wie ufi_firmware.h */
+#endif
 #define IEC_TIMEOUT_US      10000
 #define IEC_TIMEOUT_CYCLES  (IEC_TIMEOUT_US * (SYSCLK_FREQ / 1000000))
 
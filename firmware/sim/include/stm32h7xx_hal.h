@@ -0,0 +1,353 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Simulierter HAL (ersetzt STM32CubeH7 im UFI_HOST_SIM Build)
+ *
+ * Register sind gewöhnliche Strukturen im Host-Speicher. Jeder Zugriff
+ * auf DWT und jeder HAL-Aufruf lässt die virtuelle Zeit (550 MHz) weiter
+ * laufen; dabei werden Timer, DMA, Index und USB nachgeführt und fällige
+ * Interrupts ausgelöst. Busy-Wait Schleifen der Firmware terminieren so
+ * ohne Änderung.
+ *
+ * Nur die Teile, die die Firmware benutzt - keine vollständige HAL.
+ */
+
+#ifndef STM32H7XX_HAL_H
+#define STM32H7XX_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __IO    volatile
+
+/* ============================================================================
+ * REGISTER
+ * ============================================================================ */
+
+typedef struct {
+    __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT,
+                  PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { __IO uint32_t DEMCR; } CoreDebug_Type;
+typedef struct { __IO uint32_t IDCODE; } DBGMCU_TypeDef;
+typedef struct { __IO uint32_t IMR1, EMR1, PR1, RTSR1, FTSR1; } EXTI_TypeDef;
+
+extern GPIO_TypeDef sim_gpio[5];
+extern TIM_TypeDef sim_tim2, sim_tim7;
+extern DMA_Stream_TypeDef sim_dma1_stream0;
+extern CoreDebug_Type sim_coredebug;
+extern DBGMCU_TypeDef sim_dbgmcu;
+extern EXTI_TypeDef sim_exti;
+extern uint32_t sim_uid[3];
+
+DWT_Type* sim_dwt(void);
+
+#define GPIOA           (&sim_gpio[0])
+#define GPIOB           (&sim_gpio[1])
+#define GPIOC           (&sim_gpio[2])
+#define GPIOD           (&sim_gpio[3])
+#define GPIOE           (&sim_gpio[4])
+#define TIM2            (&sim_tim2)
+#define TIM7            (&sim_tim7)
+#define DMA1_Stream0    (&sim_dma1_stream0)
+#define DWT             (sim_dwt())     // Zugriff = Zeit läuft
+#define CoreDebug       (&sim_coredebug)
+#define DBGMCU          (&sim_dbgmcu)
+#define EXTI            (&sim_exti)
+#define UID_BASE        ((uintptr_t)sim_uid)
+
+#define CoreDebug_DEMCR_TRCENA_Msk  (1U << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1U << 0)
+
+#define TIM_CR1_CEN     (1U << 0)
+#define TIM_CR1_OPM     (1U << 3)
+#define TIM_DIER_UIE    (1U << 0)
+#define TIM_SR_UIF      (1U << 0)
+#define TIM_EGR_UG      (1U << 0)
+
+#define DMA_SxCR_EN     (1U << 0)
+#define DMA_SxCR_TEIE   (1U << 2)
+#define DMA_SxCR_HTIE   (1U << 3)
+#define DMA_SxCR_TCIE   (1U << 4)
+
+extern uint32_t SystemCoreClock;
+
+/* ============================================================================
+ * CORE
+ * ============================================================================ */
+
+typedef enum {
+    HAL_OK      = 0x00,
+    HAL_ERROR   = 0x01,
+    HAL_BUSY    = 0x02,
+    HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+typedef enum {
+    DMA1_Stream0_IRQn   = 11,
+    EXTI0_IRQn          = 6,
+    EXTI1_IRQn          = 7,
+    EXTI2_IRQn          = 8,
+    EXTI3_IRQn          = 9,
+    EXTI4_IRQn          = 10,
+    EXTI9_5_IRQn        = 23,
+    TIM2_IRQn           = 28,
+    TIM6_DAC_IRQn       = 54,
+    TIM7_IRQn           = 55,
+    OTG_HS_IRQn         = 77,
+} IRQn_Type;
+
+void HAL_Init(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub);
+void HAL_NVIC_EnableIRQ(IRQn_Type irq);
+void HAL_NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SystemReset(void);
+void SystemClock_Config(void);
+
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+
+// PRIMASK und WFI (sim_hal.c)
+void sim_irq_mask(uint32_t mask);
+uint32_t sim_irq_get_mask(void);
+void sim_wfi(void);
+void sim_advance(uint32_t cycles);
+
+#define __disable_irq()     sim_irq_mask(1)
+#define __enable_irq()      sim_irq_mask(0)
+#define __get_PRIMASK()     sim_irq_get_mask()
+#define __set_PRIMASK(x)    sim_irq_mask(x)
+#define __WFI()             sim_wfi()
+#define __NOP()             sim_advance(1)
+#define __DMB()             __sync_synchronize()
+#define __DSB()             __sync_synchronize()
+
+// Ein Kern, keine Unterbrechung zwischen LDREX und STREX außer durch ISR -
+// die hier erst bei der nächsten Zeit-Fortschreibung laufen
+static inline uint32_t __LDREXW(volatile uint32_t* addr) { return *addr; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t* addr) { *addr = value; return 0; }
+
+/* ============================================================================
+ * RCC (Takte sind im Simulator immer an)
+ * ============================================================================ */
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE()            do {} while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()            do {} while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()            do {} while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()            do {} while (0)
+#define __HAL_RCC_GPIOE_CLK_ENABLE()            do {} while (0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()             do {} while (0)
+#define __HAL_RCC_TIM6_CLK_ENABLE()             do {} while (0)
+#define __HAL_RCC_TIM7_CLK_ENABLE()             do {} while (0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()             do {} while (0)
+#define __HAL_RCC_USB_OTG_HS_CLK_ENABLE()       do {} while (0)
+#define __HAL_RCC_USB_OTG_HS_ULPI_CLK_ENABLE()  do {} while (0)
+#define __HAL_RCC_GPIOA_IS_CLK_ENABLED()        1
+#define __HAL_RCC_GPIOB_IS_CLK_ENABLED()        1
+#define __HAL_RCC_GPIOC_IS_CLK_ENABLED()        1
+#define __HAL_RCC_GPIOD_IS_CLK_ENABLED()        1
+#define __HAL_RCC_GPIOE_IS_CLK_ENABLED()        1
+#define __HAL_RCC_DMA1_IS_CLK_ENABLED()         1
+#define __HAL_RCC_USB_OTG_HS_IS_CLK_ENABLED()   1
+
+/* ============================================================================
+ * GPIO / EXTI
+ * ============================================================================ */
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0      0x0001U
+#define GPIO_PIN_1      0x0002U
+#define GPIO_PIN_2      0x0004U
+#define GPIO_PIN_3      0x0008U
+#define GPIO_PIN_4      0x0010U
+#define GPIO_PIN_5      0x0020U
+#define GPIO_PIN_6      0x0040U
+#define GPIO_PIN_7      0x0080U
+#define GPIO_PIN_8      0x0100U
+#define GPIO_PIN_9      0x0200U
+#define GPIO_PIN_10     0x0400U
+#define GPIO_PIN_11     0x0800U
+#define GPIO_PIN_12     0x1000U
+
+#define GPIO_MODE_INPUT             0x00000000U
+#define GPIO_MODE_OUTPUT_PP         0x00000001U
+#define GPIO_MODE_OUTPUT_OD         0x00000011U
+#define GPIO_MODE_AF_PP             0x00000002U
+#define GPIO_MODE_IT_RISING         0x10110000U
+#define GPIO_MODE_IT_FALLING        0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING 0x10310000U
+
+#define GPIO_NOPULL                 0x00000000U
+#define GPIO_PULLUP                 0x00000001U
+#define GPIO_PULLDOWN               0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW         0x00000000U
+#define GPIO_SPEED_FREQ_MEDIUM      0x00000001U
+#define GPIO_SPEED_FREQ_HIGH        0x00000002U
+#define GPIO_SPEED_FREQ_VERY_HIGH   0x00000003U
+
+#define GPIO_AF1_TIM2               0x01U
+#define GPIO_AF10_OTG1_FS           0x0AU
+
+void HAL_GPIO_Init(GPIO_TypeDef* port, GPIO_InitTypeDef* init);
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin);
+
+// PR1 ist write-1-to-clear
+#define __HAL_GPIO_EXTI_GET_IT(pin)     (EXTI->PR1 & (pin))
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin)   (EXTI->PR1 &= ~(uint32_t)(pin))
+
+/* ============================================================================
+ * DMA
+ * ============================================================================ */
+
+typedef enum {
+    HAL_DMA_STATE_RESET = 0,
+    HAL_DMA_STATE_READY,
+    HAL_DMA_STATE_BUSY,
+} HAL_DMA_StateTypeDef;
+
+typedef struct {
+    uint32_t Request;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+    uint32_t FIFOMode;
+    uint32_t FIFOThreshold;
+    uint32_t MemBurst;
+    uint32_t PeriphBurst;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Stream_TypeDef* Instance;
+    DMA_InitTypeDef Init;
+    volatile HAL_DMA_StateTypeDef State;
+    void* Parent;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferAbortCallback)(struct __DMA_HandleTypeDef* hdma);
+} DMA_HandleTypeDef;
+
+#define DMA_REQUEST_TIM2_CH1        18U
+#define DMA_PERIPH_TO_MEMORY        0x00000000U
+#define DMA_PINC_DISABLE            0x00000000U
+#define DMA_MINC_ENABLE             0x00000400U
+#define DMA_PDATAALIGN_WORD         0x00001000U
+#define DMA_MDATAALIGN_WORD         0x00004000U
+#define DMA_NORMAL                  0x00000000U
+#define DMA_CIRCULAR                0x00000100U
+#define DMA_PRIORITY_VERY_HIGH      0x00030000U
+#define DMA_FIFOMODE_ENABLE         0x00000004U
+#define DMA_FIFO_THRESHOLD_FULL     0x00000003U
+#define DMA_MBURST_INC4             0x00800000U
+#define DMA_PBURST_SINGLE           0x00000000U
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef* hdma, uint32_t src, uint32_t dst, uint32_t len);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uint32_t src, uint32_t dst, uint32_t len);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma);
+
+#define __HAL_DMA_GET_COUNTER(h)    ((h)->Instance->NDTR)
+
+/* ============================================================================
+ * TIMER
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    uint32_t ICPolarity;
+    uint32_t ICSelection;
+    uint32_t ICPrescaler;
+    uint32_t ICFilter;
+} TIM_IC_InitTypeDef;
+
+typedef struct __TIM_HandleTypeDef {
+    TIM_TypeDef* Instance;
+    TIM_Base_InitTypeDef Init;
+    DMA_HandleTypeDef* hdma[7];
+} TIM_HandleTypeDef;
+
+#define TIM_COUNTERMODE_UP                  0x00000000U
+#define TIM_CLOCKDIVISION_DIV1              0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE      0x00000000U
+#define TIM_INPUTCHANNELPOLARITY_RISING     0x00000000U
+#define TIM_INPUTCHANNELPOLARITY_FALLING    0x00000002U
+#define TIM_ICSELECTION_DIRECTTI            0x00000001U
+#define TIM_ICPSC_DIV1                      0x00000000U
+#define TIM_CHANNEL_1                       0x00000000U
+#define TIM_DMA_ID_CC1                      ((uint16_t)0x0001)
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_IC_InitTypeDef* config, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, uint32_t* data, uint16_t len);
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim);
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef* htim);
+void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef* htim);
+
+uint32_t sim_tim_get_counter(TIM_HandleTypeDef* htim);
+void sim_tim_set_counter(TIM_HandleTypeDef* htim, uint32_t value);
+
+#define __HAL_TIM_GET_COUNTER(h)        sim_tim_get_counter(h)
+#define __HAL_TIM_SET_COUNTER(h, v)     sim_tim_set_counter((h), (v))
+
+#define __HAL_LINKDMA(handle, field, dma) do { \
+    (handle)->field = &(dma); \
+    (dma).Parent = (handle); \
+} while (0)
+
+/* ============================================================================
+ * USB PCD
+ * ============================================================================ */
+
+typedef struct {
+    void* pData;
+} PCD_HandleTypeDef;
+
+void HAL_PCD_IRQHandler(PCD_HandleTypeDef* hpcd);
+
+#define __HAL_USB_OTG_HS_WAKEUP_EXTI_CLEAR_FLAG()   do {} while (0)
+
+#endif /* STM32H7XX_HAL_H */
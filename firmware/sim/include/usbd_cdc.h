@@ -0,0 +1,21 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * CDC Klasse (Endpunkt-Modell in sim_usb.c)
+ */
+
+#ifndef USBD_CDC_H
+#define USBD_CDC_H
+
+#include "usbd_def.h"
+
+typedef struct { uint8_t id; } USBD_CDC_ItfTypeDef;
+
+extern USBD_ClassTypeDef USBD_CDC;
+extern USBD_CDC_ItfTypeDef USBD_CDC_fops;
+
+uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef* pdev, USBD_CDC_ItfTypeDef* fops);
+uint8_t USBD_CDC_SetTxBuffer(USBD_HandleTypeDef* pdev, uint8_t* buf, uint32_t len);
+uint8_t USBD_CDC_TransmitPacket(USBD_HandleTypeDef* pdev);
+uint8_t USBD_CDC_GetTxState(USBD_HandleTypeDef* pdev);
+
+#endif /* USBD_CDC_H */
@@ -0,0 +1,15 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * USB Device Core (Endpunkt-Modell in sim_usb.c)
+ */
+
+#ifndef USBD_CORE_H
+#define USBD_CORE_H
+
+#include "usbd_def.h"
+
+uint8_t USBD_Init(USBD_HandleTypeDef* pdev, USBD_DescriptorsTypeDef* desc, uint8_t id);
+uint8_t USBD_RegisterClass(USBD_HandleTypeDef* pdev, USBD_ClassTypeDef* pclass);
+uint8_t USBD_Start(USBD_HandleTypeDef* pdev);
+
+#endif /* USBD_CORE_H */
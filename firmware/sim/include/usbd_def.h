@@ -0,0 +1,39 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * USB Device Library Typen (nur was ufi_usb.c braucht)
+ */
+
+#ifndef USBD_DEF_H
+#define USBD_DEF_H
+
+#include "stm32h7xx_hal.h"
+
+#define USBD_OK                     0U
+#define USBD_BUSY                   1U
+#define USBD_FAIL                   3U
+
+#define USB_LEN_DEV_DESC            0x12U
+#define USB_DESC_TYPE_DEVICE        0x01U
+#define USB_MAX_EP0_SIZE            64U
+#define USB_HS_MAX_PACKET_SIZE      512U
+
+#define USBD_IDX_MFC_STR            0x01U
+#define USBD_IDX_PRODUCT_STR        0x02U
+#define USBD_IDX_SERIAL_STR         0x03U
+#define USBD_MAX_NUM_CONFIGURATION  1U
+
+#define LOBYTE(x)   ((uint8_t)((x) & 0x00FFU))
+#define HIBYTE(x)   ((uint8_t)(((x) & 0xFF00U) >> 8U))
+
+#define __ALIGN_BEGIN
+#define __ALIGN_END     __attribute__((aligned(4)))
+
+typedef struct {
+    void* pClassData;
+    void* pUserData;
+} USBD_HandleTypeDef;
+
+typedef struct { uint8_t id; } USBD_ClassTypeDef;
+typedef struct { uint8_t id; } USBD_DescriptorsTypeDef;
+
+#endif /* USBD_DEF_H */
@@ -0,0 +1,13 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Geräte-Deskriptoren
+ */
+
+#ifndef USBD_DESC_H
+#define USBD_DESC_H
+
+#include "usbd_def.h"
+
+extern USBD_DescriptorsTypeDef USBD_Desc;
+
+#endif /* USBD_DESC_H */
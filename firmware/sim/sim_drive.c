@@ -0,0 +1,247 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Laufwerk-Modell: Shugart-Laufwerk A mit Index- und MFM-Flux-Generator
+ *
+ * Wertet die Ausgänge der Firmware aus (MOTOR_A, DRV_SEL_A, STEP, DIR,
+ * SIDE) und liefert TRACK0, READY, INDEX (EXTI0) sowie Flux-Flanken an
+ * TIM2 CH1. Die Flux-Abstände sind 2, 3 oder 4 Bitzellen (MFM) bzw.
+ * 1, 2 oder 3 (GCR) plus gleichverteiltem Jitter. Die Daten wiederholen
+ * sich ab jedem Index wie auf einer echten Spur; nur Jitter und ein
+ * optionaler schwacher Bereich ändern sich von Umdrehung zu Umdrehung.
+ * Mit geladenem Image werden stattdessen dessen Umdrehungen abgespielt.
+ */
+
+#include "ufi_sim.h"
+
+// Pins wie ufi_main.c / ufi_drive.c
+#define SIM_MOTOR_A     GPIO_PIN_0      // GPIOA, active low
+#define SIM_SEL_A       GPIO_PIN_2      // GPIOA, active low
+#define SIM_STEP        GPIO_PIN_0      // GPIOB, active low
+#define SIM_DIR         GPIO_PIN_1      // GPIOB, low = zur Mitte
+#define SIM_SIDE        GPIO_PIN_2      // GPIOB, low = Seite 1
+#define SIM_INDEX       GPIO_PIN_0      // GPIOC
+#define SIM_TRACK0      GPIO_PIN_1      // GPIOC
+#define SIM_READY       GPIO_PIN_5      // GPIOC
+
+#define SIM_MAX_TRACK   83
+
+static sim_drive_config_t cfg;
+static sim_drive_state_t st;
+
+static bool spinning = false;
+static bool step_level = true;
+static uint64_t next_index = SIM_NEVER;
+static uint64_t next_flux = SIM_NEVER;
+static uint64_t index_at = 0;       // Letzter Index (bzw. Motorstart)
+static uint64_t flux_ns = 0;        // Position der nächsten Flanke seit index_at
+static uint32_t rng = 1;            // Daten: pro Umdrehung gleich
+static uint32_t noise = 0x2545F491; // Jitter und schwacher Bereich: frei laufend
+
+static sim_image_rev_t img;
+static bool img_valid = false;
+static uint32_t img_pos = 0;
+
+/* ============================================================================
+ * FLUX-GENERATOR
+ * ============================================================================ */
+
+static uint32_t xorshift(uint32_t* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static void rng_seed(void) {
+    rng = cfg.seed ^ ((uint32_t)st.track << 8) ^ ((uint32_t)st.side << 16) ^ 0x9E3779B9U;
+    if (rng == 0) {
+        rng = 1;
+    }
+}
+
+uint32_t sim_drive_cell_ns(uint8_t track) {
+    if (cfg.mode != SIM_FLUX_GCR) {
+        return cfg.cell_ns;
+    }
+    // 1541 Zonen: Track 1-17, 18-24, 25-30, 31+ (hier ab 0 gezählt)
+    if (track < 17) return 3250;
+    if (track < 24) return 3500;
+    if (track < 30) return 3750;
+    return 4000;
+}
+
+/**
+ * Abstand zur nächsten Flanke in ns (0 = keine weitere in dieser Umdrehung)
+ */
+static uint32_t flux_interval(void) {
+    if (sim_image_loaded()) {
+        uint32_t ns = 0;
+        while (img_valid && img_pos < img.count) {
+            uint32_t v = (img.cells[img_pos * 2] << 8) | img.cells[img_pos * 2 + 1];
+            img_pos++;
+            if (v != 0) {
+                return ns + v * img.tick_ns;
+            }
+            ns += 65536 * img.tick_ns;
+        }
+        return 0;
+    }
+
+    uint32_t cells = (cfg.mode == SIM_FLUX_GCR) ? 1 : 2;
+    uint32_t r = xorshift(&rng);
+
+    // Schwacher Bereich: bei jeder Umdrehung andere Abstände
+    uint64_t half = (st.period_cycles / 2) * 1000 / SIM_CYCLES_PER_US;
+    if (cfg.weak_us != 0 && flux_ns >= half && flux_ns < half + cfg.weak_us * 1000ULL) {
+        r = xorshift(&noise);
+    }
+
+    int64_t ns = (int64_t)(cells + r % 3) * sim_drive_cell_ns(st.track);
+    if (cfg.jitter_ns != 0) {
+        uint32_t j = xorshift(&noise);
+        ns += (int64_t)(j % (2 * cfg.jitter_ns + 1)) - (int64_t)cfg.jitter_ns;
+    }
+    return (uint32_t)ns;
+}
+
+static void flux_schedule(void) {
+    uint32_t ns = flux_interval();
+    if (ns == 0) {
+        next_flux = SIM_NEVER;
+        return;
+    }
+    flux_ns += ns;
+    next_flux = index_at + flux_ns * SIM_CYCLES_PER_US / 1000;
+}
+
+/**
+ * Neue Umdrehung: gleiche Daten ab Index, Periode aus Image oder RPM
+ */
+static void revolution_start(uint64_t now) {
+    uint64_t period = st.period_cycles;
+
+    index_at = now;
+    flux_ns = 0;
+    if (sim_image_loaded()) {
+        img_valid = sim_image_rev(st.track, st.side, st.index_pulses, &img);
+        img_pos = 0;
+        if (img_valid) {
+            period = img.index_ns * SIM_CYCLES_PER_US / 1000;
+        }
+    } else {
+        rng_seed();
+    }
+    next_index = now + period;
+    flux_schedule();
+}
+
+/**
+ * Kopf auf anderer Spur: synthetisch sofort neue Daten, Image ab nächstem Index
+ */
+static void head_moved(void) {
+    rng_seed();
+    img_valid = false;
+}
+
+/* ============================================================================
+ * EREIGNISQUELLE
+ * ============================================================================ */
+
+static uint64_t drive_next(void) {
+    if (!spinning) {
+        return SIM_NEVER;
+    }
+    return (next_index < next_flux) ? next_index : next_flux;
+}
+
+static void drive_run(uint64_t now) {
+    if (now >= next_index) {
+        st.index_pulses++;
+        revolution_start(now);
+        if (st.selected) {
+            // Kurzer Low-Puls, EXTI0 reagiert auf die fallende Flanke
+            sim_gpio_set_input(GPIOC, SIM_INDEX, false);
+            sim_gpio_set_input(GPIOC, SIM_INDEX, true);
+        }
+        return;
+    }
+
+    flux_schedule();
+    st.transitions++;
+    if (st.selected) {
+        if (sim_tim2_capturing()) {
+            st.captured++;
+        }
+        sim_tim2_capture();
+    }
+}
+
+/* ============================================================================
+ * FIRMWARE-AUSGÄNGE
+ * ============================================================================ */
+
+void sim_drive_pins_changed(void) {
+    uint32_t a = sim_gpio_output(GPIOA);
+    uint32_t b = sim_gpio_output(GPIOB);
+
+    st.selected = !(a & SIM_SEL_A);
+
+    // Motor
+    bool motor = !(a & SIM_MOTOR_A);
+    if (motor && !st.motor) {
+        spinning = true;
+        index_at = sim_cycles;
+        flux_ns = 0;
+        img_valid = false;
+        next_index = sim_cycles + (uint64_t)cfg.spinup_ms * SIM_CYCLES_PER_MS;
+        flux_schedule();
+    } else if (!motor && st.motor) {
+        spinning = false;
+        next_index = SIM_NEVER;
+        next_flux = SIM_NEVER;
+    }
+    st.motor = motor;
+    sim_gpio_set_input(GPIOC, SIM_READY, !(motor && st.selected));
+
+    // Seite
+    uint8_t side = (b & SIM_SIDE) ? 0 : 1;
+    if (side != st.side) {
+        st.side = side;
+        head_moved();
+    }
+
+    // Step auf fallender Flanke, Richtung aus DIR
+    bool step = (b & SIM_STEP) != 0;
+    if (step_level && !step && st.selected) {
+        if (!(b & SIM_DIR)) {
+            if (st.track < SIM_MAX_TRACK) st.track++;
+        } else {
+            if (st.track > 0) st.track--;
+        }
+        st.steps++;
+        head_moved();
+    }
+    step_level = step;
+
+    sim_gpio_set_input(GPIOC, SIM_TRACK0, !(st.track == 0 && st.selected));
+}
+
+/* ============================================================================
+ * INIT
+ * ============================================================================ */
+
+void sim_drive_init(const sim_drive_config_t* config) {
+    static const sim_source_t source = { drive_next, drive_run };
+
+    cfg = *config;
+    st.track = 0;
+    st.side = 0;
+    st.period_cycles = (60ULL * SIM_CPU_HZ) / cfg.rpm;
+    rng_seed();
+
+    sim_add_source(&source);
+}
+
+const sim_drive_state_t* sim_drive_state(void) {
+    return &st;
+}
@@ -0,0 +1,702 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Simulierter HAL: virtuelle Zeit, NVIC, GPIO, EXTI, TIM2/TIM7, DMA1 Stream0
+ *
+ * Zeitmodell: sim_cycles zählt CPU-Zyklen bei 550 MHz. Die Firmware läuft
+ * auf dem Host "unendlich schnell"; Zeit vergeht nur durch DWT-Zugriffe,
+ * HAL-Aufrufe und sim_idle(). Dabei werden alle Ereignisquellen (Flux,
+ * Index, TIM7, USB) der Reihe nach abgearbeitet und fällige Interrupts
+ * ausgeführt - zwischen zwei Ereignissen, wie auf der echten CPU zwischen
+ * zwei Instruktionen.
+ *
+ * Vereinfachungen: keine verschachtelten Interrupts (Prioritäten bestimmen
+ * nur die Reihenfolge), DMA-Zugriffe sind sofort sichtbar.
+ */
+
+#include "ufi_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ============================================================================
+ * REGISTER
+ * ============================================================================ */
+
+GPIO_TypeDef sim_gpio[5];
+TIM_TypeDef sim_tim2, sim_tim7;
+DMA_Stream_TypeDef sim_dma1_stream0;
+CoreDebug_Type sim_coredebug;
+DBGMCU_TypeDef sim_dbgmcu;
+EXTI_TypeDef sim_exti;
+uint32_t sim_uid[3];
+
+uint32_t SystemCoreClock = (uint32_t)SIM_CPU_HZ;
+
+volatile uint64_t sim_cycles = 0;
+
+static DWT_Type sim_dwt_regs;
+static uint32_t dwt_last = 0;
+static uint64_t dwt_offset = 0;
+
+/* ============================================================================
+ * EREIGNISQUELLEN
+ * ============================================================================ */
+
+#define SIM_MAX_SOURCES     8
+
+static sim_source_t sources[SIM_MAX_SOURCES];
+static uint32_t source_count = 0;
+static bool in_events = false;
+
+static void gpio_sync(void);
+static void irq_dispatch(void);
+
+void sim_add_source(const sim_source_t* source) {
+    if (source_count < SIM_MAX_SOURCES) {
+        sources[source_count++] = *source;
+    }
+}
+
+static const sim_source_t* next_source(uint64_t* at) {
+    const sim_source_t* best = NULL;
+    *at = SIM_NEVER;
+    for (uint32_t i = 0; i < source_count; i++) {
+        uint64_t t = sources[i].next();
+        if (t < *at) {
+            *at = t;
+            best = &sources[i];
+        }
+    }
+    return best;
+}
+
+/**
+ * Virtuelle Zeit fortschreiben, Ereignisse und Interrupts abarbeiten
+ * Aufrufe aus Ereignis-Handlern heraus zählen nur die Zeit weiter.
+ */
+void sim_advance(uint32_t cycles) {
+    uint64_t target = sim_cycles + cycles;
+
+    if (in_events) {
+        sim_cycles = target;
+        return;
+    }
+
+    for (;;) {
+        uint64_t at;
+        in_events = true;
+        const sim_source_t* src = next_source(&at);
+        if (src == NULL || at > target) {
+            in_events = false;
+            break;
+        }
+        if (at > sim_cycles) {
+            sim_cycles = at;
+        }
+        src->run(sim_cycles);
+        gpio_sync();
+        in_events = false;
+
+        irq_dispatch();
+        if (sim_cycles > target) {
+            target = sim_cycles;    // ISR hat selbst Zeit verbraucht
+        }
+    }
+
+    if (target > sim_cycles) {
+        sim_cycles = target;
+    }
+    gpio_sync();
+    irq_dispatch();
+}
+
+/**
+ * CPU schläft bis zum nächsten Ereignis (höchstens max_cycles)
+ */
+void sim_idle(uint32_t max_cycles) {
+    uint64_t at;
+    next_source(&at);
+    uint64_t delta = (at > sim_cycles) ? at - sim_cycles : 1;
+    sim_advance((uint32_t)((delta < max_cycles) ? delta : max_cycles));
+}
+
+void sim_wfi(void) {
+    sim_idle((uint32_t)SIM_CYCLES_PER_MS);
+}
+
+/* ============================================================================
+ * NVIC
+ * ============================================================================ */
+
+static volatile bool irq_pending[SIM_IRQ_COUNT];
+static bool irq_enabled[SIM_IRQ_COUNT];
+static uint8_t irq_priority[SIM_IRQ_COUNT];
+static uint64_t irq_pend_at[SIM_IRQ_COUNT];
+static sim_irq_stats_t irq_stats[SIM_IRQ_COUNT];
+static volatile uint32_t irq_pending_count = 0;
+static bool in_isr = false;
+static uint32_t primask = 0;
+
+// Handler aus stm32h7xx_it.c
+extern void EXTI0_IRQHandler(void);
+extern void EXTI2_IRQHandler(void);
+extern void EXTI4_IRQHandler(void);
+extern void EXTI9_5_IRQHandler(void);
+extern void TIM2_IRQHandler(void);
+extern void TIM7_IRQHandler(void);
+extern void DMA1_Stream0_IRQHandler(void);
+extern void OTG_HS_IRQHandler(void);
+
+static void (*irq_handler(IRQn_Type irq))(void) {
+    switch (irq) {
+        case EXTI0_IRQn:        return EXTI0_IRQHandler;
+        case EXTI2_IRQn:        return EXTI2_IRQHandler;
+        case EXTI4_IRQn:        return EXTI4_IRQHandler;
+        case EXTI9_5_IRQn:      return EXTI9_5_IRQHandler;
+        case TIM2_IRQn:         return TIM2_IRQHandler;
+        case TIM7_IRQn:         return TIM7_IRQHandler;
+        case DMA1_Stream0_IRQn: return DMA1_Stream0_IRQHandler;
+        case OTG_HS_IRQn:       return OTG_HS_IRQHandler;
+        default:                return NULL;
+    }
+}
+
+const char* sim_irq_name(IRQn_Type irq) {
+    switch (irq) {
+        case EXTI0_IRQn:        return "EXTI0 (index)";
+        case EXTI2_IRQn:        return "EXTI2 (wprot)";
+        case EXTI4_IRQn:        return "EXTI4 (dkchg)";
+        case EXTI9_5_IRQn:      return "EXTI9_5 (ready)";
+        case TIM2_IRQn:         return "TIM2 (flux)";
+        case TIM7_IRQn:         return "TIM7 (iec)";
+        case DMA1_Stream0_IRQn: return "DMA1_S0 (flux)";
+        case OTG_HS_IRQn:       return "OTG_HS (usb)";
+        default:                return "?";
+    }
+}
+
+const sim_irq_stats_t* sim_irq_stats(IRQn_Type irq) {
+    return &irq_stats[irq];
+}
+
+void sim_irq_pend(IRQn_Type irq) {
+    if (!irq_pending[irq]) {
+        irq_pending[irq] = true;
+        irq_pend_at[irq] = sim_cycles;
+        irq_pending_count++;
+    }
+}
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Anstehende, freigegebene Interrupts nach Priorität ausführen
+ */
+static void irq_dispatch(void) {
+    while (irq_pending_count != 0 && !in_isr && primask == 0) {
+        int best = -1;
+        for (int i = 0; i < SIM_IRQ_COUNT; i++) {
+            if (irq_pending[i] && irq_enabled[i] &&
+                (best < 0 || irq_priority[i] < irq_priority[best])) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            return;     // Nur gesperrte Interrupts anstehend
+        }
+
+        irq_pending[best] = false;
+        irq_pending_count--;
+
+        void (*handler)(void) = irq_handler((IRQn_Type)best);
+        if (handler == NULL) {
+            continue;
+        }
+
+        sim_irq_stats_t* st = &irq_stats[best];
+        uint64_t latency = sim_cycles - irq_pend_at[best];
+        uint64_t start = sim_cycles;
+        uint64_t t0 = host_ns();
+
+        in_isr = true;
+        sim_cycles += 12;           // Exception-Eintritt (Stacking)
+        handler();
+        sim_cycles += 12;
+        in_isr = false;
+
+        uint64_t ns = host_ns() - t0;
+        uint64_t cycles = sim_cycles - start;
+        st->count++;
+        st->host_ns_total += ns;
+        if (ns > st->host_ns_max) st->host_ns_max = ns;
+        if (cycles > st->cycles_max) st->cycles_max = cycles;
+        if (latency > st->latency_max) st->latency_max = latency;
+    }
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub) {
+    irq_priority[irq] = (uint8_t)((preempt << 4) | (sub & 0x0F));
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type irq) {
+    irq_enabled[irq] = true;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type irq) {
+    irq_enabled[irq] = false;
+}
+
+void sim_irq_mask(uint32_t mask) {
+    primask = mask & 1;
+    if (primask == 0 && !in_events) {
+        irq_dispatch();
+    }
+}
+
+uint32_t sim_irq_get_mask(void) {
+    return primask;
+}
+
+void NVIC_SystemReset(void) {
+    fprintf(stderr, "sim: NVIC_SystemReset\n");
+    exit(3);
+}
+
+/* ============================================================================
+ * CORE / RCC
+ * ============================================================================ */
+
+DWT_Type* sim_dwt(void) {
+    // Firmware hat CYCCNT beschrieben (UFI_DWT_INIT)
+    if (sim_dwt_regs.CYCCNT != dwt_last) {
+        dwt_offset = sim_cycles - sim_dwt_regs.CYCCNT;
+    }
+    sim_advance(SIM_CYCLES_REG);
+    dwt_last = (uint32_t)(sim_cycles - dwt_offset);
+    sim_dwt_regs.CYCCNT = dwt_last;
+    return &sim_dwt_regs;
+}
+
+void HAL_Init(void) {
+}
+
+void HAL_IncTick(void) {
+}
+
+uint32_t HAL_GetTick(void) {
+    sim_advance(SIM_CYCLES_HAL);
+    return (uint32_t)(sim_cycles / SIM_CYCLES_PER_MS);
+}
+
+void HAL_Delay(uint32_t delay) {
+    uint64_t end = sim_cycles + (uint64_t)delay * SIM_CYCLES_PER_MS;
+    while (sim_cycles < end) {
+        uint64_t rest = end - sim_cycles;
+        sim_advance((uint32_t)((rest < SIM_CYCLES_PER_MS) ? rest : SIM_CYCLES_PER_MS));
+    }
+}
+
+void SystemClock_Config(void) {
+    SystemCoreClock = (uint32_t)SIM_CPU_HZ;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void) { return (uint32_t)SIM_CPU_HZ; }
+uint32_t HAL_RCC_GetHCLKFreq(void)     { return (uint32_t)(SIM_CPU_HZ / 2); }
+uint32_t HAL_RCC_GetPCLK1Freq(void)    { return (uint32_t)(SIM_CPU_HZ / 4); }
+
+/* ============================================================================
+ * GPIO / EXTI
+ * ============================================================================ */
+
+static uint32_t gpio_ext[5];        // Externe Pegel (Pull-up = high)
+static uint32_t gpio_out[5];        // Als Ausgang konfiguriert
+static uint32_t gpio_od[5];         // Open-Drain
+static uint32_t gpio_odr_seen[5];
+static int8_t exti_port[16];        // EXTI-Leitung → Port (-1 = keiner)
+
+static int port_index(GPIO_TypeDef* port) {
+    return (int)(port - sim_gpio);
+}
+
+/**
+ * BSRR anwenden, IDR aus Ausgängen und externen Pegeln bilden
+ * Open-Drain: Leitung ist high nur wenn weder MCU noch Gegenseite zieht.
+ */
+static void gpio_sync(void) {
+    bool changed = false;
+
+    for (int p = 0; p < 5; p++) {
+        GPIO_TypeDef* g = &sim_gpio[p];
+        uint32_t bsrr = g->BSRR;
+        if (bsrr != 0) {
+            g->ODR = (g->ODR & ~(bsrr >> 16)) | (bsrr & 0xFFFF);  // Set hat Vorrang
+            g->BSRR = 0;
+        }
+        uint32_t pp = gpio_out[p] & ~gpio_od[p];
+        g->IDR = (g->ODR & pp) |
+                 (g->ODR & gpio_ext[p] & gpio_od[p]) |
+                 (gpio_ext[p] & ~gpio_out[p] & 0xFFFF);
+        if (g->ODR != gpio_odr_seen[p]) {
+            gpio_odr_seen[p] = g->ODR;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        sim_drive_pins_changed();
+    }
+}
+
+uint32_t sim_gpio_output(GPIO_TypeDef* port) {
+    return port->ODR;
+}
+
+static IRQn_Type exti_irq(uint32_t line) {
+    switch (line) {
+        case 0:  return EXTI0_IRQn;
+        case 1:  return EXTI1_IRQn;
+        case 2:  return EXTI2_IRQn;
+        case 3:  return EXTI3_IRQn;
+        case 4:  return EXTI4_IRQn;
+        default: return EXTI9_5_IRQn;   // 10-15 nicht belegt
+    }
+}
+
+void sim_gpio_set_input(GPIO_TypeDef* port, uint16_t pin, bool high) {
+    int p = port_index(port);
+    uint32_t old = gpio_ext[p];
+    gpio_ext[p] = high ? (old | pin) : (old & ~(uint32_t)pin);
+
+    // Flanke an einer EXTI-Leitung dieses Ports?
+    for (uint32_t line = 0; line < 16; line++) {
+        uint32_t bit = 1UL << line;
+        if (!(pin & bit) || exti_port[line] != p || !(sim_exti.IMR1 & bit)) {
+            continue;
+        }
+        bool rising = !(old & bit) && high;
+        bool falling = (old & bit) && !high;
+        if ((rising && (sim_exti.RTSR1 & bit)) || (falling && (sim_exti.FTSR1 & bit))) {
+            sim_exti.PR1 |= bit;
+            sim_irq_pend(exti_irq(line));
+        }
+    }
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef* port, GPIO_InitTypeDef* init) {
+    int p = port_index(port);
+
+    for (uint32_t line = 0; line < 16; line++) {
+        uint32_t bit = 1UL << line;
+        if (!(init->Pin & bit)) {
+            continue;
+        }
+
+        uint32_t mode = init->Mode & 0x3;
+        port->MODER = (port->MODER & ~(3UL << (line * 2))) | (mode << (line * 2));
+
+        if (mode == GPIO_MODE_OUTPUT_PP) {
+            gpio_out[p] |= bit;
+            if (init->Mode & 0x10) {
+                gpio_od[p] |= bit;
+            } else {
+                gpio_od[p] &= ~bit;
+            }
+        } else {
+            gpio_out[p] &= ~bit;
+        }
+
+        // EXTI (GPIO_MODE_IT_*)
+        if (init->Mode & 0x10000000U) {
+            exti_port[line] = (int8_t)p;
+            sim_exti.IMR1 |= bit;
+            if (init->Mode & 0x00100000U) sim_exti.RTSR1 |= bit;
+            if (init->Mode & 0x00200000U) sim_exti.FTSR1 |= bit;
+        }
+    }
+
+    sim_advance(SIM_CYCLES_HAL);
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    port->BSRR = (state == GPIO_PIN_SET) ? pin : ((uint32_t)pin << 16);
+    sim_advance(SIM_CYCLES_HAL);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin) {
+    sim_advance(SIM_CYCLES_HAL);
+    return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin) {
+    uint32_t odr = port->ODR;
+    port->BSRR = ((odr & pin) << 16) | (~odr & pin);
+    sim_advance(SIM_CYCLES_HAL);
+}
+
+/* ============================================================================
+ * DMA1 STREAM0 (TIM2 CH1 → Speicher)
+ * ============================================================================ */
+
+#define DMA_FLAG_HT     (1UL << 0)
+#define DMA_FLAG_TC     (1UL << 1)
+
+static DMA_HandleTypeDef* dma_handle = NULL;
+static uint32_t start_errors = 0;
+static uint32_t dma_length = 0;
+static uint32_t dma_flags = 0;
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->Instance->CR = 0;
+    dma_handle = hdma;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef* hdma, uint32_t src, uint32_t dst, uint32_t len) {
+    sim_advance(SIM_CYCLES_HAL);
+    if (hdma->State != HAL_DMA_STATE_READY) {
+        start_errors++;
+        return HAL_BUSY;
+    }
+    hdma->State = HAL_DMA_STATE_BUSY;
+
+    DMA_Stream_TypeDef* s = hdma->Instance;
+    s->PAR = src;
+    s->M0AR = dst;
+    s->NDTR = len;
+    s->CR = (s->CR & ~(DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE)) | DMA_SxCR_EN;
+    dma_length = len;
+    dma_flags = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uint32_t src, uint32_t dst, uint32_t len) {
+    HAL_StatusTypeDef ret = HAL_DMA_Start(hdma, src, dst, len);
+    if (ret == HAL_OK) {
+        hdma->Instance->CR |= DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+        if (hdma->XferHalfCpltCallback != NULL) {
+            hdma->Instance->CR |= DMA_SxCR_HTIE;
+        }
+    }
+    return ret;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma) {
+    sim_advance(SIM_CYCLES_HAL);
+    if (hdma->State != HAL_DMA_STATE_BUSY) {
+        return HAL_ERROR;   // HAL_DMA_ERROR_NO_XFER
+    }
+    hdma->Instance->CR &= ~(DMA_SxCR_EN | DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE);
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma) {
+    uint32_t flags = dma_flags;
+    dma_flags = 0;
+    sim_advance(SIM_CYCLES_HAL);
+
+    if ((flags & DMA_FLAG_HT) && hdma->XferHalfCpltCallback != NULL) {
+        hdma->XferHalfCpltCallback(hdma);
+    }
+    if (flags & DMA_FLAG_TC) {
+        if (hdma->Init.Mode != DMA_CIRCULAR) {
+            hdma->State = HAL_DMA_STATE_READY;
+        }
+        if (hdma->XferCpltCallback != NULL) {
+            hdma->XferCpltCallback(hdma);
+        }
+    }
+}
+
+/* ============================================================================
+ * TIM2 (Flux Input Capture, 275 MHz) / TIM7 (IEC Tick)
+ * ============================================================================ */
+
+static uint64_t tim2_base = 0;          // sim_cycles bei CNT = 0
+static bool tim2_ch1_busy = false;      // HAL Kanal-Zustand
+static bool tim2_dma_request = false;   // CC1DE
+
+uint32_t sim_tim_get_counter(TIM_HandleTypeDef* htim) {
+    sim_advance(SIM_CYCLES_REG);
+    if (htim->Instance == TIM2) {
+        return (uint32_t)((sim_cycles - tim2_base) / 2);
+    }
+    return htim->Instance->CNT;
+}
+
+void sim_tim_set_counter(TIM_HandleTypeDef* htim, uint32_t value) {
+    sim_advance(SIM_CYCLES_REG);
+    if (htim->Instance == TIM2) {
+        tim2_base = sim_cycles - (uint64_t)value * 2;
+    } else {
+        htim->Instance->CNT = value;
+    }
+}
+
+bool sim_tim2_capturing(void) {
+    return tim2_dma_request && (sim_dma1_stream0.CR & DMA_SxCR_EN);
+}
+
+/**
+ * Flanke an TIM2 CH1: CCR1 = CNT, DMA-Request bedienen
+ */
+void sim_tim2_capture(void) {
+    sim_tim2.CCR1 = (uint32_t)((sim_cycles - tim2_base) / 2);
+
+    DMA_Stream_TypeDef* s = &sim_dma1_stream0;
+    if (!sim_tim2_capturing() || s->NDTR == 0) {
+        return;
+    }
+
+    uint32_t* dst = (uint32_t*)(uintptr_t)s->M0AR;
+    dst[dma_length - s->NDTR] = sim_tim2.CCR1;
+    s->NDTR--;
+
+    bool irq = false;
+    if (s->NDTR == dma_length / 2 && (s->CR & DMA_SxCR_HTIE)) {
+        dma_flags |= DMA_FLAG_HT;
+        irq = true;
+    }
+    if (s->NDTR == 0) {
+        if (dma_handle != NULL && dma_handle->Init.Mode == DMA_CIRCULAR) {
+            s->NDTR = dma_length;
+        } else {
+            s->CR &= ~DMA_SxCR_EN;
+        }
+        if (s->CR & DMA_SxCR_TCIE) {
+            dma_flags |= DMA_FLAG_TC;
+            irq = true;
+        }
+    }
+    if (irq) {
+        sim_irq_pend(DMA1_Stream0_IRQn);
+    }
+}
+
+__attribute__((weak)) void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef* htim) {
+    (void)htim;
+}
+
+__attribute__((weak)) void HAL_TIM_IC_CaptureHalfCpltCallback(TIM_HandleTypeDef* htim) {
+    (void)htim;
+}
+
+static void tim_dma_capture_cplt(DMA_HandleTypeDef* hdma) {
+    HAL_TIM_IC_CaptureCallback((TIM_HandleTypeDef*)hdma->Parent);
+}
+
+static void tim_dma_capture_half(DMA_HandleTypeDef* hdma) {
+    HAL_TIM_IC_CaptureHalfCpltCallback((TIM_HandleTypeDef*)hdma->Parent);
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef* htim) {
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_IC_InitTypeDef* config, uint32_t channel) {
+    (void)htim;
+    (void)config;
+    (void)channel;
+    return HAL_OK;
+}
+
+/**
+ * Wie die echte HAL: Kanal muss READY sein, sonst HAL_BUSY
+ */
+HAL_StatusTypeDef HAL_TIM_IC_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, uint32_t* data, uint16_t len) {
+    (void)channel;
+    DMA_HandleTypeDef* hdma = htim->hdma[TIM_DMA_ID_CC1];
+
+    if (tim2_ch1_busy) {
+        start_errors++;
+        return HAL_BUSY;
+    }
+    if (hdma == NULL || data == NULL || len == 0) {
+        return HAL_ERROR;
+    }
+
+    hdma->XferCpltCallback = tim_dma_capture_cplt;
+    hdma->XferHalfCpltCallback = tim_dma_capture_half;
+    hdma->XferErrorCallback = NULL;
+
+    if (HAL_DMA_Start_IT(hdma, (uint32_t)(uintptr_t)&htim->Instance->CCR1,
+                         (uint32_t)(uintptr_t)data, len) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    tim2_ch1_busy = true;
+    tim2_dma_request = true;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel) {
+    (void)channel;
+    tim2_dma_request = false;
+    if (htim->hdma[TIM_DMA_ID_CC1] != NULL) {
+        (void)HAL_DMA_Abort(htim->hdma[TIM_DMA_ID_CC1]);
+    }
+    htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    tim2_ch1_busy = false;
+    return HAL_OK;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim) {
+    (void)htim;
+}
+
+// TIM7: Update-Interrupt alle (PSC+1)*(ARR+1) Takte @ 275 MHz
+static bool tim7_running = false;
+static uint64_t tim7_next_at = SIM_NEVER;
+
+static uint64_t tim7_period(void) {
+    return 2ULL * (sim_tim7.PSC + 1) * (sim_tim7.ARR + 1);
+}
+
+static uint64_t tim7_next(void) {
+    bool on = (sim_tim7.CR1 & TIM_CR1_CEN) && (sim_tim7.DIER & TIM_DIER_UIE);
+    if (on && !tim7_running) {
+        tim7_next_at = sim_cycles + tim7_period();
+    }
+    tim7_running = on;
+    return on ? tim7_next_at : SIM_NEVER;
+}
+
+static void tim7_run(uint64_t now) {
+    sim_tim7.SR |= TIM_SR_UIF;
+    sim_irq_pend(TIM7_IRQn);
+    tim7_next_at = now + tim7_period();
+}
+
+/* ============================================================================
+ * INIT
+ * ============================================================================ */
+
+uint32_t sim_hal_start_errors(void) {
+    return start_errors;
+}
+
+void sim_hal_init(void) {
+    static const sim_source_t tim7_source = { tim7_next, tim7_run };
+
+    for (int p = 0; p < 5; p++) {
+        gpio_ext[p] = 0xFFFF;
+    }
+    for (int i = 0; i < 16; i++) {
+        exti_port[i] = -1;
+    }
+
+    sim_dbgmcu.IDCODE = 0x10036483;     // STM32H723, Rev Z
+    sim_uid[0] = 0x00550055;
+    sim_uid[1] = 0x46495355;            // "USIF"
+    sim_uid[2] = 0x00000001;
+
+    sim_add_source(&tim7_source);
+}
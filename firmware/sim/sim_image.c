@@ -0,0 +1,120 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Aufgezeichnete Flux-Images (SuperCard Pro .scp) für das Laufwerk-Modell
+ *
+ * Das Image wird komplett in den Speicher gelesen; die Zellwerte
+ * (16 Bit Big Endian, 0 = Überlauf +65536) bleiben im Originalformat
+ * und werden vom Laufwerk-Modell beim Abspielen gelesen.
+ *
+ * Aufbau: 16 Byte Header, 168 Track-Offsets (Track = Zylinder * 2 + Seite),
+ * pro Track "TRK" + Nummer und je Umdrehung (Index-Zeit, Länge, Offset).
+ */
+
+#include "ufi_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCP_HEADER_SIZE     16
+#define SCP_MAX_TRACKS      168
+#define SCP_TRACK_HEADER    4
+#define SCP_REV_ENTRY       12
+#define SCP_BASE_NS         25
+
+static uint8_t* image = NULL;
+static uint32_t image_size = 0;
+static uint32_t image_revs = 0;
+static uint32_t image_tick_ns = SCP_BASE_NS;
+static bool image_single_side = false;
+static uint8_t image_side = 0;
+
+static uint32_t le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * SCP-Image laden
+ * @return 0 bei Erfolg, -1 bei Lese- oder Formatfehler
+ */
+int sim_image_load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t* data = NULL;
+    if (size > SCP_HEADER_SIZE + SCP_MAX_TRACKS * 4) {
+        data = malloc((size_t)size);
+    }
+    if (data == NULL || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    // Header: "SCP", Version, Typ, Umdrehungen, Start, Ende, Flags,
+    //         Zellbreite (0 = 16 Bit), Köpfe, Auflösung (25 ns * (n+1))
+    if (memcmp(data, "SCP", 3) != 0 || data[5] == 0 ||
+        (data[9] != 0 && data[9] != 16)) {
+        free(data);
+        return -1;
+    }
+
+    free(image);
+    image = data;
+    image_size = (uint32_t)size;
+    image_revs = data[5];
+    image_single_side = (data[10] != 0);
+    image_side = (data[10] == 2) ? 1 : 0;
+    image_tick_ns = SCP_BASE_NS * (data[11] + 1U);
+    return 0;
+}
+
+bool sim_image_loaded(void) {
+    return image != NULL;
+}
+
+/**
+ * Umdrehung eines Tracks (rev wird über die vorhandenen Umdrehungen rotiert)
+ * @return false wenn der Track im Image fehlt (unformatiert)
+ */
+bool sim_image_rev(uint8_t track, uint8_t side, uint32_t rev, sim_image_rev_t* out) {
+    if (image == NULL) {
+        return false;
+    }
+
+    uint32_t index;
+    if (image_single_side) {
+        if (side != image_side) {
+            return false;
+        }
+        index = track;
+    } else {
+        index = (uint32_t)track * 2 + side;
+    }
+    if (index >= SCP_MAX_TRACKS) {
+        return false;
+    }
+
+    uint32_t trk = le32(image + SCP_HEADER_SIZE + index * 4);
+    uint32_t entry = trk + SCP_TRACK_HEADER + (rev % image_revs) * SCP_REV_ENTRY;
+    if (trk == 0 || entry + SCP_REV_ENTRY > image_size || memcmp(image + trk, "TRK", 3) != 0) {
+        return false;
+    }
+
+    uint32_t count = le32(image + entry + 4);
+    uint32_t offset = trk + le32(image + entry + 8);
+    if (count == 0 || offset + count * 2 > image_size) {
+        return false;
+    }
+
+    out->cells = image + offset;
+    out->count = count;
+    out->tick_ns = image_tick_ns;
+    out->index_ns = (uint64_t)le32(image + entry) * SCP_BASE_NS;
+    return true;
+}
@@ -0,0 +1,397 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Runner: Firmware gegen simulierten HAL, Laufwerk und USB-Host
+ *
+ * Spielt die Befehlsfolge des CM5 durch (SELECT_DRIVE, MOTOR_ON,
+ * READ_TRACK_RAW pro Track/Seite), prüft jedes Flux-Paket gegen das
+ * Laufwerk-Modell und meldet Durchsatz, Telemetrie und ISR-Budgets.
+ *
+ * Exit-Code 0 = alles korrekt angekommen, 1 = Fehler (für CI).
+ *
+ * Mit --listen läuft stattdessen das virtuelle Gerät (sim_server.c):
+ * der CM5-Code verbindet sich per TCP statt USB (UFI_DEVICE=tcp://...).
+ *
+ * Aufruf:
+ *   ufi_sim [-t tracks] [-s sides] [-r revs] [--rpm N] [--cell ns]
+ *           [--jitter ns] [--usb-mbps N] [--stall-ms N] [--isr-budget-us N]
+ *           [--flux mfm|gcr] [--weak-us N] [--image file.scp]
+ *           [--listen [host:]port] [--speed X]
+ */
+
+#include "ufi_sim.h"
+#include "ufi_firmware.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#define SIM_IDLE_MAX        (10 * SIM_CYCLES_PER_US)   // Längster Schlaf pro Durchlauf
+#define SIM_TIMEOUT_MS      3000                        // Pro Antwort / Paket
+#define SIM_REPORT_ERRORS   8
+
+typedef struct {
+    uint32_t tracks;
+    uint32_t sides;
+    uint32_t revs;
+    uint32_t usb_mbps;
+    uint32_t stall_ms;          // Host liest nach jedem READ so lange nicht
+    uint32_t isr_budget_us;     // 0 = nur berichten
+    const char* image;          // SCP-Image statt synthetischer Flux
+    const char* listen;         // Virtuelles Gerät statt Testlauf
+    double speed;               // Virtuelle Zeit / Wanduhr (0 = ungebremst)
+    sim_drive_config_t drive;
+} sim_options_t;
+
+static uint32_t g_errors = 0;
+static uint32_t g_frames = 0;
+static uint64_t g_samples = 0;
+static uint32_t g_samples_buf[MAX_FLUX_PER_REV];
+static uint64_t g_last_hash = 0;
+
+#define SIM_FAIL(...) do { \
+    if (g_errors++ < SIM_REPORT_ERRORS) { \
+        fprintf(stderr, "FEHLER: " __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+/* ============================================================================
+ * HOST-ZUGRIFF
+ * ============================================================================ */
+
+static void sim_step(void) {
+    ufi_main_poll();
+    sim_idle((uint32_t)SIM_IDLE_MAX);
+}
+
+static bool host_read(void* data, uint32_t len) {
+    uint64_t deadline = sim_cycles + SIM_TIMEOUT_MS * SIM_CYCLES_PER_MS;
+    while (sim_usb_host_available() < len) {
+        if (sim_cycles > deadline) {
+            return false;
+        }
+        sim_step();
+    }
+    sim_usb_host_read(data, len);
+    return true;
+}
+
+/**
+ * Befehl senden und Antwort-Header (+ Daten) lesen
+ * @return Länge der Daten, -1 bei Timeout/Fehler
+ */
+static int host_command(const uint8_t* cmd, uint32_t len, void* data, uint32_t max) {
+    ufi_response_header_t resp;
+
+    sim_usb_host_send(cmd, len);
+    if (!host_read(&resp, sizeof(resp))) {
+        SIM_FAIL("Befehl 0x%02X: keine Antwort", cmd[0]);
+        return -1;
+    }
+    if (resp.command != cmd[0] || resp.status != 0) {
+        SIM_FAIL("Befehl 0x%02X: Antwort 0x%02X Status %u", cmd[0], resp.command, resp.status);
+        return -1;
+    }
+    if (resp.length > max || !host_read(data, resp.length)) {
+        SIM_FAIL("Befehl 0x%02X: Daten (%u Bytes) fehlen", cmd[0], resp.length);
+        return -1;
+    }
+    return resp.length;
+}
+
+/* ============================================================================
+ * FLUX-PAKETE PRÜFEN
+ * ============================================================================ */
+
+static void check_frame(const sim_options_t* opt, uint8_t track, uint8_t side, uint8_t rev) {
+    flux_packet_header_t hdr;
+
+    if (!host_read(&hdr, sizeof(hdr))) {
+        SIM_FAIL("Track %u/%u Rev %u: Paket fehlt", track, side, rev);
+        return;
+    }
+    if (hdr.track != track || hdr.side != side || hdr.revolution != rev) {
+        SIM_FAIL("Track %u/%u Rev %u: Header %u/%u Rev %u",
+                 track, side, rev, hdr.track, hdr.side, hdr.revolution);
+        return;
+    }
+    if (hdr.sample_count == 0 || hdr.sample_count > MAX_FLUX_PER_REV) {
+        SIM_FAIL("Track %u/%u Rev %u: %u Samples", track, side, rev, hdr.sample_count);
+        return;
+    }
+    if (!host_read(g_samples_buf, hdr.sample_count * sizeof(uint32_t))) {
+        SIM_FAIL("Track %u/%u Rev %u: Samples unvollständig", track, side, rev);
+        return;
+    }
+    g_frames++;
+    g_samples += hdr.sample_count;
+
+    // Jitter macht jede Umdrehung einzigartig: gleicher Inhalt = alter Puffer
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint32_t i = 0; i < hdr.sample_count; i++) {
+        hash = (hash ^ g_samples_buf[i]) * 1099511628211ULL;
+    }
+    if (hash == g_last_hash && opt->drive.jitter_ns != 0 && opt->image == NULL) {
+        SIM_FAIL("Track %u/%u Rev %u: Daten identisch mit vorigem Paket", track, side, rev);
+    }
+    g_last_hash = hash;
+
+    // Inhalt eines Images ist unbekannt, nur synthetische Flux prüfen
+    if (opt->image != NULL) {
+        return;
+    }
+
+    // Erwartete Werte in TIM2 Ticks (275 MHz)
+    const sim_drive_config_t* d = &opt->drive;
+    double cells = (d->mode == SIM_FLUX_GCR) ? 1.0 : 2.0;
+    double cell_ns = sim_drive_cell_ns(track);
+    double tick_ns = 1e9 / FLUX_TIMER_FREQ;
+    double period = 60.0 * FLUX_TIMER_FREQ / d->rpm;
+    double dmin = (cells * cell_ns - d->jitter_ns) / tick_ns - 2;
+    double dmax = ((cells + 2) * cell_ns + d->jitter_ns) / tick_ns + 2;
+    double mean_expected = (cells + 1) * cell_ns / tick_ns;
+
+    if (hdr.index_time < period * 0.995 || hdr.index_time > period * 1.005) {
+        SIM_FAIL("Track %u/%u Rev %u: index_time %u, erwartet %.0f",
+                 track, side, rev, hdr.index_time, period);
+    }
+
+    // Erster Abstand vom Index, dann alle Flanken-Abstände
+    if (g_samples_buf[0] > dmax + 10000 / tick_ns) {
+        SIM_FAIL("Track %u/%u Rev %u: erstes Sample %u nach Index",
+                 track, side, rev, g_samples_buf[0]);
+    }
+    uint32_t bad = 0;
+    for (uint32_t i = 1; i < hdr.sample_count; i++) {
+        uint32_t delta = g_samples_buf[i] - g_samples_buf[i - 1];
+        if (delta < dmin || delta > dmax) {
+            if (bad++ == 0) {
+                SIM_FAIL("Track %u/%u Rev %u: Abstand %u bei Sample %u",
+                         track, side, rev, delta, i);
+            }
+        }
+    }
+    double mean = (double)(g_samples_buf[hdr.sample_count - 1] - g_samples_buf[0]) /
+                  (hdr.sample_count - 1);
+    if (mean < mean_expected * 0.98 || mean > mean_expected * 1.02) {
+        SIM_FAIL("Track %u/%u Rev %u: mittlerer Abstand %.1f, erwartet %.1f",
+                 track, side, rev, mean, mean_expected);
+    }
+    if (hdr.sample_count < (period / mean_expected) * 0.97) {
+        SIM_FAIL("Track %u/%u Rev %u: nur %u Samples", track, side, rev, hdr.sample_count);
+    }
+}
+
+/* ============================================================================
+ * BERICHT
+ * ============================================================================ */
+
+static double cycles_to_us(uint64_t cycles) {
+    return (double)cycles / SIM_CYCLES_PER_US;
+}
+
+static void report_isrs(const sim_options_t* opt) {
+    static const IRQn_Type irqs[] = {
+        EXTI0_IRQn, DMA1_Stream0_IRQn, OTG_HS_IRQn, TIM7_IRQn, EXTI9_5_IRQn
+    };
+
+    printf("\n%-18s %8s %12s %12s %12s %12s\n",
+           "ISR", "count", "max us", "latency us", "host max us", "host avg us");
+    for (uint32_t i = 0; i < sizeof(irqs) / sizeof(irqs[0]); i++) {
+        const sim_irq_stats_t* s = sim_irq_stats(irqs[i]);
+        if (s->count == 0) {
+            continue;
+        }
+        double host_max = s->host_ns_max / 1000.0;
+        printf("%-18s %8u %12.2f %12.2f %12.2f %12.2f\n",
+               sim_irq_name(irqs[i]), s->count,
+               cycles_to_us(s->cycles_max), cycles_to_us(s->latency_max),
+               host_max, s->host_ns_total / 1000.0 / s->count);
+        if (opt->isr_budget_us != 0 && host_max > opt->isr_budget_us) {
+            SIM_FAIL("%s: %.2f us > Budget %u us", sim_irq_name(irqs[i]),
+                     host_max, opt->isr_budget_us);
+        }
+    }
+}
+
+static void report_telemetry(const ufi_telemetry_t* t) {
+    printf("\nTelemetrie\n");
+    printf("  revolutions %u, index %u, overruns %u, dma errors %u\n",
+           t->revolutions, t->index_pulses, t->flux_overruns, t->dma_errors);
+    printf("  usb tx %u bytes / %u packets, stalls %u, flux drops %u, event drops %u\n",
+           t->usb_tx_bytes, t->usb_tx_packets, t->usb_tx_stalls, t->flux_drops, t->event_drops);
+    printf("  cmd latency max %.1f us, loop max %.1f us, tx fill max %u bytes\n",
+           cycles_to_us(t->cmd_latency.max), cycles_to_us(t->loop_time.max), t->usb_tx_fill.max);
+}
+
+/* ============================================================================
+ * ABLAUF
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+        "ufi_sim [-t tracks] [-s sides] [-r revs] [--rpm N] [--cell ns] [--jitter ns]\n"
+        "        [--usb-mbps N] [--stall-ms N] [--isr-budget-us N] [--seed N]\n"
+        "        [--flux mfm|gcr] [--weak-us N] [--image file.scp]\n"
+        "        [--listen [host:]port] [--speed X]\n");
+}
+
+static int parse_options(int argc, char** argv, sim_options_t* opt) {
+    static const struct option longopts[] = {
+        { "tracks",        required_argument, NULL, 't' },
+        { "sides",         required_argument, NULL, 's' },
+        { "revs",          required_argument, NULL, 'r' },
+        { "rpm",           required_argument, NULL, 'R' },
+        { "cell",          required_argument, NULL, 'c' },
+        { "jitter",        required_argument, NULL, 'j' },
+        { "usb-mbps",      required_argument, NULL, 'u' },
+        { "stall-ms",      required_argument, NULL, 'S' },
+        { "isr-budget-us", required_argument, NULL, 'b' },
+        { "seed",          required_argument, NULL, 'x' },
+        { "flux",          required_argument, NULL, 'f' },
+        { "weak-us",       required_argument, NULL, 'w' },
+        { "image",         required_argument, NULL, 'i' },
+        { "listen",        required_argument, NULL, 'l' },
+        { "speed",         required_argument, NULL, 'p' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    *opt = (sim_options_t){
+        .tracks = 4, .sides = 2, .revs = 2, .usb_mbps = 40, .speed = 1.0,
+        .drive = { .rpm = 300, .cell_ns = 2000, .jitter_ns = 100, .spinup_ms = 150, .seed = 1 },
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "t:s:r:", longopts, NULL)) != -1) {
+        uint32_t v = (uint32_t)strtoul(optarg ? optarg : "0", NULL, 0);
+        switch (c) {
+            case 't': opt->tracks = v; break;
+            case 's': opt->sides = v; break;
+            case 'r': opt->revs = v; break;
+            case 'R': opt->drive.rpm = v; break;
+            case 'c': opt->drive.cell_ns = v; break;
+            case 'j': opt->drive.jitter_ns = v; break;
+            case 'u': opt->usb_mbps = v; break;
+            case 'S': opt->stall_ms = v; break;
+            case 'b': opt->isr_budget_us = v; break;
+            case 'x': opt->drive.seed = v; break;
+            case 'w': opt->drive.weak_us = v; break;
+            case 'i': opt->image = optarg; break;
+            case 'l': opt->listen = optarg; break;
+            case 'p': opt->speed = strtod(optarg, NULL); break;
+            case 'f':
+                if (strcmp(optarg, "mfm") == 0) {
+                    opt->drive.mode = SIM_FLUX_MFM;
+                } else if (strcmp(optarg, "gcr") == 0) {
+                    opt->drive.mode = SIM_FLUX_GCR;
+                } else {
+                    return -1;
+                }
+                break;
+            default:  return -1;
+        }
+    }
+
+    if (opt->tracks == 0 || opt->tracks > 84 || opt->sides == 0 || opt->sides > 2 ||
+        opt->revs == 0 || opt->revs > REVOLUTIONS_BUFFER || opt->drive.rpm == 0 ||
+        opt->drive.cell_ns == 0 || opt->usb_mbps == 0 || opt->speed < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    sim_options_t opt;
+    if (parse_options(argc, argv, &opt) != 0) {
+        usage();
+        return 2;
+    }
+
+    if (opt.image != NULL && sim_image_load(opt.image) != 0) {
+        fprintf(stderr, "%s: kein lesbares SCP-Image\n", opt.image);
+        return 2;
+    }
+
+    sim_hal_init();
+    sim_drive_init(&opt.drive);
+    sim_usb_init(opt.usb_mbps);
+    ufi_init();
+
+    if (opt.listen != NULL) {
+        return (sim_server_run(opt.listen, opt.speed) == 0) ? 0 : 1;
+    }
+
+    static uint8_t info[256];
+    ufi_telemetry_t telemetry;
+
+    uint8_t cmd_info[] = { UFI_CMD_GET_INFO };
+    uint8_t cmd_select[] = { UFI_CMD_SELECT_DRIVE, DRIVE_SHUGART_A };
+    uint8_t cmd_motor[] = { UFI_CMD_MOTOR_ON, 0, 0 };
+    uint8_t cmd_telem_reset[] = { UFI_CMD_GET_TELEMETRY, 1 };
+    uint8_t cmd_telem[] = { UFI_CMD_GET_TELEMETRY, 0 };
+
+    if (host_command(cmd_info, sizeof(cmd_info), info, sizeof(info)) < 0 ||
+        host_command(cmd_select, sizeof(cmd_select), info, sizeof(info)) < 0 ||
+        host_command(cmd_motor, sizeof(cmd_motor), info, sizeof(info)) < 0 ||
+        host_command(cmd_telem_reset, sizeof(cmd_telem_reset), &telemetry, sizeof(telemetry)) < 0) {
+        fprintf(stderr, "Setup fehlgeschlagen\n");
+        return 1;
+    }
+
+    uint64_t start = sim_cycles;
+    uint64_t bytes_start = sim_usb_stats()->tx_bytes;
+
+    for (uint32_t track = 0; track < opt.tracks; track++) {
+        for (uint32_t side = 0; side < opt.sides; side++) {
+            uint8_t cmd_read[] = { UFI_CMD_READ_TRACK_RAW, (uint8_t)track, (uint8_t)side, (uint8_t)opt.revs };
+            if (host_command(cmd_read, sizeof(cmd_read), info, sizeof(info)) < 0) {
+                continue;
+            }
+            if (opt.stall_ms != 0) {
+                sim_usb_host_stall(opt.stall_ms);
+            }
+            for (uint32_t rev = 0; rev < opt.revs; rev++) {
+                check_frame(&opt, (uint8_t)track, (uint8_t)side, (uint8_t)rev);
+            }
+        }
+    }
+
+    uint64_t elapsed = sim_cycles - start;
+    uint64_t bytes = sim_usb_stats()->tx_bytes - bytes_start;
+
+    if (host_command(cmd_telem, sizeof(cmd_telem), &telemetry, sizeof(telemetry)) < 0) {
+        memset(&telemetry, 0, sizeof(telemetry));
+    }
+
+    // Bericht
+    double seconds = (double)elapsed / SIM_CPU_HZ;
+    uint32_t expected = opt.tracks * opt.sides * opt.revs;
+    printf("UFI Host-Simulation: %u Tracks x %u Seiten x %u Umdrehungen, %u RPM, Zelle %u ns\n",
+           opt.tracks, opt.sides, opt.revs, opt.drive.rpm, opt.drive.cell_ns);
+    printf("  Pakete %u/%u, Samples %llu, Laufwerk-Flanken %u (Steps %u)\n",
+           g_frames, expected, (unsigned long long)g_samples,
+           sim_drive_state()->transitions, sim_drive_state()->steps);
+    printf("  Virtuelle Zeit %.3f s, %.1f ms pro Track, %.2f MB/s\n",
+           seconds, seconds * 1000 / (opt.tracks * opt.sides), bytes / seconds / 1e6);
+    printf("  USB: %u Transfers, %u abgewiesen (Daten verloren)\n",
+           sim_usb_stats()->tx_transfers, sim_usb_stats()->tx_rejected);
+
+    report_telemetry(&telemetry);
+    report_isrs(&opt);
+
+    if (g_frames != expected) {
+        SIM_FAIL("%u von %u Paketen angekommen", g_frames, expected);
+    }
+    if (sim_usb_stats()->tx_rejected != 0) {
+        SIM_FAIL("%u USB-Transfers abgewiesen", sim_usb_stats()->tx_rejected);
+    }
+    if (sim_hal_start_errors() != 0) {
+        SIM_FAIL("%u DMA/Capture-Starts abgelehnt (HAL_BUSY)", sim_hal_start_errors());
+    }
+    if (telemetry.flux_overruns != 0 || telemetry.dma_errors != 0) {
+        SIM_FAIL("Flux-Überläufe %u, DMA-Fehler %u", telemetry.flux_overruns, telemetry.dma_errors);
+    }
+
+    printf("\n%s (%u Fehler)\n", g_errors ? "FAIL" : "PASS", g_errors);
+    return g_errors ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Virtuelles UFI-Gerät: simulierter USB-Endpunkt über TCP
+ *
+ * Ersetzt das USB-Kabel zum CM5, damit die komplette Host-Pipeline
+ * (ufi_processor.py) ohne Hardware läuft und gemessen werden kann.
+ *
+ * Host → Gerät: pro Bulk-OUT-Transfer [Länge u16 LE][Daten]
+ * Gerät → Host: Bulk-IN-Daten als Bytestrom (Antworten, Flux, Events)
+ *
+ * Die virtuelle Zeit läuft im Verhältnis `speed` zur Wanduhr (1.0 =
+ * Echtzeit, 0 = so schnell wie möglich). Liest der Client nicht, läuft
+ * der Host-Puffer voll und der Endpunkt NAKt wie bei echtem USB.
+ */
+
+#include "ufi_sim.h"
+#include "ufi_firmware.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define SERVER_IDLE_MAX     (10 * SIM_CYCLES_PER_US)
+#define SERVER_HOST_WINDOW  (256 * 1024)    // Ungelesene Bytes bis NAK
+#define SERVER_OUT_SIZE     (64 * 1024)
+#define SERVER_IN_SIZE      (4 * 1024)
+
+static uint8_t out_buf[SERVER_OUT_SIZE];
+static uint32_t out_len = 0;
+static uint32_t out_pos = 0;
+
+static uint8_t in_buf[SERVER_IN_SIZE];
+static uint32_t in_len = 0;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int server_listen(const char* addr) {
+    char host[128] = "127.0.0.1";
+    const char* port = addr;
+    const char* colon = strrchr(addr, ':');
+    if (colon != NULL) {
+        size_t n = (size_t)(colon - addr);
+        if (n >= sizeof(host)) {
+            return -1;
+        }
+        memcpy(host, addr, n);
+        host[n] = '\0';
+        port = colon + 1;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM,
+                              .ai_flags = AI_PASSIVE };
+    struct addrinfo* res;
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res) != 0) {
+        return -1;
+    }
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    int one = 1;
+    if (fd < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(fd, res->ai_addr, res->ai_addrlen) != 0 ||
+        listen(fd, 1) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/**
+ * Vollständige OUT-Transfers an den simulierten Endpunkt übergeben
+ * @return false bei ungültigem Rahmen
+ */
+static bool server_deliver(void) {
+    uint32_t pos = 0;
+    while (in_len - pos >= 2) {
+        uint32_t len = in_buf[pos] | (in_buf[pos + 1] << 8);
+        if (len == 0 || len > USB_BULK_EP_SIZE) {
+            return false;
+        }
+        if (in_len - pos - 2 < len) {
+            break;
+        }
+        if (!sim_usb_host_send(&in_buf[pos + 2], len)) {
+            break;      // Empfangs-Slots voll, später erneut
+        }
+        pos += 2 + len;
+    }
+    memmove(in_buf, in_buf + pos, in_len - pos);
+    in_len -= pos;
+    return true;
+}
+
+/**
+ * Einen Client bedienen, bis er die Verbindung schließt
+ */
+static void server_client(int fd, double speed) {
+    uint64_t wall_start = wall_ns();
+    uint64_t sim_start = sim_cycles;
+
+    in_len = 0;
+    out_len = out_pos = 0;
+
+    for (;;) {
+        // Host → Gerät
+        ssize_t n = recv(fd, in_buf + in_len, sizeof(in_buf) - in_len, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            return;
+        }
+        if (n > 0) {
+            in_len += (uint32_t)n;
+        }
+        if (!server_deliver()) {
+            fprintf(stderr, "ufi_sim: ungültiger Transfer vom Client\n");
+            return;
+        }
+
+        ufi_main_poll();
+        sim_idle((uint32_t)SERVER_IDLE_MAX);
+
+        // Gerät → Host
+        if (out_pos == out_len) {
+            out_pos = 0;
+            out_len = sim_usb_host_read(out_buf, sizeof(out_buf));
+        }
+        if (out_pos < out_len) {
+            n = send(fd, out_buf + out_pos, out_len - out_pos, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return;
+            }
+            if (n > 0) {
+                out_pos += (uint32_t)n;
+            }
+        }
+
+        // Virtuelle Zeit an die Wanduhr binden; neue Befehle wecken sofort
+        if (speed > 0) {
+            uint64_t due = wall_start + (uint64_t)((sim_cycles - sim_start) * 1e9 / SIM_CPU_HZ / speed);
+            uint64_t now = wall_ns();
+            if (due > now + 1000000) {
+                struct pollfd p = { .fd = fd, .events = POLLIN };
+                if (out_pos < out_len) {
+                    p.events |= POLLOUT;
+                }
+                poll(&p, 1, (int)((due - now) / 1000000));
+            }
+        }
+    }
+}
+
+/**
+ * Virtuelles Gerät: auf addr ([host:]port) lauschen, Clients nacheinander
+ * bedienen. Der Firmware-Zustand bleibt zwischen Verbindungen erhalten.
+ */
+int sim_server_run(const char* addr, double speed) {
+    int lfd = server_listen(addr);
+    if (lfd < 0) {
+        fprintf(stderr, "ufi_sim: %s nicht verfügbar\n", addr);
+        return -1;
+    }
+    sim_usb_host_window(SERVER_HOST_WINDOW);
+    printf("ufi_sim: virtuelles Gerät auf %s\n", addr);
+    fflush(stdout);
+
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(lfd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        server_client(fd, speed);
+        close(fd);
+
+        // Nicht abgeholte Antworten verwerfen
+        uint8_t drop[4096];
+        while (sim_usb_host_read(drop, sizeof(drop)) != 0) {
+        }
+    }
+}
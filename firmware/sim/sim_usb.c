@@ -0,0 +1,244 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * USB-Endpunkt: CDC Bulk IN/OUT mit Übertragungszeit und Host-Seite
+ *
+ * TransmitPacket übernimmt die Daten sofort (Kopie) und ist danach für
+ * die Übertragungszeit belegt; die Fertigmeldung kommt als OTG_HS
+ * Interrupt. Befehle des Hosts laufen ebenfalls über den OTG_HS
+ * Interrupt in ufi_usb_receive_callback, wie CDC_Receive_HS.
+ */
+
+#include "ufi_sim.h"
+#include "usbd_core.h"
+#include "usbd_cdc.h"
+#include <stdlib.h>
+
+USBD_ClassTypeDef USBD_CDC;
+USBD_CDC_ItfTypeDef USBD_CDC_fops;
+USBD_DescriptorsTypeDef USBD_Desc;
+PCD_HandleTypeDef hpcd_USB_OTG_HS;
+
+extern void ufi_usb_receive_callback(uint8_t* buf, uint32_t len);
+
+#define SIM_USB_SETUP_CYCLES    (2 * SIM_CYCLES_PER_US)    // Pro Transfer
+#define SIM_USB_RX_SLOTS        16
+#define SIM_USB_PACKET          512
+
+static sim_usb_stats_t stats;
+
+// Device → Host
+static uint8_t* tx_buf = NULL;
+static uint32_t tx_len = 0;
+static uint8_t tx_inflight[64 * 1024];
+static uint32_t tx_inflight_len = 0;
+static bool tx_busy = false;
+static uint64_t tx_done_at = SIM_NEVER;
+static uint64_t stall_until = 0;
+static uint32_t host_window = 0;
+
+// Beim Host angekommen, noch nicht gelesen
+static uint8_t* host_buf = NULL;
+static uint32_t host_cap = 0;
+static uint32_t host_len = 0;
+static uint32_t host_pos = 0;
+
+// Host → Device
+static uint8_t rx_data[SIM_USB_RX_SLOTS][SIM_USB_PACKET];
+static uint32_t rx_size[SIM_USB_RX_SLOTS];
+static uint32_t rx_head = 0;
+static uint32_t rx_tail = 0;
+static uint64_t rx_at = SIM_NEVER;
+
+static bool irq_tx = false;
+static bool irq_rx = false;
+
+/* ============================================================================
+ * EREIGNISQUELLE
+ * ============================================================================ */
+
+static uint64_t tx_complete_at(void) {
+    if (!tx_busy || irq_tx) {
+        return SIM_NEVER;
+    }
+    if (host_window != 0 && host_len - host_pos > host_window) {
+        return SIM_NEVER;   // Host-Puffer voll: NAK bis gelesen wird
+    }
+    return (tx_done_at > stall_until) ? tx_done_at : stall_until;
+}
+
+static uint64_t usb_next(void) {
+    uint64_t t = tx_complete_at();
+    uint64_t r = irq_rx ? SIM_NEVER : rx_at;
+    return (t < r) ? t : r;
+}
+
+static void usb_run(uint64_t now) {
+    if (now >= tx_complete_at()) {
+        irq_tx = true;
+    }
+    if (!irq_rx && now >= rx_at) {
+        irq_rx = true;
+        rx_at = SIM_NEVER;
+    }
+    sim_irq_pend(OTG_HS_IRQn);
+}
+
+static void host_append(const uint8_t* data, uint32_t len) {
+    if (host_pos > 0 && host_pos == host_len) {
+        host_pos = host_len = 0;
+    }
+    if (host_len + len > host_cap) {
+        // Gelesenes verwerfen, dann ggf. vergrößern
+        memmove(host_buf, host_buf + host_pos, host_len - host_pos);
+        host_len -= host_pos;
+        host_pos = 0;
+        while (host_len + len > host_cap) {
+            host_cap = host_cap ? host_cap * 2 : 256 * 1024;
+        }
+        host_buf = realloc(host_buf, host_cap);
+        if (host_buf == NULL) {
+            abort();
+        }
+    }
+    memcpy(host_buf + host_len, data, len);
+    host_len += len;
+}
+
+/**
+ * OTG_HS Interrupt: Transfer fertig / Befehl empfangen
+ */
+void HAL_PCD_IRQHandler(PCD_HandleTypeDef* hpcd) {
+    (void)hpcd;
+
+    if (irq_tx) {
+        irq_tx = false;
+        host_append(tx_inflight, tx_inflight_len);
+        stats.tx_bytes += tx_inflight_len;
+        stats.tx_transfers++;
+        tx_busy = false;
+        tx_done_at = SIM_NEVER;
+    }
+
+    if (irq_rx) {
+        irq_rx = false;
+        if (rx_tail != rx_head) {
+            uint32_t slot = rx_tail % SIM_USB_RX_SLOTS;
+            rx_tail++;
+            stats.rx_commands++;
+            ufi_usb_receive_callback(rx_data[slot], rx_size[slot]);
+        }
+        if (rx_tail != rx_head) {
+            rx_at = sim_cycles + SIM_USB_SETUP_CYCLES;
+        }
+    }
+}
+
+/* ============================================================================
+ * USB DEVICE LIBRARY
+ * ============================================================================ */
+
+uint8_t USBD_Init(USBD_HandleTypeDef* pdev, USBD_DescriptorsTypeDef* desc, uint8_t id) {
+    (void)desc;
+    (void)id;
+    pdev->pClassData = NULL;
+    return USBD_OK;
+}
+
+uint8_t USBD_RegisterClass(USBD_HandleTypeDef* pdev, USBD_ClassTypeDef* pclass) {
+    pdev->pClassData = pclass;
+    return USBD_OK;
+}
+
+uint8_t USBD_Start(USBD_HandleTypeDef* pdev) {
+    (void)pdev;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef* pdev, USBD_CDC_ItfTypeDef* fops) {
+    pdev->pUserData = fops;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_SetTxBuffer(USBD_HandleTypeDef* pdev, uint8_t* buf, uint32_t len) {
+    (void)pdev;
+    tx_buf = buf;
+    tx_len = len;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_TransmitPacket(USBD_HandleTypeDef* pdev) {
+    (void)pdev;
+    sim_advance(SIM_CYCLES_HAL);
+
+    if (tx_busy) {
+        stats.tx_rejected++;
+        return USBD_BUSY;
+    }
+    if (tx_len > sizeof(tx_inflight)) {
+        return USBD_FAIL;
+    }
+
+    memcpy(tx_inflight, tx_buf, tx_len);
+    tx_inflight_len = tx_len;
+    tx_busy = true;
+    tx_done_at = sim_cycles + SIM_USB_SETUP_CYCLES +
+                 (uint64_t)tx_len * stats.cycles_per_kb / 1024;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_GetTxState(USBD_HandleTypeDef* pdev) {
+    (void)pdev;
+    sim_advance(SIM_CYCLES_HAL);
+    return tx_busy ? 1 : 0;
+}
+
+/* ============================================================================
+ * HOST-SEITE
+ * ============================================================================ */
+
+void sim_usb_init(uint32_t mbytes_per_s) {
+    static const sim_source_t source = { usb_next, usb_run };
+
+    stats.cycles_per_kb = (uint32_t)(SIM_CPU_HZ * 1024 / (mbytes_per_s * 1000000ULL));
+    sim_add_source(&source);
+}
+
+bool sim_usb_host_send(const void* data, uint32_t len) {
+    if (rx_head - rx_tail >= SIM_USB_RX_SLOTS || len > SIM_USB_PACKET) {
+        return false;
+    }
+    uint32_t slot = rx_head % SIM_USB_RX_SLOTS;
+    memcpy(rx_data[slot], data, len);
+    rx_size[slot] = len;
+    rx_head++;
+    if (rx_at == SIM_NEVER && !irq_rx) {
+        rx_at = sim_cycles + SIM_USB_SETUP_CYCLES;
+    }
+    return true;
+}
+
+uint32_t sim_usb_host_available(void) {
+    return host_len - host_pos;
+}
+
+uint32_t sim_usb_host_read(void* data, uint32_t len) {
+    uint32_t n = sim_usb_host_available();
+    if (len > n) {
+        len = n;
+    }
+    memcpy(data, host_buf + host_pos, len);
+    host_pos += len;
+    return len;
+}
+
+void sim_usb_host_stall(uint32_t ms) {
+    stall_until = sim_cycles + (uint64_t)ms * SIM_CYCLES_PER_MS;
+}
+
+void sim_usb_host_window(uint32_t bytes) {
+    host_window = bytes;
+}
+
+const sim_usb_stats_t* sim_usb_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,150 @@
+/**
+ * UFI Flux Engine - Host-Simulation
+ * Schnittstellen zwischen simuliertem HAL, Laufwerk, USB und Runner
+ */
+
+#ifndef UFI_SIM_H
+#define UFI_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+
+/* ============================================================================
+ * VIRTUELLE ZEIT (sim_hal.c)
+ * ============================================================================ */
+
+#define SIM_CPU_HZ          550000000ULL
+#define SIM_CYCLES_PER_US   (SIM_CPU_HZ / 1000000ULL)
+#define SIM_CYCLES_PER_MS   (SIM_CPU_HZ / 1000ULL)
+#define SIM_NEVER           UINT64_MAX
+
+// Kosten pro Zugriff (grob, hält Busy-Waits endlich)
+#define SIM_CYCLES_REG      4       // DWT, Register
+#define SIM_CYCLES_HAL      20      // HAL-Funktion
+
+extern volatile uint64_t sim_cycles;    // Virtuelle CPU-Zyklen seit Start
+
+void sim_advance(uint32_t cycles);
+void sim_idle(uint32_t max_cycles);     // Bis zum nächsten Ereignis schlafen
+
+// Ereignisquellen: nächster Zeitpunkt + Ausführung
+typedef struct {
+    uint64_t (*next)(void);
+    void (*run)(uint64_t now);
+} sim_source_t;
+
+void sim_add_source(const sim_source_t* source);
+
+/* ============================================================================
+ * INTERRUPTS
+ * ============================================================================ */
+
+#define SIM_IRQ_COUNT       128
+
+typedef struct {
+    uint32_t count;
+    uint64_t cycles_max;        // Virtuelle Zyklen im Handler
+    uint64_t host_ns_max;       // Echte Laufzeit auf dem Host
+    uint64_t host_ns_total;
+    uint64_t latency_max;       // Zyklen von Pending bis Eintritt
+} sim_irq_stats_t;
+
+void sim_irq_pend(IRQn_Type irq);
+const sim_irq_stats_t* sim_irq_stats(IRQn_Type irq);
+const char* sim_irq_name(IRQn_Type irq);
+
+/* ============================================================================
+ * PERIPHERIE (sim_hal.c)
+ * ============================================================================ */
+
+// Externe Pegel an Eingängen (Laufwerk, Bus), Default high (Pull-up).
+// Flanken an EXTI-Leitungen lösen den zugehörigen Interrupt aus.
+void sim_gpio_set_input(GPIO_TypeDef* port, uint16_t pin, bool high);
+uint32_t sim_gpio_output(GPIO_TypeDef* port);
+
+// Flux-Flanke an TIM2 CH1 (Input Capture → DMA)
+void sim_tim2_capture(void);
+bool sim_tim2_capturing(void);
+
+void sim_hal_init(void);
+uint32_t sim_hal_start_errors(void);   // Start_DMA/DMA_Start abgelehnt (BUSY)
+
+/* ============================================================================
+ * LAUFWERK (sim_drive.c)
+ * ============================================================================ */
+
+typedef enum {
+    SIM_FLUX_MFM = 0,           // 2-4 Zellen (PC, Amiga, Atari ST)
+    SIM_FLUX_GCR,               // 1-3 Zellen, 1541 Geschwindigkeitszonen
+} sim_flux_mode_t;
+
+typedef struct {
+    uint32_t rpm;               // Nenndrehzahl
+    uint32_t cell_ns;           // MFM Bitzelle (2000 = DD, 1000 = HD)
+    uint32_t jitter_ns;         // Gleichverteilt ±
+    uint32_t spinup_ms;         // Bis zum ersten Index
+    uint32_t seed;
+    sim_flux_mode_t mode;
+    uint32_t weak_us;           // Schwacher Bereich ab Mitte der Umdrehung (0 = aus)
+} sim_drive_config_t;
+
+typedef struct {
+    bool motor;
+    bool selected;
+    uint8_t track;
+    uint8_t side;
+    uint32_t steps;
+    uint32_t index_pulses;
+    uint64_t period_cycles;
+    uint32_t transitions;       // Gesamt
+    uint32_t captured;          // Davon in den DMA geschrieben
+} sim_drive_state_t;
+
+void sim_drive_init(const sim_drive_config_t* config);
+void sim_drive_pins_changed(void);      // Ausgänge geändert (aus sim_hal.c)
+const sim_drive_state_t* sim_drive_state(void);
+uint32_t sim_drive_cell_ns(uint8_t track);  // Synthetische Bitzelle des Tracks
+
+/* ============================================================================
+ * FLUX-IMAGES (sim_image.c)
+ * ============================================================================ */
+
+typedef struct {
+    const uint8_t* cells;       // 16 Bit Big Endian, 0 = +65536
+    uint32_t count;
+    uint32_t tick_ns;           // Auflösung der Zellwerte
+    uint64_t index_ns;          // Umdrehungsdauer
+} sim_image_rev_t;
+
+int sim_image_load(const char* path);   // SuperCard Pro (.scp)
+bool sim_image_loaded(void);
+bool sim_image_rev(uint8_t track, uint8_t side, uint32_t rev, sim_image_rev_t* out);
+
+/* ============================================================================
+ * USB ENDPUNKT (sim_usb.c)
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t tx_bytes;          // Beim Host angekommen
+    uint32_t tx_transfers;
+    uint32_t tx_rejected;       // TransmitPacket während Übertragung (Daten verloren)
+    uint32_t rx_commands;
+    uint32_t cycles_per_kb;     // Übertragungszeit-Modell
+} sim_usb_stats_t;
+
+void sim_usb_init(uint32_t mbytes_per_s);
+bool sim_usb_host_send(const void* data, uint32_t len);  // false = Puffer voll
+uint32_t sim_usb_host_available(void);
+uint32_t sim_usb_host_read(void* data, uint32_t len);
+void sim_usb_host_stall(uint32_t ms);     // Host liest eine Zeit lang nicht
+void sim_usb_host_window(uint32_t bytes); // Ungelesen darüber: NAK (0 = unbegrenzt)
+const sim_usb_stats_t* sim_usb_stats(void);
+
+/* ============================================================================
+ * VIRTUELLES GERÄT (sim_server.c)
+ * ============================================================================ */
+
+int sim_server_run(const char* addr, double speed);    // Kehrt nur bei Fehler zurück
+
+#endif /* UFI_SIM_H */
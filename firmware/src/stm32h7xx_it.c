@@ -22,6 +22,10 @@ extern PCD_HandleTypeDef hpcd_USB_OTG_HS;
 /* Aus ufi_main.c */
 extern void ufi_flux_index_handler(void);
 
+/* Aus ufi_drive.c */
+extern void ufi_drive_index_event(uint32_t cycles);
+extern void ufi_drive_signal_irq(void);
+
 /* ============================================================================
  * CORTEX-M7 PROCESSOR EXCEPTIONS
  * ============================================================================ */
@@ -77,7 +81,9 @@ void SysTick_Handler(void)
  */
 void TIM2_IRQHandler(void)
 {
+    UFI_TRACE_ENTER(TRACE_ID_TIM2);
     HAL_TIM_IRQHandler(&htim2);
+    UFI_TRACE_EXIT(TRACE_ID_TIM2);
 }
 
 /**
@@ -85,7 +91,9 @@ void TIM2_IRQHandler(void)
  */
 void DMA1_Stream0_IRQHandler(void)
 {
+    UFI_TRACE_ENTER(TRACE_ID_DMA1_S0);
     HAL_DMA_IRQHandler(&hdma_tim2);
+    UFI_TRACE_EXIT(TRACE_ID_DMA1_S0);
 }
 
 /**
@@ -93,11 +101,66 @@ void DMA1_Stream0_IRQHandler(void)
  */
 void EXTI0_IRQHandler(void)
 {
+    uint32_t cycles = DWT->CYCCNT;  /* Zeitstempel so früh wie möglich */
+    
+    UFI_TRACE_ENTER(TRACE_ID_EXTI0);
     if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_0))
     {
         __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_0);
+        ufi_drive_index_event(cycles);
         ufi_flux_index_handler();
     }
+    UFI_TRACE_EXIT(TRACE_ID_EXTI0);
+}
+
+/**
+ * @brief  EXTI Line2 Interrupt (WPROT - PC2)
+ */
+void EXTI2_IRQHandler(void)
+{
+    if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_2))
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_2);
+        ufi_drive_signal_irq();
+    }
+}
+
+/**
+ * @brief  EXTI Line4 Interrupt (DKCHG - PC4)
+ */
+void EXTI4_IRQHandler(void)
+{
+    if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_4))
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_4);
+        ufi_drive_signal_irq();
+    }
+}
+
+/**
+ * @brief  EXTI Lines 5-9 Interrupt (READY - PC5)
+ */
+void EXTI9_5_IRQHandler(void)
+{
+    if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_5))
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_5);
+        ufi_drive_signal_irq();
+    }
+}
+
+/**
+ * @brief  TIM7 Update Interrupt (IEC Sende-/Empfangs-Tick)
+ */
+void TIM7_IRQHandler(void)
+{
+    UFI_TRACE_ENTER(TRACE_ID_TIM7);
+    if (TIM7->SR & TIM_SR_UIF)
+    {
+        TIM7->SR = ~TIM_SR_UIF;
+        ufi_iec_tick();
+    }
+    UFI_TRACE_EXIT(TRACE_ID_TIM7);
 }
 
 /**
@@ -105,7 +168,9 @@ void EXTI0_IRQHandler(void)
  */
 void OTG_HS_IRQHandler(void)
 {
+    UFI_TRACE_ENTER(TRACE_ID_OTG_HS);
     HAL_PCD_IRQHandler(&hpcd_USB_OTG_HS);
+    UFI_TRACE_EXIT(TRACE_ID_OTG_HS);
 }
 
 /**
@@ -48,13 +48,6 @@ extern TIM_HandleTypeDef htim2;
  * GPIO Status lesen
  * Gibt Bitmask aller Input-Signale zurück
  */
-typedef struct __packed {
-    uint16_t fdd_inputs;    // Bit0=INDEX, Bit1=TRK0, Bit2=WPROT, Bit3=RDATA, Bit4=DKCHG
-    uint16_t fdd_outputs;   // Bit0=MOTOR_A, Bit1=MOTOR_B, Bit2=SEL_A, Bit3=SEL_B, etc.
-    uint16_t iec_signals;   // Bit0=ATN, Bit1=CLK, Bit2=DATA, Bit3=SRQ, Bit4=RESET
-    uint16_t leds;          // Bit0=PWR, Bit1=ACT, Bit2=FDD, Bit3=USB
-} gpio_status_t;
-
 gpio_status_t ufi_debug_gpio_read(void) {
     gpio_status_t status = {0};
     
@@ -170,16 +163,6 @@ int ufi_debug_gpio_set(uint8_t gpio_id, uint8_t state) {
 /**
  * Timer Status lesen
  */
-typedef struct __packed {
-    uint32_t tim2_counter;      // Aktueller TIM2 Zählerwert
-    uint32_t tim2_prescaler;    // TIM2 Prescaler
-    uint32_t tim2_period;       // TIM2 Period
-    uint32_t sysclk_freq;       // System Clock Frequenz
-    uint32_t hclk_freq;         // AHB Clock
-    uint32_t pclk1_freq;        // APB1 Clock (Timer)
-    uint32_t uptime_ms;         // Uptime in ms
-} timer_status_t;
-
 timer_status_t ufi_debug_timer_read(void) {
     timer_status_t status = {0};
     
@@ -195,51 +178,26 @@ timer_status_t ufi_debug_timer_read(void) {
 }
 
 /**
- * Index-Puls Timing messen
- * Misst Zeit zwischen zwei Index-Pulsen (= 1 Umdrehung)
- * @return Zeit in Timer-Ticks, 0 bei Timeout
+ * Index-Puls Timing
+ * Letzte Index-Periode (= 1 Umdrehung) aus dem Drehzahl-Monitor,
+ * blockiert nicht mehr
+ * @return Zeit in Timer-Ticks, 0 ohne Index
  */
 uint32_t ufi_debug_measure_index(void) {
-    uint32_t timeout = HAL_GetTick() + 1000;  // 1s Timeout
-    
-    // Warte auf erste fallende Flanke
-    while (HAL_GPIO_ReadPin(PIN_FDD_INDEX.port, PIN_FDD_INDEX.pin) == GPIO_PIN_RESET) {
-        if (HAL_GetTick() > timeout) return 0;
-    }
-    while (HAL_GPIO_ReadPin(PIN_FDD_INDEX.port, PIN_FDD_INDEX.pin) == GPIO_PIN_SET) {
-        if (HAL_GetTick() > timeout) return 0;
-    }
-    
-    // Erste Flanke - Timer starten
-    uint32_t start = __HAL_TIM_GET_COUNTER(&htim2);
+    rpm_monitor_t rpm;
+    ufi_drive_rpm_monitor(&rpm);
     
-    // Warte auf zweite fallende Flanke
-    while (HAL_GPIO_ReadPin(PIN_FDD_INDEX.port, PIN_FDD_INDEX.pin) == GPIO_PIN_RESET) {
-        if (HAL_GetTick() > timeout) return 0;
-    }
-    while (HAL_GPIO_ReadPin(PIN_FDD_INDEX.port, PIN_FDD_INDEX.pin) == GPIO_PIN_SET) {
-        if (HAL_GetTick() > timeout) return 0;
-    }
-    
-    uint32_t end = __HAL_TIM_GET_COUNTER(&htim2);
-    
-    return end - start;
+    return (uint32_t)(((uint64_t)rpm.period_last_ns * FLUX_TIMER_FREQ) / 1000000000ULL);
 }
 
 /**
- * RPM aus Index-Timing berechnen
+ * Mittlere Drehzahl über das Monitor-Fenster
  */
 uint16_t ufi_debug_measure_rpm(void) {
-    uint32_t ticks = ufi_debug_measure_index();
-    if (ticks == 0) return 0;
-    
-    // RPM = 60 / (ticks * tick_period)
-    // Bei 275 MHz: tick_period = 3.636 ns
-    // RPM = 60 / (ticks * 3.636e-9) = 60e9 / (ticks * 3.636)
-    // RPM ≈ 16.5e9 / ticks
+    rpm_monitor_t rpm;
+    ufi_drive_rpm_monitor(&rpm);
     
-    uint64_t rpm = (60ULL * FLUX_TIMER_FREQ) / ticks;
-    return (uint16_t)rpm;
+    return (uint16_t)((rpm.rpm_x100 + 50) / 100);
 }
 
 /* ============================================================================
@@ -249,14 +207,6 @@ uint16_t ufi_debug_measure_rpm(void) {
 /**
  * Memory-Info lesen
  */
-typedef struct __packed {
-    uint32_t flash_size;        // Flash Größe in KB
-    uint32_t ram_size;          // RAM Größe (DTCM + SRAM)
-    uint32_t unique_id[3];      // 96-bit Unique ID
-    uint16_t revision;          // Device Revision
-    uint16_t device_id;         // Device ID
-} memory_info_t;
-
 memory_info_t ufi_debug_memory_read(void) {
     memory_info_t info = {0};
     
@@ -6,6 +6,8 @@
 
 #include "ufi_firmware.h"
 #include "stm32h7xx_hal.h"
+#include <string.h>
+#include <math.h>
 
 /* ============================================================================
  * GPIO DEFINITIONEN
@@ -51,13 +53,56 @@
 static drive_type_t g_current_drive = DRIVE_NONE;
 static drive_status_t g_drive_status[6];  // Index 0 nicht verwendet
 
+// Index-Perioden (DWT-Zeitstempel aus EXTI0, in CPU-Zyklen)
+static volatile uint32_t g_index_last_cycles = 0;
+static volatile uint32_t g_index_period_cycles = 0;
+static volatile uint32_t g_index_count = 0;
+static volatile uint32_t g_index_last_tick = 0;
+
+// Drehzahl-Monitor: letzte RPM_WINDOW Perioden (Zyklen), Füllstand
+static uint32_t g_rpm_periods[RPM_WINDOW];
+static volatile uint32_t g_rpm_head = 0;
+static volatile uint32_t g_rpm_fill = 0;
+
+// Signal-Events (EXTI auf DKCHG/READY/WPROT, Index über EXTI0)
+static volatile uint8_t g_signal_pending = 0;
+static volatile uint32_t g_signal_tick = 0;
+static uint8_t g_event_mask = 0;
+static uint8_t g_signals_reported = 0;
+
 // Timing-Konstanten (µs)
 #define STEP_PULSE_US       3
 #define STEP_RATE_US        3000
 #define SETTLE_TIME_US      15000
-#define MOTOR_SPINUP_MS     500
+#define MOTOR_SPINUP_MS     500     // Fallback ohne Index (Apple II)
 #define DIR_SETUP_US        1
 
+// Spin-up Erkennung über Index-Periode
+#define SPINUP_TIMEOUT_MS   2000    // Default-Timeout bis Drehzahl stabil (≥ 3 Index-Flanken + Hochlauf)
+#define SPINUP_TOLERANCE    5       // Max. Abweichung aufeinanderfolgender Perioden (‰)
+#define SPINUP_NOMINAL_TOL  30      // Max. Abweichung von 300/360 RPM (‰, Laufwerke ±1,5%)
+#define SPINUP_MIN_PERIOD_MS 100    // Kürzer = Prellen / kein echter Index (>600 RPM)
+
+// Signal-Überwachung
+#define SIGNAL_DEBOUNCE_MS  5       // Stabil nach letzter Flanke
+#define INDEX_LOST_MS       500     // Kein Index = Disk fehlt / Motor aus
+
+static uint16_t g_spinup_timeout_ms = SPINUP_TIMEOUT_MS;
+
+// Laufende Spin-up Überwachung (ufi_drive_spinup_poll)
+typedef struct {
+    bool active;
+    bool fixed;             // Ohne Index: nur Wartezeit (Apple II)
+    uint32_t start;         // HAL_GetTick() bei Motor an
+    uint32_t timeout_ms;
+    uint32_t seen;          // Letzter ausgewerteter g_index_count
+    uint32_t prev_period;
+} spinup_state_t;
+
+static spinup_state_t g_spinup;
+
+static void spinup_begin(uint32_t timeout_ms, bool fixed);
+
 /* ============================================================================
  * DELAY FUNKTIONEN
  * ============================================================================ */
@@ -234,30 +279,213 @@ int ufi_drive_motor(bool on) {
             return -1;
     }
     
-    g_drive_status[g_current_drive].motor_on = on;
+    drive_status_t* status = &g_drive_status[g_current_drive];
+    bool was_on = status->motor_on;
+    status->motor_on = on;
+    
+    if (!on) {
+        status->rpm = 0;
+        g_spinup.active = false;
+        return 0;
+    }
     
-    if (on) {
-        HAL_Delay(MOTOR_SPINUP_MS);  // Spin-up Zeit
+    // Läuft bereits mit stabiler Drehzahl - nicht erneut warten
+    if (was_on && status->rpm != 0) {
+        return 0;
+    }
+    
+    // Hochlauf nur starten, Ende meldet ufi_drive_spinup_poll()
+    switch (g_current_drive) {
+        case DRIVE_SHUGART_A:
+        case DRIVE_SHUGART_B:
+        case DRIVE_AMIGA: {
+            // Index-Messung neu beginnen: keine Periode über die Motor-Aus-Pause
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            g_index_count = 0;
+            g_index_period_cycles = 0;
+            g_rpm_fill = 0;
+            __set_PRIMASK(primask);
+            spinup_begin(0, false);
+            break;
+        }
+            
+        case DRIVE_APPLE_II:
+            // Disk II hat keinen Index-Sensor - feste Spin-up Zeit
+            spinup_begin(MOTOR_SPINUP_MS, true);
+            break;
+            
+        default:
+            break;
     }
     
     return 0;
 }
 
 /* ============================================================================
- * STEP FUNKTIONEN
+ * SPIN-UP ERKENNUNG
  * ============================================================================ */
 
-int ufi_drive_step(int direction) {
-    if (g_current_drive == DRIVE_NONE) {
-        return -1;
+/**
+ * Index-Flanke registrieren (aus EXTI0_IRQHandler)
+ * @param cycles  DWT->CYCCNT beim Eintritt in den Interrupt
+ */
+void ufi_drive_index_event(uint32_t cycles) {
+    uint32_t period = cycles - g_index_last_cycles;
+    uint32_t now = HAL_GetTick();
+    
+    // Nach Index-Verlust (Motor aus, Disk-Wechsel) zählt die Flanke als erste:
+    // g_index_last_cycles ist veraltet, keine Periode
+    bool lost = g_index_count == 0 || (now - g_index_last_tick) >= INDEX_LOST_MS;
+    
+    // Prellen / Störimpulse ignorieren
+    if (!lost && period < SPINUP_MIN_PERIOD_MS * (SystemCoreClock / 1000)) {
+        return;
     }
     
-    if (g_current_drive == DRIVE_APPLE_II) {
-        return ufi_drive_apple_step(direction);
+    if (lost) {
+        g_rpm_fill = 0;
+    } else {
+        g_rpm_periods[g_rpm_head] = period;
+        g_rpm_head = (g_rpm_head + 1) & (RPM_WINDOW - 1);
+        if (g_rpm_fill < RPM_WINDOW) {
+            g_rpm_fill++;
+        }
     }
     
-    // Shugart/Amiga Step
+    g_index_period_cycles = lost ? 0 : period;
+    g_index_last_cycles = cycles;
+    g_index_last_tick = now;
+    g_index_count++;
+    UFI_TELEM_INC(index_pulses);
+}
+
+/**
+ * Index-Periode nahe der Nenndrehzahl (300 oder 360 RPM)?
+ */
+static bool spinup_at_nominal(uint32_t period) {
+    static const uint8_t nominal_rpm[] = { 30, 36 };    // x10
+    
+    for (uint32_t i = 0; i < sizeof(nominal_rpm); i++) {
+        uint32_t nominal = (uint32_t)((6ULL * SystemCoreClock) / nominal_rpm[i]);
+        uint32_t diff = (period > nominal) ? (period - nominal) : (nominal - period);
+        if ((uint64_t)diff * 1000 <= (uint64_t)nominal * SPINUP_NOMINAL_TOL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Spin-up Überwachung starten
+ * @param timeout_ms  Max. Wartezeit (0 = konfigurierter Timeout)
+ * @param fixed       Ohne Index nur timeout_ms abwarten
+ */
+static void spinup_begin(uint32_t timeout_ms, bool fixed) {
+    g_spinup.timeout_ms = (timeout_ms == 0) ? g_spinup_timeout_ms : timeout_ms;
+    g_spinup.fixed = fixed;
+    g_spinup.start = HAL_GetTick();
+    g_spinup.seen = g_index_count;
+    g_spinup.prev_period = 0;
+    g_spinup.active = true;
+}
+
+/**
+ * Spin-up Fortschritt prüfen (aus task_drive bzw. ufi_drive_wait_spinup)
+ * 
+ * Vergleicht aufeinanderfolgende Index-Perioden; sobald zwei Perioden
+ * innerhalb SPINUP_TOLERANCE liegen und die Periode nahe 300 oder 360 RPM
+ * liegt, gilt das Laufwerk als bereit. Gegen Ende des Hochlaufs ändert
+ * sich die Periode kaum noch, die Nenndrehzahl ist aber noch nicht
+ * erreicht. Typisch nach 2-3 Umdrehungen statt fester 500ms.
+ * 
+ * @param rpm  Gemessene Drehzahl (optional, 0 bei Timeout / ohne Index)
+ * @return 1 = läuft noch, UFI_OK, UFI_ERR_NO_INDEX bei Timeout
+ */
+int ufi_drive_spinup_poll(uint16_t* rpm) {
+    if (rpm) {
+        *rpm = 0;
+    }
+    if (!g_spinup.active) {
+        return UFI_OK;
+    }
+    
+    bool expired = (HAL_GetTick() - g_spinup.start) >= g_spinup.timeout_ms;
+    
+    if (g_spinup.fixed) {
+        g_spinup.active = !expired;
+        return expired ? UFI_OK : 1;
+    }
+    
+    if (g_index_count != g_spinup.seen) {
+        g_spinup.seen = g_index_count;
+        
+        uint32_t period = g_index_period_cycles;
+        uint32_t prev_period = g_spinup.prev_period;
+        
+        // Erste Flanke liefert noch keine Periode
+        if (period != 0 && prev_period != 0) {
+            uint32_t diff = (period > prev_period) ? 
+                            (period - prev_period) : (prev_period - period);
+            
+            if ((uint64_t)diff * 1000 <= (uint64_t)prev_period * SPINUP_TOLERANCE &&
+                spinup_at_nominal(period)) {
+                uint16_t measured = (uint16_t)((60ULL * SystemCoreClock) / period);
+                if (rpm) {
+                    *rpm = measured;
+                }
+                if (g_current_drive != DRIVE_NONE) {
+                    g_drive_status[g_current_drive].rpm = measured;
+                }
+                g_spinup.active = false;
+                return UFI_OK;
+            }
+        }
+        if (period != 0) {
+            g_spinup.prev_period = period;
+        }
+    }
     
+    if (expired) {
+        g_spinup.active = false;
+        return UFI_ERR_NO_INDEX;
+    }
+    return 1;
+}
+
+/**
+ * Warten bis der Motor stabil dreht (blockierend, siehe ufi_drive_spinup_poll)
+ * 
+ * @param timeout_ms  Max. Wartezeit (0 = konfigurierter Timeout)
+ * @param rpm         Gemessene Drehzahl (optional, 0 bei Timeout)
+ * @return UFI_OK, UFI_ERR_NO_INDEX bei Timeout
+ */
+int ufi_drive_wait_spinup(uint32_t timeout_ms, uint16_t* rpm) {
+    int ret;
+    
+    spinup_begin(timeout_ms, false);
+    while ((ret = ufi_drive_spinup_poll(rpm)) == 1) {
+        UFI_WATCHDOG_FEED();
+    }
+    return ret;
+}
+
+/**
+ * Spin-up Timeout setzen
+ * @param timeout_ms  0 = Default (SPINUP_TIMEOUT_MS)
+ */
+void ufi_drive_set_spinup_timeout(uint16_t timeout_ms) {
+    g_spinup_timeout_ms = (timeout_ms == 0) ? SPINUP_TIMEOUT_MS : timeout_ms;
+}
+
+/* ============================================================================
+ * STEP FUNKTIONEN
+ * ============================================================================ */
+
+/**
+ * Ein Step-Puls (Shugart/Amiga) ohne Step-Rate Wartezeit
+ */
+static void step_pulse(int direction) {
     // Direction setzen (active low)
     // DIR low = Step In (zur Mitte), DIR high = Step Out
     HAL_GPIO_WritePin(FDD_PORT_B, FDD_DIR_PIN,
@@ -270,9 +498,6 @@ int ufi_drive_step(int direction) {
     delay_us(STEP_PULSE_US);
     HAL_GPIO_WritePin(FDD_PORT_B, FDD_STEP_PIN, GPIO_PIN_SET);
     
-    // Step Rate
-    delay_us(STEP_RATE_US);
-    
     // Track-Counter aktualisieren
     drive_status_t* status = &g_drive_status[g_current_drive];
     if (direction > 0 && status->current_track < 83) {
@@ -280,53 +505,149 @@ int ufi_drive_step(int direction) {
     } else if (direction < 0 && status->current_track > 0) {
         status->current_track--;
     }
+}
+
+int ufi_drive_step(int direction) {
+    if (g_current_drive == DRIVE_NONE) {
+        return -1;
+    }
+    
+    if (g_current_drive == DRIVE_APPLE_II) {
+        return ufi_drive_apple_step(direction);
+    }
+    
+    // Shugart/Amiga Step
+    step_pulse(direction);
+    
+    // Step Rate
+    delay_us(STEP_RATE_US);
     
     return 0;
 }
 
-// Apple Disk II Stepper (4-Phasen)
-static uint8_t apple_phase = 0;
+/* ============================================================================
+ * APPLE DISK II PHASEN-SEQUENZER
+ * ============================================================================ */
 
-int ufi_drive_apple_step(int direction) {
-    // Apple verwendet 4-Phasen Stepper
-    // Phase-Sequenz: 0-1-2-3-0-1-2-3 (vorwärts)
-    //                0-3-2-1-0-3-2-1 (rückwärts)
+// Kopfposition in Viertel-Tracks (4 Viertel = 1 Track = 2 Phasen)
+#define APPLE_QTRACKS_PER_TRACK 4
+#define APPLE_MAX_QTRACK        (39 * APPLE_QTRACKS_PER_TRACK + 3)
+#define APPLE_RECAL_QTRACKS     (APPLE_MAX_QTRACK + 8)  // Gegen den Anschlag
+
+// Beschleunigungs-Tabelle (µs pro Viertel-Step, angelehnt an DOS 3.3 ONTABLE)
+static const uint16_t apple_step_us[] = {
+    2400, 2000, 1800, 1600, 1500, 1450, 1400
+};
+#define APPLE_STEP_TABLE_LEN    (sizeof(apple_step_us) / sizeof(apple_step_us[0]))
+
+static const uint16_t apple_phase_pins[4] = {
+    APPLE_PH0_PIN, APPLE_PH1_PIN, APPLE_PH2_PIN, APPLE_PH3_PIN
+};
+
+static uint16_t apple_qtrack = 0;
+
+/**
+ * Phasen-Maske für eine Viertel-Track Position
+ * 
+ * Gerade Viertel (Halb-Tracks) = eine Phase, ungerade = zwei benachbarte
+ * Phasen gleichzeitig (Kopf steht zwischen den Magneten).
+ */
+static uint16_t apple_phase_mask(uint16_t qtrack) {
+    uint8_t phase = (qtrack >> 1) & 3;
+    uint16_t mask = apple_phase_pins[phase];
     
-    static const uint16_t phase_pins[4] = {
-        APPLE_PH0_PIN, APPLE_PH1_PIN, APPLE_PH2_PIN, APPLE_PH3_PIN
-    };
+    if (qtrack & 1) {
+        mask |= apple_phase_pins[(phase + 1) & 3];
+    }
+    return mask;
+}
+
+/**
+ * Einen Viertel-Step ausführen
+ * Neue Phase(n) zuerst einschalten, dann alte aus (überlappend).
+ */
+static void apple_qstep(uint16_t from, uint16_t to, uint32_t dwell_us) {
+    uint16_t old_mask = apple_phase_mask(from);
+    uint16_t new_mask = apple_phase_mask(to);
     
-    // Aktuelle Phase aus
-    HAL_GPIO_WritePin(APPLE_PORT, phase_pins[apple_phase], GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(APPLE_PORT, new_mask, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(APPLE_PORT, old_mask & ~new_mask, GPIO_PIN_RESET);
     
-    // Nächste Phase
-    if (direction > 0) {
-        apple_phase = (apple_phase + 1) & 3;
-    } else {
-        apple_phase = (apple_phase - 1) & 3;
+    delay_us(dwell_us);
+}
+
+/**
+ * Kopf auf Viertel-Track fahren
+ * @param qtrack  Ziel (0 .. APPLE_MAX_QTRACK), Track N = N*4
+ */
+int ufi_drive_apple_seek_qtrack(uint16_t qtrack) {
+    if (qtrack > APPLE_MAX_QTRACK) {
+        return -2;
     }
     
-    // Neue Phase an
-    HAL_GPIO_WritePin(APPLE_PORT, phase_pins[apple_phase], GPIO_PIN_SET);
+    uint16_t pos = apple_qtrack;
+    uint32_t n = 0;
     
-    delay_us(5000);  // 5ms Phase-Zeit
+    // Aktuelle Position sicher bestromen (nach Reset / Enable)
+    HAL_GPIO_WritePin(APPLE_PORT, apple_phase_mask(pos), GPIO_PIN_SET);
     
-    // Track-Counter (2 Phasen = 1 Track)
-    static uint8_t phase_count = 0;
-    phase_count++;
-    if (phase_count >= 2) {
-        phase_count = 0;
-        drive_status_t* status = &g_drive_status[DRIVE_APPLE_II];
-        if (direction > 0 && status->current_track < 39) {
-            status->current_track++;
-        } else if (direction < 0 && status->current_track > 0) {
-            status->current_track--;
-        }
+    while (pos != qtrack) {
+        uint16_t next = (qtrack > pos) ? pos + 1 : pos - 1;
+        uint32_t idx = (n < APPLE_STEP_TABLE_LEN) ? n : APPLE_STEP_TABLE_LEN - 1;
+        
+        apple_qstep(pos, next, apple_step_us[idx]);
+        pos = next;
+        n++;
+    }
+    
+    apple_qtrack = pos;
+    g_drive_status[DRIVE_APPLE_II].current_track = pos / APPLE_QTRACKS_PER_TRACK;
+    
+    if (n > 0) {
+        delay_us(SETTLE_TIME_US);
     }
     
     return 0;
 }
 
+uint16_t ufi_drive_apple_get_qtrack(void) {
+    return apple_qtrack;
+}
+
+/**
+ * Rekalibrieren: Apple II hat keinen Track-0 Sensor,
+ * daher über die volle Breite gegen den Anschlag fahren.
+ */
+int ufi_drive_apple_recalibrate(void) {
+    apple_qtrack = APPLE_RECAL_QTRACKS;
+    
+    uint16_t pos = apple_qtrack;
+    while (pos > 0) {
+        apple_qstep(pos, pos - 1, apple_step_us[0]);
+        pos--;
+    }
+    
+    apple_qtrack = 0;
+    g_drive_status[DRIVE_APPLE_II].current_track = 0;
+    g_drive_status[DRIVE_APPLE_II].track0 = true;
+    delay_us(SETTLE_TIME_US);
+    
+    return 0;
+}
+
+// Ganzen Track steppen (Semantik wie Shugart-Step)
+int ufi_drive_apple_step(int direction) {
+    int target = (int)apple_qtrack + direction * APPLE_QTRACKS_PER_TRACK;
+    
+    if (target < 0) {
+        target = 0;
+    } else if (target > APPLE_MAX_QTRACK) {
+        target = APPLE_MAX_QTRACK;
+    }
+    
+    return ufi_drive_apple_seek_qtrack((uint16_t)target);
+}
+
 /* ============================================================================
  * SEEK & RECALIBRATE
  * ============================================================================ */
@@ -356,6 +677,10 @@ int ufi_drive_seek(uint8_t track) {
         return -2;
     }
     
+    if (g_current_drive == DRIVE_APPLE_II) {
+        return ufi_drive_apple_seek_qtrack(track * APPLE_QTRACKS_PER_TRACK);
+    }
+    
     // Steps berechnen
     int steps = (int)track - (int)status->current_track;
     int direction = (steps > 0) ? 1 : -1;
@@ -378,17 +703,98 @@ int ufi_drive_seek(uint8_t track) {
     return 0;
 }
 
+/* ============================================================================
+ * NICHT-BLOCKIERENDER SEEK (für den Scheduler)
+ * ============================================================================ */
+
+typedef enum {
+    SEEK_IDLE,
+    SEEK_STEPPING,
+    SEEK_SETTLING
+} seek_state_t;
+
+static seek_state_t g_seek_state = SEEK_IDLE;
+static uint8_t g_seek_target = 0;
+static uint32_t g_seek_cycles = 0;      // DWT beim letzten Step
+
+/**
+ * Seek starten, Fortschritt mit ufi_drive_seek_poll()
+ * Apple II fährt weiterhin blockierend (Phasen-Sequenzer mit Rampe).
+ */
+int ufi_drive_seek_begin(uint8_t track) {
+    if (g_current_drive == DRIVE_NONE) {
+        return -1;
+    }
+    if (g_current_drive == DRIVE_APPLE_II) {
+        g_seek_state = SEEK_IDLE;
+        return ufi_drive_seek(track);
+    }
+    if (track > 83) {
+        return -2;
+    }
+    
+    g_seek_target = track;
+    g_seek_cycles = DWT->CYCCNT - STEP_RATE_US * (SystemCoreClock / 1000000);
+    g_seek_state = SEEK_STEPPING;
+    
+    return 0;
+}
+
+/**
+ * Einen Seek-Schritt ausführen, wenn die Step-Rate es erlaubt
+ * @return 1 = läuft noch, 0 = Kopf steht (Settle abgelaufen)
+ */
+int ufi_drive_seek_poll(void) {
+    uint32_t elapsed_us = (DWT->CYCCNT - g_seek_cycles) / (SystemCoreClock / 1000000);
+    drive_status_t* status = &g_drive_status[g_current_drive];
+    
+    switch (g_seek_state) {
+        case SEEK_STEPPING: {
+            if (elapsed_us < STEP_RATE_US) {
+                return 1;
+            }
+            
+            // Track 0 Sensor korrigiert den Zähler beim Rausfahren
+            if (g_seek_target < status->current_track && ufi_drive_at_track0()) {
+                status->current_track = 0;
+            }
+            
+            if (g_seek_target == status->current_track) {
+                g_seek_state = SEEK_SETTLING;
+                g_seek_cycles = DWT->CYCCNT;
+                return 1;
+            }
+            
+            step_pulse((g_seek_target < status->current_track) ? -1 : 1);
+            g_seek_cycles = DWT->CYCCNT;
+            return 1;
+        }
+        
+        case SEEK_SETTLING:
+            if (elapsed_us < SETTLE_TIME_US) {
+                return 1;
+            }
+            g_seek_state = SEEK_IDLE;
+            return 0;
+            
+        default:
+            return 0;
+    }
+}
+
 int ufi_drive_recalibrate(void) {
     if (g_current_drive == DRIVE_NONE) {
         return -1;
     }
     
+    if (g_current_drive == DRIVE_APPLE_II) {
+        return ufi_drive_apple_recalibrate();
+    }
+    
     drive_status_t* status = &g_drive_status[g_current_drive];
     
     // Max Steps nach außen
-    int max_steps = (g_current_drive == DRIVE_APPLE_II) ? 50 : 90;
-    
-    for (int i = 0; i < max_steps; i++) {
+    for (int i = 0; i < 90; i++) {
         if (ufi_drive_at_track0()) {
             status->current_track = 0;
             status->track0 = true;
@@ -468,4 +874,206 @@ drive_type_t ufi_drive_get_current(void) {
     return g_current_drive;
 }
 
+/* ============================================================================
+ * SIGNAL-EVENTS (asynchrone Benachrichtigung an CM5)
+ * ============================================================================ */
+
+/**
+ * EXTI für DKCHG, READY und WPROT einrichten (beide Flanken)
+ * INDEX läuft bereits über EXTI0.
+ */
+void ufi_drive_events_init(void) {
+    GPIO_InitTypeDef gpio = {0};
+    
+    gpio.Mode = GPIO_MODE_IT_RISING_FALLING;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    gpio.Pin = FDD_WPROT_PIN | FDD_DKCHG_PIN | FDD_READY_PIN;
+    HAL_GPIO_Init(FDD_PORT_C, &gpio);
+    
+    // Niedrige Priorität - darf Flux/USB nie verzögern
+    HAL_NVIC_SetPriority(EXTI2_IRQn, 6, 0);
+    HAL_NVIC_SetPriority(EXTI4_IRQn, 6, 0);
+    HAL_NVIC_SetPriority(EXTI9_5_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(EXTI2_IRQn);
+    HAL_NVIC_EnableIRQ(EXTI4_IRQn);
+    HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+    
+    g_signals_reported = ufi_drive_read_signals();
+}
+
+/**
+ * Signal-Flanke registrieren (aus EXTI2/4/9_5 IRQHandler)
+ * Nur Flag + Zeitstempel, Auswertung in ufi_drive_poll_events().
+ */
+void ufi_drive_signal_irq(void) {
+    g_signal_tick = HAL_GetTick();
+    g_signal_pending = 1;
+}
+
+/**
+ * Aktuellen Signalzustand als Bitmaske lesen (DRIVE_SIG_*)
+ */
+uint8_t ufi_drive_read_signals(void) {
+    uint8_t sig = 0;
+    
+    if (ufi_drive_disk_changed())    sig |= DRIVE_SIG_DISK_CHANGE;
+    if (ufi_drive_ready())           sig |= DRIVE_SIG_READY;
+    if (ufi_drive_write_protected()) sig |= DRIVE_SIG_WRITE_PROT;
+    
+    if (g_index_count > 0 && (HAL_GetTick() - g_index_last_tick) < INDEX_LOST_MS) {
+        sig |= DRIVE_SIG_INDEX;
+    }
+    
+    return sig;
+}
+
+/* ============================================================================
+ * DREHZAHL-MONITOR (Wow & Flutter)
+ * ============================================================================ */
+
+static inline uint32_t cycles_to_ns(float cycles) {
+    return (uint32_t)(cycles * 1e9f / (float)SystemCoreClock + 0.5f);
+}
+
+/**
+ * Statistik über das Fenster der letzten Index-Perioden
+ * 
+ * Rein aus den Zeitstempeln von EXTI0 - keine zusätzlichen Umdrehungen,
+ * kein Blockieren. Flutter-Spektrum per DFT über das volle Fenster:
+ * Bin k entspricht k/RPM_WINDOW Schwingungen pro Umdrehung (bis Nyquist).
+ */
+void ufi_drive_rpm_monitor(rpm_monitor_t* out) {
+    static float dft_cos[RPM_WINDOW];
+    static float dft_sin[RPM_WINDOW];
+    static bool dft_ready = false;
+    uint32_t periods[RPM_WINDOW];
+    uint32_t n, head;
+    
+    memset(out, 0, sizeof(*out));
+    
+    // Konsistente Kopie (EXTI0 schreibt)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    n = g_rpm_fill;
+    head = g_rpm_head;
+    memcpy(periods, g_rpm_periods, sizeof(periods));
+    bool lost = (HAL_GetTick() - g_index_last_tick) >= INDEX_LOST_MS;
+    __set_PRIMASK(primask);
+    
+    if (n == 0 || lost) {
+        return;
+    }
+    
+    // Älteste zuerst
+    float x[RPM_WINDOW];
+    uint32_t pmin = UINT32_MAX, pmax = 0;
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t p = periods[(head - n + i) & (RPM_WINDOW - 1)];
+        x[i] = (float)p;
+        sum += x[i];
+        if (p < pmin) pmin = p;
+        if (p > pmax) pmax = p;
+    }
+    float mean = sum / n;
+    
+    float var = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        float d = x[i] - mean;
+        var += d * d;
+    }
+    float std = sqrtf(var / n);
+    
+    out->samples = (uint16_t)n;
+    out->period_last_ns = cycles_to_ns(x[n - 1]);
+    out->period_mean_ns = cycles_to_ns(mean);
+    out->period_min_ns = cycles_to_ns((float)pmin);
+    out->period_max_ns = cycles_to_ns((float)pmax);
+    out->period_std_ns = cycles_to_ns(std);
+    out->rpm_x100 = (uint32_t)(6000.0f * (float)SystemCoreClock / mean + 0.5f);
+    out->wow_rms_ppm = (uint32_t)(std / mean * 1e6f + 0.5f);
+    out->wow_pp_ppm = (uint32_t)((pmax - pmin) / mean * 1e6f + 0.5f);
+    
+    if (n < RPM_WINDOW) {
+        return;
+    }
+    
+    if (!dft_ready) {
+        for (uint32_t i = 0; i < RPM_WINDOW; i++) {
+            float w = 2.0f * 3.14159265f * i / RPM_WINDOW;
+            dft_cos[i] = cosf(w);
+            dft_sin[i] = sinf(w);
+        }
+        dft_ready = true;
+    }
+    
+    // Einseitiges Amplitudenspektrum der Abweichung, relativ zum Mittel
+    for (uint32_t k = 1; k <= RPM_FLUTTER_BINS; k++) {
+        float re = 0.0f, im = 0.0f;
+        for (uint32_t i = 0; i < RPM_WINDOW; i++) {
+            uint32_t w = (k * i) & (RPM_WINDOW - 1);
+            float d = x[i] - mean;
+            re += d * dft_cos[w];
+            im -= d * dft_sin[w];
+        }
+        float amp = sqrtf(re * re + im * im) * ((k == RPM_FLUTTER_BINS) ? 1.0f : 2.0f) / RPM_WINDOW;
+        float ppm = amp / mean * 1e6f;
+        out->flutter_ppm[k - 1] = (ppm > 65535.0f) ? 65535 : (uint16_t)(ppm + 0.5f);
+    }
+    out->bins = RPM_FLUTTER_BINS;
+}
+
+/**
+ * Events aktivieren
+ * @param mask  DRIVE_SIG_* Bits, 0 = aus
+ */
+void ufi_drive_set_event_mask(uint8_t mask) {
+    g_event_mask = mask;
+    g_signals_reported = ufi_drive_read_signals();
+}
+
+/**
+ * Signaländerungen auswerten (aus ufi_main_loop)
+ * 
+ * GPIOs werden nur nach einer EXTI-Flanke (entprellt) gelesen; der
+ * Index-Zustand ergibt sich aus dem Zeitstempel der letzten Index-Flanke.
+ */
+void ufi_drive_poll_events(void) {
+    if (g_event_mask == 0) {
+        g_signal_pending = 0;
+        return;
+    }
+    
+    uint32_t now = HAL_GetTick();
+    uint8_t current = g_signals_reported;
+    
+    if (g_signal_pending && (now - g_signal_tick) >= SIGNAL_DEBOUNCE_MS) {
+        g_signal_pending = 0;
+        current = ufi_drive_read_signals();
+    } else {
+        // Nur Index-Zustand neu bewerten (kein GPIO-Zugriff)
+        bool index = g_index_count > 0 && (now - g_index_last_tick) < INDEX_LOST_MS;
+        current = (current & ~DRIVE_SIG_INDEX) | (index ? DRIVE_SIG_INDEX : 0);
+    }
+    
+    uint8_t changed = (current ^ g_signals_reported) & g_event_mask;
+    if (changed == 0) {
+        return;
+    }
+    
+    drive_event_t evt = {
+        .drive = (uint8_t)g_current_drive,
+        .signals = current,
+        .changed = changed,
+        .reserved = 0,
+        .timestamp_ms = now
+    };
+    
+    // Nur als gemeldet markieren, wenn das Event im TX-Puffer ist
+    if (ufi_usb_send_event(UFI_EVT_DRIVE_SIGNALS, &evt, sizeof(evt)) == UFI_OK) {
+        g_signals_reported = current;
+    }
+}
+
 /* Index Interrupt wurde nach stm32h7xx_it.c verschoben */
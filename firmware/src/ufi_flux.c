@@ -73,14 +73,10 @@ void ufi_flux_init(void) {
     hdma_tim2.Init.MemBurst = DMA_MBURST_INC4;
     hdma_tim2.Init.PeriphBurst = DMA_PBURST_SINGLE;
     HAL_DMA_Init(&hdma_tim2);
-    
-    // DMA Double-Buffer Mode aktivieren
-    HAL_DMAEx_MultiBufferStart_IT(&hdma_tim2,
-        (uint32_t)&TIM2->CCR1,
-        (uint32_t)dma_buffer_a,
-        (uint32_t)dma_buffer_b,
-        DMA_BUFFER_SIZE);
-    
+
+    // DMA erst beim Capture starten (capture_arm): ein hier gestarteter
+    // Stream bleibt BUSY und HAL_TIM_IC_Start_DMA schlägt dann fehl
+
     // Link DMA to Timer
     __HAL_LINKDMA(&htim2, hdma[TIM_DMA_ID_CC1], hdma_tim2);
     
@@ -193,6 +189,8 @@ void ufi_flux_index_pulse(uint32_t timestamp) {
 
 void HAL_DMA_XferCpltCallback(DMA_HandleTypeDef *hdma) {
     if (hdma == &hdma_tim2) {
+        UFI_TELEM_INC(dma_complete);
+        
         // Buffer voll - zur anderen Hälfte wechseln
         active_buffer = 1 - active_buffer;
         total_samples += DMA_BUFFER_SIZE;
@@ -200,6 +198,7 @@ void HAL_DMA_XferCpltCallback(DMA_HandleTypeDef *hdma) {
         // Überlauf-Prüfung
         if (total_samples > MAX_FLUX_PER_REV * 2) {
             g_capture.error_code = 1;  // Überlauf
+            UFI_TELEM_INC(flux_overruns);
             g_capture.state = CAPTURE_ERROR;
             ufi_flux_capture_stop();
         }
@@ -209,12 +208,14 @@ void HAL_DMA_XferCpltCallback(DMA_HandleTypeDef *hdma) {
 void HAL_DMA_XferHalfCpltCallback(DMA_HandleTypeDef *hdma) {
     if (hdma == &hdma_tim2) {
         // Half-Transfer - kann für Streaming genutzt werden
+        UFI_TELEM_INC(dma_half);
     }
 }
 
 void HAL_DMA_ErrorCallback(DMA_HandleTypeDef *hdma) {
     if (hdma == &hdma_tim2) {
         g_capture.error_code = 2;  // DMA-Fehler
+        UFI_TELEM_INC(dma_errors);
         g_capture.state = CAPTURE_ERROR;
         ufi_flux_capture_stop();
     }
@@ -2,21 +2,15 @@
  * UFI Flux Engine - IEC Bus Module
  * 
  * Commodore IEC Serial Bus Protokoll für 1541/1571/1581 Laufwerke
+ * 
+ * Senden (inkl. ATN) und Empfangen laufen als State-Machines im TIM7-Tick,
+ * die Handshakes werden abgetastet statt in Warteschleifen abgewartet.
  */
 
 #include "ufi_firmware.h"
 #include "stm32h7xx_hal.h"
-
-/* ============================================================================
- * GPIO DEFINITIONEN (Port D)
- * ============================================================================ */
-
-#define IEC_ATN_PIN         GPIO_PIN_0
-#define IEC_CLK_PIN         GPIO_PIN_1
-#define IEC_DATA_PIN        GPIO_PIN_2
-#define IEC_SRQ_PIN         GPIO_PIN_3
-#define IEC_RESET_PIN       GPIO_PIN_4
-#define IEC_PORT            GPIOD
+#include <stdio.h>
+#include <string.h>
 
 /* ============================================================================
  * IEC TIMING KONSTANTEN (in µs)
@@ -32,53 +26,44 @@
 #define IEC_T_EI    200     // EOI Response
 #define IEC_T_RY    60      // Talker Response Limit
 #define IEC_T_PR    30      // Byte-Acknowledge
+#define IEC_T_ATN   100     // ATN Setup / Release bis zum nächsten Schritt
 
 /* ============================================================================
- * DELAY FUNKTION
- * ============================================================================ */
-
-static inline void iec_delay_us(uint32_t us) {
-    uint32_t start = DWT->CYCCNT;
-    uint32_t cycles = us * (SystemCoreClock / 1000000);
-    while ((DWT->CYCCNT - start) < cycles);
-}
-
-/* ============================================================================
- * GPIO FUNKTIONEN (Open-Drain Emulation)
+ * GPIO FUNKTIONEN (Open-Drain Emulation, BSRR/IDR)
  * ============================================================================ */
 
 static inline void iec_release_clk(void) {
     // High-Z = Release (Pull-up zieht hoch)
-    HAL_GPIO_WritePin(IEC_PORT, IEC_CLK_PIN, GPIO_PIN_SET);
+    iec_lines_set(IEC_CLK_PIN, 0);
 }
 
 static inline void iec_pull_clk(void) {
     // Low = Pull down
-    HAL_GPIO_WritePin(IEC_PORT, IEC_CLK_PIN, GPIO_PIN_RESET);
+    iec_lines_set(0, IEC_CLK_PIN);
 }
 
 static inline void iec_release_data(void) {
-    HAL_GPIO_WritePin(IEC_PORT, IEC_DATA_PIN, GPIO_PIN_SET);
+    iec_lines_set(IEC_DATA_PIN, 0);
 }
 
 static inline void iec_pull_data(void) {
-    HAL_GPIO_WritePin(IEC_PORT, IEC_DATA_PIN, GPIO_PIN_RESET);
+    iec_lines_set(0, IEC_DATA_PIN);
 }
 
 static inline void iec_release_atn(void) {
-    HAL_GPIO_WritePin(IEC_PORT, IEC_ATN_PIN, GPIO_PIN_SET);
+    iec_lines_set(IEC_ATN_PIN, 0);
 }
 
 static inline void iec_pull_atn(void) {
-    HAL_GPIO_WritePin(IEC_PORT, IEC_ATN_PIN, GPIO_PIN_RESET);
+    iec_lines_set(0, IEC_ATN_PIN);
 }
 
 static inline bool iec_read_clk(void) {
-    return HAL_GPIO_ReadPin(IEC_PORT, IEC_CLK_PIN) == GPIO_PIN_RESET;
+    return (iec_lines_asserted() & IEC_CLK_PIN) != 0;
 }
 
 static inline bool iec_read_data(void) {
-    return HAL_GPIO_ReadPin(IEC_PORT, IEC_DATA_PIN) == GPIO_PIN_RESET;
+    return (iec_lines_asserted() & IEC_DATA_PIN) != 0;
 }
 
 /* ============================================================================
@@ -116,191 +101,536 @@ void ufi_iec_init(void) {
 
 int ufi_iec_reset(void) {
     // Reset-Leitung Low für 20ms
-    HAL_GPIO_WritePin(IEC_PORT, IEC_RESET_PIN, GPIO_PIN_RESET);
+    iec_lines_set(0, IEC_RESET_PIN);
     HAL_Delay(20);
-    HAL_GPIO_WritePin(IEC_PORT, IEC_RESET_PIN, GPIO_PIN_SET);
+    iec_lines_set(IEC_RESET_PIN, 0);
     
     // Warten bis 1541 bereit (~500ms Boot-Zeit)
     HAL_Delay(500);
     
     // Bus releasen
-    iec_release_clk();
-    iec_release_data();
-    iec_release_atn();
+    iec_lines_set(IEC_ATN_PIN | IEC_CLK_PIN | IEC_DATA_PIN, 0);
     
     return 0;
 }
 
 /* ============================================================================
- * ATN STEUERUNG
+ * TIM7 TICK (gemeinsam für Senden und Empfangen)
  * ============================================================================ */
 
-int ufi_iec_atn(bool active) {
-    if (active) {
-        iec_pull_atn();
-    } else {
-        iec_release_atn();
+#define RX_TICKS(us)        (((us) + IEC_RX_TICK_US - 1) / IEC_RX_TICK_US)
+
+typedef enum {
+    RX_WAIT_TALKER,     // DATA gezogen, warten bis Talker CLK freigibt
+    RX_WAIT_START,      // DATA frei, warten auf erstes Bit (oder EOI)
+    RX_EOI_ACK,         // EOI bestätigen: DATA 60µs ziehen
+    RX_BIT_LOW,         // CLK gezogen: Talker legt Bit an
+    RX_BIT_HIGH,        // Bit abgetastet, warten auf nächstes CLK Low
+    RX_FRAME            // 8 Bits da, warten auf Frame-Ende (CLK Low)
+} iec_rx_state_t;
+
+typedef struct {
+    volatile iec_rx_status_t status;
+    iec_rx_state_t state;
+    uint8_t* buffer;
+    uint32_t max_len;
+    volatile uint32_t len;
+    uint8_t byte;
+    uint8_t bit;
+    bool eoi;
+    uint16_t ticks;         // Ticks im aktuellen Zustand
+    int error;
+} iec_rx_t;
+
+typedef enum {
+    TX_ATN_SETUP,       // ATN + CLK gezogen, Geräte hören zu
+    TX_WAIT_LISTENER,   // CLK gezogen, warten bis Listener DATA zieht
+    TX_WAIT_READY,      // CLK frei (Ready to Send), warten auf DATA frei
+    TX_EOI_ACK,         // EOI: Talker wartet, Listener zieht DATA ...
+    TX_EOI_RELEASE,     // ... und gibt es wieder frei
+    TX_BIT_SETUP,       // CLK gezogen, Bit liegt an (T_S)
+    TX_BIT_VALID,       // CLK frei, Bit gültig (T_V)
+    TX_FRAME,           // CLK gezogen, DATA frei, warten auf Acknowledge
+    TX_BETWEEN,         // Pause zwischen zwei Bytes (T_BB)
+    TX_RELEASE          // ATN freigegeben / Turnaround, Bus beruhigen
+} iec_tx_state_t;
+
+typedef struct {
+    volatile iec_rx_status_t status;
+    iec_tx_state_t state;
+    const uint8_t* data;
+    uint32_t len;
+    volatile uint32_t pos;  // Bestätigte Bytes
+    uint8_t flags;          // IEC_TX_*
+    uint8_t bit;
+    uint16_t ticks;
+    int error;
+} iec_tx_t;
+
+static iec_rx_t iec_rx;
+static iec_tx_t iec_tx;
+static bool iec_timer_ready = false;
+
+static void iec_timer_init(void) {
+    __HAL_RCC_TIM7_CLK_ENABLE();
+    
+    // 1 MHz Zähltakt (APB1 Timer-Takt wie TIM2), Update alle IEC_RX_TICK_US
+    TIM7->PSC = (FLUX_TIMER_FREQ / 1000000) - 1;
+    TIM7->ARR = IEC_RX_TICK_US - 1;
+    TIM7->EGR = TIM_EGR_UG;
+    TIM7->SR = 0;
+    TIM7->DIER = TIM_DIER_UIE;
+    
+    // Unter Flux (0) und Index (1), über USB (3)
+    HAL_NVIC_SetPriority(TIM7_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(TIM7_IRQn);
+    
+    iec_timer_ready = true;
+}
+
+static void iec_timer_start(void) {
+    if (!(TIM7->CR1 & TIM_CR1_CEN)) {
+        TIM7->CNT = 0;
+        TIM7->CR1 |= TIM_CR1_CEN;
+    }
+}
+
+// Tick nur anhalten wenn weder Senden noch Empfang laufen
+static void iec_timer_stop(void) {
+    if (iec_rx.status != IEC_RX_BUSY && iec_tx.status != IEC_RX_BUSY) {
+        TIM7->CR1 &= ~TIM_CR1_CEN;
     }
-    iec_delay_us(100);
-    return 0;
 }
 
 /* ============================================================================
- * BYTE SENDEN (als Controller)
+ * ASYNCHRONES SENDEN (als Controller/Talker, inkl. ATN)
  * ============================================================================ */
 
-int ufi_iec_send_byte(uint8_t byte, bool eoi) {
-    uint32_t timeout;
+static void iec_tx_finish(iec_rx_status_t status, int error) {
+    if (status == IEC_RX_ERROR) {
+        // Bus nicht mit gezogenem ATN/CLK hängen lassen
+        iec_lines_set(IEC_ATN_PIN | IEC_CLK_PIN, 0);
+    }
+    iec_tx.error = error;
+    iec_tx.status = status;
+    iec_timer_stop();
+}
+
+static inline void iec_tx_enter(iec_tx_state_t state) {
+    iec_tx.state = state;
+    iec_tx.ticks = 0;
+}
+
+// Bit anlegen: CLK Low + Datenbit in einem Zugriff (Bit = 1 -> DATA High)
+static void iec_tx_bit(void) {
+    if (iec_tx.data[iec_tx.pos] & (1 << iec_tx.bit)) {
+        iec_lines_set(IEC_DATA_PIN, IEC_CLK_PIN);
+    } else {
+        iec_lines_set(0, IEC_CLK_PIN | IEC_DATA_PIN);
+    }
+    iec_tx_enter(TX_BIT_SETUP);
+}
+
+// Nächstes Byte beginnen oder Job abschließen (ATN freigeben / Turnaround)
+static void iec_tx_next(void) {
+    if (iec_tx.pos < iec_tx.len) {
+        // Talker: CLK ziehen, DATA freigeben
+        iec_lines_set(IEC_DATA_PIN, IEC_CLK_PIN);
+        iec_tx.bit = 0;
+        iec_tx_enter(TX_WAIT_LISTENER);
+    } else if (iec_tx.flags & IEC_TX_TURNAROUND) {
+        // Turnaround: DATA ziehen (Listener), CLK + ATN freigeben
+        iec_lines_set(IEC_ATN_PIN | IEC_CLK_PIN, IEC_DATA_PIN);
+        iec_tx_enter(TX_RELEASE);
+    } else if (iec_tx.flags & IEC_TX_RELEASE_ATN) {
+        iec_release_atn();
+        iec_tx_enter(TX_RELEASE);
+    } else {
+        iec_tx_finish(IEC_RX_DONE, UFI_OK);
+    }
+}
+
+/**
+ * Sendejob starten
+ * Der Fortschritt läuft im TIM7-Interrupt, Abfrage mit ufi_iec_tx_poll().
+ *
+ * @param data   Bytes (müssen bis zum Ende des Jobs gültig bleiben)
+ * @param len    Anzahl Bytes, 0 = nur ATN setzen/freigeben
+ * @param flags  IEC_TX_ATN, IEC_TX_EOI, IEC_TX_RELEASE_ATN, IEC_TX_TURNAROUND
+ */
+int ufi_iec_tx_start(const uint8_t* data, uint32_t len, uint8_t flags) {
+    if (iec_tx.status == IEC_RX_BUSY || iec_rx.status == IEC_RX_BUSY) {
+        return UFI_ERR_BUSY;
+    }
+    if (!iec_timer_ready) {
+        iec_timer_init();
+    }
     
-    // 1. CLK Low setzen (wir sind Talker)
-    iec_pull_clk();
-    iec_release_data();
+    iec_tx.data = data;
+    iec_tx.len = len;
+    iec_tx.pos = 0;
+    iec_tx.flags = flags;
+    iec_tx.error = UFI_OK;
+    iec_tx.status = IEC_RX_BUSY;
     
-    // 2. Warten bis Listener bereit (DATA Low)
-    timeout = 1000;
-    while (!iec_read_data() && timeout--) {
-        iec_delay_us(10);
-    }
-    if (timeout == 0) {
-        return -1;  // Kein Listener
-    }
-    
-    // 3. EOI Handshake falls nötig
-    if (eoi) {
-        // EOI: CLK high lassen für >200µs
-        iec_release_clk();
-        iec_delay_us(IEC_T_EI);
-        
-        // Listener bestätigt EOI durch DATA High-Low-High
-        timeout = 100;
-        while (iec_read_data() && timeout--) {
-            iec_delay_us(10);
-        }
-        timeout = 100;
-        while (!iec_read_data() && timeout--) {
-            iec_delay_us(10);
-        }
-    }
-    
-    // 4. CLK Release = "Ready to Send"
-    iec_release_clk();
-    iec_delay_us(IEC_T_NE);
-    
-    // 5. 8 Bits senden (LSB first)
-    for (int i = 0; i < 8; i++) {
-        // CLK Low
-        iec_pull_clk();
-        
-        // Datenbit setzen (invertiert!)
-        if (byte & (1 << i)) {
-            iec_release_data();  // Bit = 1 -> DATA High
-        } else {
-            iec_pull_data();     // Bit = 0 -> DATA Low
-        }
-        
-        iec_delay_us(IEC_T_S);
-        
-        // CLK High = Bit gültig
-        iec_release_clk();
-        iec_delay_us(IEC_T_V);
-    }
-    
-    // 6. CLK Low, DATA Release
-    iec_pull_clk();
-    iec_release_data();
-    iec_delay_us(IEC_T_F);
+    if (flags & IEC_TX_ATN) {
+        // ATN + CLK ziehen, DATA freigeben: alle Geräte hören zu
+        iec_lines_set(IEC_DATA_PIN, IEC_ATN_PIN | IEC_CLK_PIN);
+        iec_tx_enter(TX_ATN_SETUP);
+    } else {
+        iec_tx_next();
+    }
     
-    // 7. Auf Acknowledge warten (DATA Low vom Listener)
-    timeout = 1000;
-    while (!iec_read_data() && timeout--) {
-        iec_delay_us(10);
+    if (iec_tx.status == IEC_RX_BUSY) {
+        iec_timer_start();
     }
     
-    iec_delay_us(IEC_T_BB);
+    return UFI_OK;
+}
+
+/**
+ * Sendestatus abfragen
+ * @param len    Vom Listener bestätigte Bytes
+ * @param error  Fehlercode bei IEC_RX_ERROR
+ */
+iec_rx_status_t ufi_iec_tx_poll(uint32_t* len, int* error) {
+    iec_rx_status_t status = iec_tx.status;
+    *len = iec_tx.pos;
+    *error = iec_tx.error;
+    return status;
+}
+
+static void iec_tx_tick(void) {
+    bool data_low = iec_read_data();
     
-    return 0;
+    iec_tx.ticks++;
+    
+    switch (iec_tx.state) {
+        case TX_ATN_SETUP:
+            if (iec_tx.ticks >= RX_TICKS(IEC_T_ATN)) {
+                iec_tx_next();
+            }
+            break;
+            
+        case TX_WAIT_LISTENER:
+            if (data_low) {
+                // Listener da: Ready to Send
+                iec_release_clk();
+                iec_tx_enter(TX_WAIT_READY);
+            } else if (iec_tx.ticks > ((iec_tx.flags & IEC_TX_ATN) ? RX_TICKS(IEC_T_AT)
+                                                                    : RX_TICKS(IEC_TIMEOUT_US))) {
+                // Unter ATN muss jedes Gerät in T_AT antworten, sonst keins da
+                iec_tx_finish(IEC_RX_ERROR, UFI_ERR_IEC_NRFD);
+            }
+            break;
+            
+        case TX_WAIT_READY:
+            if (!data_low) {
+                // Ready for Data; beim letzten Byte mit EOI > 200µs warten
+                bool eoi = (iec_tx.flags & IEC_TX_EOI) && iec_tx.pos == iec_tx.len - 1;
+                if (eoi) {
+                    iec_tx_enter(TX_EOI_ACK);
+                } else {
+                    iec_tx_bit();
+                }
+            } else if (iec_tx.ticks > RX_TICKS(IEC_TIMEOUT_US)) {
+                iec_tx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case TX_EOI_ACK:
+            if (data_low) {
+                iec_tx_enter(TX_EOI_RELEASE);
+            } else if (iec_tx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_tx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case TX_EOI_RELEASE:
+            if (!data_low) {
+                iec_tx_bit();
+            } else if (iec_tx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_tx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case TX_BIT_SETUP:
+            if (iec_tx.ticks >= RX_TICKS(IEC_T_S)) {
+                // CLK High = Bit gültig
+                iec_release_clk();
+                iec_tx_enter(TX_BIT_VALID);
+            }
+            break;
+            
+        case TX_BIT_VALID:
+            if (iec_tx.ticks >= RX_TICKS(IEC_T_V)) {
+                if (++iec_tx.bit < 8) {
+                    iec_tx_bit();
+                } else {
+                    // CLK Low, DATA Release (gleichzeitig)
+                    iec_lines_set(IEC_DATA_PIN, IEC_CLK_PIN);
+                    iec_tx_enter(TX_FRAME);
+                }
+            }
+            break;
+            
+        case TX_FRAME:
+            if (data_low && iec_tx.ticks >= RX_TICKS(IEC_T_F)) {
+                // Byte-Acknowledge vom Listener
+                iec_tx.pos = iec_tx.pos + 1;
+                iec_tx_enter(TX_BETWEEN);
+            } else if (iec_tx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_tx_finish(IEC_RX_ERROR, UFI_ERR_IEC_NOACK);
+            }
+            break;
+            
+        case TX_BETWEEN:
+            if (iec_tx.ticks >= RX_TICKS(IEC_T_BB)) {
+                iec_tx_next();
+            }
+            break;
+            
+        case TX_RELEASE:
+            if (iec_tx.ticks >= RX_TICKS(IEC_T_ATN)) {
+                iec_tx_finish(IEC_RX_DONE, UFI_OK);
+            }
+            break;
+    }
+}
+
+/**
+ * Auf das Ende des Sendejobs warten (schläft bis zum nächsten Interrupt)
+ * @param ret  Rückgabe von ufi_iec_tx_start()
+ */
+static int iec_tx_wait(int ret) {
+    iec_rx_status_t status;
+    uint32_t sent;
+    int error;
+    
+    if (ret != UFI_OK) {
+        return ret;
+    }
+    while ((status = ufi_iec_tx_poll(&sent, &error)) == IEC_RX_BUSY) {
+        __WFI();
+    }
+    return (status == IEC_RX_DONE) ? UFI_OK : error;
+}
+
+static int iec_tx_run(const uint8_t* data, uint32_t len, uint8_t flags) {
+    return iec_tx_wait(ufi_iec_tx_start(data, len, flags));
 }
 
 /* ============================================================================
- * BYTE EMPFANGEN (als Controller/Listener)
+ * ASYNCHRONER EMPFANG (TIM7 Tick, kein Spinnen auf Handshakes)
  * ============================================================================ */
 
-int ufi_iec_receive_byte(uint8_t* byte, bool* eoi) {
-    uint32_t timeout;
-    *byte = 0;
-    *eoi = false;
+static void iec_rx_finish(iec_rx_status_t status, int error) {
+    iec_rx.error = error;
+    iec_rx.status = status;
+    iec_timer_stop();
+}
+
+static inline void iec_rx_enter(iec_rx_state_t state) {
+    iec_rx.state = state;
+    iec_rx.ticks = 0;
+}
+
+/**
+ * Empfang bis EOI starten (nach TALK + Turnaround)
+ * Der Fortschritt läuft im TIM7-Interrupt, Abfrage mit ufi_iec_rx_poll().
+ */
+int ufi_iec_rx_start(uint8_t* buffer, uint32_t max_len) {
+    if (iec_rx.status == IEC_RX_BUSY || iec_tx.status == IEC_RX_BUSY) {
+        return UFI_ERR_BUSY;
+    }
+    if (!iec_timer_ready) {
+        iec_timer_init();
+    }
     
-    // 1. DATA Release = "Ready to Receive"
-    iec_release_data();
+    iec_rx.buffer = buffer;
+    iec_rx.max_len = max_len;
+    iec_rx.len = 0;
+    iec_rx.eoi = false;
+    iec_rx.error = UFI_OK;
+    iec_rx_enter(RX_WAIT_TALKER);
     
-    // 2. Warten auf CLK Release vom Talker
-    timeout = 1000;
-    while (iec_read_clk() && timeout--) {
-        iec_delay_us(10);
-    }
-    if (timeout == 0) {
-        return -1;  // Timeout
-    }
-    
-    // 3. EOI Check: Wenn CLK länger als 200µs High bleibt
-    iec_delay_us(IEC_T_EI);
-    if (!iec_read_clk()) {
-        *eoi = true;
-        // EOI Acknowledge: DATA Low-High
-        iec_pull_data();
-        iec_delay_us(60);
-        iec_release_data();
-    }
-    
-    // 4. 8 Bits empfangen (LSB first)
-    for (int i = 0; i < 8; i++) {
-        // Warten auf CLK Low (Bit-Start)
-        timeout = 200;
-        while (!iec_read_clk() && timeout--) {
-            iec_delay_us(5);
-        }
-        
-        // Warten auf CLK High (Bit gültig)
-        timeout = 200;
-        while (iec_read_clk() && timeout--) {
-            iec_delay_us(5);
-        }
-        
-        // Bit lesen (invertiert!)
-        if (!iec_read_data()) {
-            *byte |= (1 << i);
-        }
-    }
-    
-    // 5. Acknowledge senden (DATA Low)
+    // Listener busy bis der Talker bereit ist
     iec_pull_data();
-    iec_delay_us(IEC_T_PR);
     
-    return 0;
+    iec_rx.status = IEC_RX_BUSY;
+    iec_timer_start();
+    
+    return UFI_OK;
+}
+
+/**
+ * Empfangsstatus abfragen
+ * @param len    Bisher empfangene Bytes
+ * @param error  Fehlercode bei IEC_RX_ERROR
+ */
+iec_rx_status_t ufi_iec_rx_poll(uint32_t* len, int* error) {
+    iec_rx_status_t status = iec_rx.status;
+    *len = iec_rx.len;
+    *error = iec_rx.error;
+    return status;
+}
+
+void ufi_iec_rx_abort(void) {
+    if (iec_rx.status == IEC_RX_BUSY) {
+        iec_rx_finish(IEC_RX_IDLE, UFI_OK);
+    }
+    iec_release_data();
+}
+
+static void iec_rx_tick(void) {
+    uint16_t lines = iec_lines_asserted();
+    bool clk_low = (lines & IEC_CLK_PIN) != 0;
+    
+    iec_rx.ticks++;
+    
+    switch (iec_rx.state) {
+        case RX_WAIT_TALKER:
+            if (!clk_low) {
+                // Ready for Data
+                iec_release_data();
+                iec_rx.byte = 0;
+                iec_rx.bit = 0;
+                iec_rx_enter(RX_WAIT_START);
+            } else if (iec_rx.ticks > RX_TICKS(IEC_TIMEOUT_US)) {
+                iec_rx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case RX_WAIT_START:
+            if (clk_low) {
+                iec_rx_enter(RX_BIT_LOW);
+            } else if (!iec_rx.eoi && iec_rx.ticks > RX_TICKS(IEC_T_EI)) {
+                // Talker wartet > 200µs: letztes Byte
+                iec_rx.eoi = true;
+                iec_pull_data();
+                iec_rx_enter(RX_EOI_ACK);
+            } else if (iec_rx.ticks > RX_TICKS(IEC_TIMEOUT_US)) {
+                iec_rx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case RX_EOI_ACK:
+            if (iec_rx.ticks >= RX_TICKS(60)) {
+                iec_release_data();
+                iec_rx_enter(RX_WAIT_START);
+            }
+            break;
+            
+        case RX_BIT_LOW:
+            if (!clk_low) {
+                // CLK High = Bit gültig (DATA High = 1)
+                if (!(lines & IEC_DATA_PIN)) {
+                    iec_rx.byte |= (1 << iec_rx.bit);
+                }
+                iec_rx.bit++;
+                iec_rx_enter(iec_rx.bit < 8 ? RX_BIT_HIGH : RX_FRAME);
+            } else if (iec_rx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_rx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case RX_BIT_HIGH:
+            if (clk_low) {
+                iec_rx_enter(RX_BIT_LOW);
+            } else if (iec_rx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_rx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+            
+        case RX_FRAME:
+            if (clk_low) {
+                // Byte-Acknowledge
+                iec_pull_data();
+                iec_rx.buffer[iec_rx.len] = iec_rx.byte;
+                iec_rx.len = iec_rx.len + 1;
+                
+                if (iec_rx.eoi) {
+                    iec_rx_finish(IEC_RX_DONE, UFI_OK);
+                } else if (iec_rx.len >= iec_rx.max_len) {
+                    iec_rx_finish(IEC_RX_ERROR, UFI_ERR_BUFFER_FULL);
+                } else {
+                    iec_rx_enter(RX_WAIT_TALKER);
+                }
+            } else if (iec_rx.ticks > RX_TICKS(IEC_T_AT)) {
+                iec_rx_finish(IEC_RX_ERROR, UFI_ERR_TIMEOUT);
+            }
+            break;
+    }
+}
+
+/**
+ * Ein Abtastschritt (aus TIM7_IRQHandler, alle IEC_RX_TICK_US)
+ */
+void ufi_iec_tick(void) {
+    if (iec_tx.status == IEC_RX_BUSY) {
+        iec_tx_tick();
+    }
+    if (iec_rx.status == IEC_RX_BUSY) {
+        iec_rx_tick();
+    }
 }
 
 /* ============================================================================
- * LISTEN/TALK BEFEHLE
+ * ATN / EINZELBYTES (blockierend über die State-Machines)
  * ============================================================================ */
 
-int ufi_iec_listen(uint8_t device) {
-    ufi_iec_atn(true);
-    iec_delay_us(100);
-    
-    // LISTEN Befehl: 0x20 + Device
-    int ret = ufi_iec_send_byte(0x20 | (device & 0x1F), false);
+int ufi_iec_atn(bool active) {
+    return iec_tx_run(NULL, 0, active ? IEC_TX_ATN : IEC_TX_RELEASE_ATN);
+}
+
+/**
+ * Byte an aktuellen Listener senden (als Controller)
+ * @return UFI_OK, UFI_ERR_IEC_NRFD (kein Listener), UFI_ERR_IEC_NOACK, UFI_ERR_TIMEOUT
+ */
+int ufi_iec_send_byte(uint8_t byte, bool eoi) {
+    return iec_tx_run(&byte, 1, eoi ? IEC_TX_EOI : 0);
+}
+
+/**
+ * Ein Byte vom aktuellen Talker empfangen (als Controller/Listener)
+ */
+int ufi_iec_receive_byte(uint8_t* byte, bool* eoi) {
+    uint32_t len;
     
+    // Puffer für genau ein Byte: ohne EOI endet der Empfang mit "voll"
+    int ret = ufi_iec_receive_buffer(byte, 1, &len);
+    *eoi = (ret == UFI_OK);
+    if (ret == UFI_ERR_BUFFER_FULL && len == 1) {
+        ret = UFI_OK;
+    }
     return ret;
 }
 
+/* ============================================================================
+ * LISTEN/TALK BEFEHLE
+ * ============================================================================ */
+
+// Befehlsbytes unter ATN (bis Job-Ende gültig)
+static uint8_t iec_atn_cmd[3];
+
+static int iec_atn_begin(const uint8_t* cmd, uint8_t len, uint8_t flags) {
+    if (iec_tx.status == IEC_RX_BUSY || iec_rx.status == IEC_RX_BUSY) {
+        return UFI_ERR_BUSY;
+    }
+    memcpy(iec_atn_cmd, cmd, len);
+    return ufi_iec_tx_start(iec_atn_cmd, len, IEC_TX_ATN | flags);
+}
+
+int ufi_iec_listen(uint8_t device) {
+    // LISTEN Befehl: 0x20 + Device (ATN bleibt aktiv)
+    uint8_t cmd = 0x20 | (device & 0x1F);
+    return iec_tx_wait(iec_atn_begin(&cmd, 1, 0));
+}
+
 int ufi_iec_talk(uint8_t device) {
-    ufi_iec_atn(true);
-    iec_delay_us(100);
-    
-    // TALK Befehl: 0x40 + Device
-    int ret = ufi_iec_send_byte(0x40 | (device & 0x1F), false);
-    
-    return ret;
+    // TALK Befehl: 0x40 + Device (ATN bleibt aktiv)
+    uint8_t cmd = 0x40 | (device & 0x1F);
+    return iec_tx_wait(iec_atn_begin(&cmd, 1, 0));
 }
 
 int ufi_iec_secondary(uint8_t channel) {
@@ -308,89 +638,134 @@ int ufi_iec_secondary(uint8_t channel) {
     return ufi_iec_send_byte(0x60 | (channel & 0x0F), false);
 }
 
+int ufi_iec_open(uint8_t channel) {
+    // OPEN: 0xF0 + Channel (Dateiname folgt ohne ATN)
+    return ufi_iec_send_byte(0xF0 | (channel & 0x0F), false);
+}
+
+int ufi_iec_close(uint8_t channel) {
+    // CLOSE: 0xE0 + Channel
+    return ufi_iec_send_byte(0xE0 | (channel & 0x0F), false);
+}
+
+int ufi_iec_unlisten_begin(void) {
+    uint8_t cmd = 0x3F;
+    return iec_atn_begin(&cmd, 1, IEC_TX_RELEASE_ATN);
+}
+
+int ufi_iec_untalk_begin(void) {
+    uint8_t cmd = 0x5F;
+    return iec_atn_begin(&cmd, 1, IEC_TX_RELEASE_ATN);
+}
+
 int ufi_iec_unlisten(void) {
-    ufi_iec_atn(true);
-    int ret = ufi_iec_send_byte(0x3F, false);
-    ufi_iec_atn(false);
-    return ret;
+    return iec_tx_wait(ufi_iec_unlisten_begin());
 }
 
 int ufi_iec_untalk(void) {
-    ufi_iec_atn(true);
-    int ret = ufi_iec_send_byte(0x5F, false);
-    ufi_iec_atn(false);
-    return ret;
+    return iec_tx_wait(ufi_iec_untalk_begin());
 }
 
 /* ============================================================================
  * HIGH-LEVEL FUNKTIONEN
  * ============================================================================ */
 
-// Befehl an Laufwerk senden (z.B. "I0" für Initialize)
-int ufi_iec_command(uint8_t device, const char* cmd, uint8_t len) {
-    int ret;
-    
-    // LISTEN Device, Secondary 15 (Command Channel)
-    ret = ufi_iec_listen(device);
-    if (ret != 0) return ret;
+#define IEC_CMD_MAX     40      // 1541 Befehlspuffer (M-W mit 32 Bytes + Kopf)
+
+// Befehl für den Befehlskanal (bis Job-Ende gültig)
+static uint8_t iec_cmd[IEC_CMD_MAX];
+static uint8_t iec_cmd_len = 0;
+static uint8_t iec_cmd_step = 0;
+
+/**
+ * Befehl an Laufwerk starten (z.B. "I0" für Initialize)
+ * LISTEN + Kanal 15, Befehl mit EOI, UNLISTEN als Folge von Sendejobs,
+ * Fortschritt mit ufi_iec_command_poll().
+ */
+int ufi_iec_command_begin(uint8_t device, const char* cmd, uint8_t len) {
+    if (len == 0 || len > IEC_CMD_MAX) {
+        return UFI_ERR_INVALID_PARAM;
+    }
+    if (iec_tx.status == IEC_RX_BUSY || iec_rx.status == IEC_RX_BUSY) {
+        return UFI_ERR_BUSY;
+    }
     
-    ret = ufi_iec_secondary(15);
-    if (ret != 0) return ret;
+    memcpy(iec_cmd, cmd, len);
+    iec_cmd_len = len;
+    iec_cmd_step = 0;
     
-    ufi_iec_atn(false);
+    // LISTEN Device, Secondary 15 (Command Channel)
+    return ufi_iec_listen_sa_begin(device, 15);
+}
+
+/**
+ * Befehls-Fortschritt prüfen
+ * @return 1 = läuft, sonst UFI_OK / Fehlercode
+ */
+int ufi_iec_command_poll(void) {
+    uint32_t sent;
+    int error;
     
-    // Befehl senden
-    for (uint8_t i = 0; i < len; i++) {
-        bool eoi = (i == len - 1);
-        ret = ufi_iec_send_byte(cmd[i], eoi);
-        if (ret != 0) return ret;
+    iec_rx_status_t status = ufi_iec_tx_poll(&sent, &error);
+    if (status == IEC_RX_BUSY) {
+        return 1;
+    }
+    if (status != IEC_RX_DONE) {
+        return error;
     }
     
-    // UNLISTEN
-    ret = ufi_iec_unlisten();
+    int ret;
+    switch (iec_cmd_step++) {
+        case 0:
+            // Befehl senden, EOI mit dem letzten Byte
+            ret = ufi_iec_tx_start(iec_cmd, iec_cmd_len, IEC_TX_EOI);
+            break;
+        case 1:
+            ret = ufi_iec_unlisten_begin();
+            break;
+        default:
+            return UFI_OK;
+    }
+    return (ret == UFI_OK) ? 1 : ret;
+}
+
+// Befehl an Laufwerk senden (blockierend, schläft zwischen den Ticks)
+int ufi_iec_command(uint8_t device, const char* cmd, uint8_t len) {
+    int ret = ufi_iec_command_begin(device, cmd, len);
+    if (ret != UFI_OK) {
+        return ret;
+    }
     
+    while ((ret = ufi_iec_command_poll()) == 1) {
+        __WFI();
+    }
     return ret;
 }
 
 // Status vom Laufwerk lesen
 int ufi_iec_read_status(uint8_t device, char* buffer, uint8_t max_len) {
+    uint32_t len = 0;
     int ret;
-    uint8_t idx = 0;
-    
-    // TALK Device, Secondary 15 (Status Channel)
-    ret = ufi_iec_talk(device);
-    if (ret != 0) return ret;
     
-    ret = ufi_iec_secondary(15);
+    // TALK Device, Secondary 15 (Status Channel), Turnaround
+    ret = ufi_iec_talk_sa(device, 15);
     if (ret != 0) return ret;
     
-    ufi_iec_atn(false);
-    
-    // Turnaround: Wir werden Listener
-    iec_release_clk();
-    iec_delay_us(100);
-    
     // Bytes lesen bis EOI
-    bool eoi = false;
-    while (!eoi && idx < max_len - 1) {
-        uint8_t byte;
-        ret = ufi_iec_receive_byte(&byte, &eoi);
-        if (ret != 0) break;
-        
-        buffer[idx++] = byte;
-    }
-    buffer[idx] = '\0';
+    ufi_iec_receive_buffer((uint8_t*)buffer, max_len - 1, &len);
+    buffer[len] = '\0';
     
     // UNTALK
-    ret = ufi_iec_untalk();
+    ufi_iec_untalk();
     
-    return idx;
+    return (int)len;
 }
 
 // Block lesen (z.B. für Raw Sector Access)
 int ufi_iec_read_block(uint8_t device, uint8_t track, uint8_t sector,
                        uint8_t* buffer, uint16_t* len) {
     char cmd[20];
+    uint32_t got = 0;
     int ret;
     
     // U1 Befehl: "U1:channel drive track sector"
@@ -406,27 +781,14 @@ int ufi_iec_read_block(uint8_t device, uint8_t track, uint8_t sector,
     if (ret != 0) return ret;
     
     // TALK Device, Kanal 2
-    ret = ufi_iec_talk(device);
+    ret = ufi_iec_talk_sa(device, 2);
     if (ret != 0) return ret;
     
-    ret = ufi_iec_secondary(2);
-    if (ret != 0) return ret;
+    // 256 Bytes lesen (Puffer voll ohne EOI ist hier das normale Ende)
+    ufi_iec_receive_buffer(buffer, 256, &got);
+    *len = (uint16_t)got;
     
-    ufi_iec_atn(false);
-    iec_release_clk();
-    iec_delay_us(100);
-    
-    // 256 Bytes lesen
-    *len = 0;
-    for (int i = 0; i < 256; i++) {
-        bool eoi;
-        ret = ufi_iec_receive_byte(&buffer[i], &eoi);
-        if (ret != 0) break;
-        (*len)++;
-        if (eoi) break;
-    }
-    
-    ret = ufi_iec_untalk();
+    ufi_iec_untalk();
     
     return (*len == 256) ? 0 : -1;
 }
@@ -434,52 +796,255 @@ int ufi_iec_read_block(uint8_t device, uint8_t track, uint8_t sector,
 // Directory lesen
 int ufi_iec_read_directory(uint8_t device, uint8_t* buffer, uint16_t max_len,
                            uint16_t* len) {
-    int ret;
+    uint32_t n = 0;
+    int ret = ufi_iec_load_file(device, "$", 1, buffer, max_len, &n);
+    *len = (uint16_t)n;
+    return ret;
+}
+
+/* ============================================================================
+ * TRANSAKTIONEN (komplett auf dem Gerät, ein USB-Roundtrip)
+ * ============================================================================ */
+
+/**
+ * LISTEN Device + Secondary Address, danach ATN freigeben
+ * Folgende Bytes gehen als Daten an den Listener.
+ * Asynchron, Abschluss mit ufi_iec_tx_poll().
+ */
+int ufi_iec_listen_sa_begin(uint8_t device, uint8_t sa) {
+    uint8_t cmd[2] = { 0x20 | (device & 0x1F), 0x60 | (sa & 0x0F) };
+    return iec_atn_begin(cmd, 2, IEC_TX_RELEASE_ATN);
+}
+
+/**
+ * TALK Device + Secondary Address, danach Turnaround (wir werden Listener)
+ * Asynchron, Abschluss mit ufi_iec_tx_poll().
+ */
+int ufi_iec_talk_sa_begin(uint8_t device, uint8_t sa) {
+    uint8_t cmd[2] = { 0x40 | (device & 0x1F), 0x60 | (sa & 0x0F) };
+    return iec_atn_begin(cmd, 2, IEC_TX_TURNAROUND);
+}
+
+/**
+ * LISTEN Device + OPEN Kanal, danach ATN freigeben (Dateiname folgt)
+ * Asynchron, Abschluss mit ufi_iec_tx_poll().
+ */
+int ufi_iec_open_begin(uint8_t device, uint8_t channel) {
+    uint8_t cmd[2] = { 0x20 | (device & 0x1F), 0xF0 | (channel & 0x0F) };
+    return iec_atn_begin(cmd, 2, IEC_TX_RELEASE_ATN);
+}
+
+/**
+ * LISTEN Device + CLOSE Kanal + UNLISTEN in einer ATN-Phase
+ * Asynchron, Abschluss mit ufi_iec_tx_poll().
+ */
+int ufi_iec_close_begin(uint8_t device, uint8_t channel) {
+    uint8_t cmd[3] = { 0x20 | (device & 0x1F), 0xE0 | (channel & 0x0F), 0x3F };
+    return iec_atn_begin(cmd, 3, IEC_TX_RELEASE_ATN);
+}
+
+int ufi_iec_listen_sa(uint8_t device, uint8_t sa) {
+    return iec_tx_wait(ufi_iec_listen_sa_begin(device, sa));
+}
+
+int ufi_iec_talk_sa(uint8_t device, uint8_t sa) {
+    return iec_tx_wait(ufi_iec_talk_sa_begin(device, sa));
+}
+
+/**
+ * Puffer an aktuellen Listener senden
+ * @param eoi_last  EOI mit dem letzten Byte signalisieren
+ */
+int ufi_iec_send_buffer(const uint8_t* data, uint32_t len, bool eoi_last) {
+    if (len == 0) {
+        return UFI_OK;
+    }
+    return iec_tx_run(data, len, eoi_last ? IEC_TX_EOI : 0);
+}
+
+/**
+ * Vom aktuellen Talker empfangen bis EOI oder Puffer voll
+ * @param len  Anzahl empfangener Bytes
+ */
+int ufi_iec_receive_buffer(uint8_t* buffer, uint32_t max_len, uint32_t* len) {
+    iec_rx_status_t status;
+    int error;
     
-    // "$" öffnen
-    ret = ufi_iec_listen(device);
-    if (ret != 0) return ret;
+    *len = 0;
+    if (max_len == 0) {
+        return UFI_ERR_BUFFER_FULL;
+    }
     
-    // Open mit Secondary 0
-    ret = ufi_iec_secondary(0xF0);  // OPEN Kanal 0
-    if (ret != 0) return ret;
+    int ret = ufi_iec_rx_start(buffer, max_len);
+    if (ret != UFI_OK) {
+        return ret;
+    }
     
-    ufi_iec_atn(false);
+    // Bis zum nächsten Interrupt schlafen statt auf CLK/DATA zu spinnen
+    while ((status = ufi_iec_rx_poll(len, &error)) == IEC_RX_BUSY) {
+        __WFI();
+    }
     
-    // "$" senden
-    ret = ufi_iec_send_byte('$', true);
-    if (ret != 0) return ret;
+    return (status == IEC_RX_DONE) ? UFI_OK : error;
+}
+
+#define IEC_NAME_MAX    64
+
+// LOAD-Ablauf: jeder Schritt wartet auf den vorher gestarteten Sende-/Empfangsjob
+typedef enum {
+    LOAD_IDLE = 0,
+    LOAD_OPEN,          // LISTEN + OPEN 0
+    LOAD_NAME,          // Dateiname mit EOI
+    LOAD_UNLISTEN,
+    LOAD_TALK,          // TALK 0 + Turnaround
+    LOAD_DATA,          // Empfang bis EOI
+    LOAD_UNTALK,
+    LOAD_CLOSE          // LISTEN + CLOSE 0 + UNLISTEN
+} iec_load_step_t;
+
+static iec_load_step_t iec_load_step = LOAD_IDLE;
+static uint8_t iec_load_device = 0;
+static char iec_load_name[IEC_NAME_MAX];
+static uint8_t iec_load_name_len = 0;
+static uint8_t* iec_load_buffer = NULL;
+static uint32_t iec_load_max = 0;
+static uint32_t iec_load_len = 0;
+static int iec_load_ret = UFI_OK;
+
+/**
+ * LOAD starten (entspricht LOAD"name",dev)
+ * 
+ * OPEN Kanal 0 mit Dateiname, TALK, Datenempfang bis EOI, UNTALK und
+ * CLOSE laufen nacheinander im TIM7-Interrupt.
+ * Fortschritt mit ufi_iec_load_poll().
+ */
+int ufi_iec_load_begin(uint8_t device, const char* name, uint8_t name_len,
+                       uint8_t* buffer, uint32_t max_len) {
+    if (name_len > IEC_NAME_MAX) {
+        return UFI_ERR_INVALID_PARAM;
+    }
     
-    ret = ufi_iec_unlisten();
-    if (ret != 0) return ret;
+    // Dateiname kopieren (USB-Puffer wird vom nächsten Befehl überschrieben)
+    memcpy(iec_load_name, name, name_len);
+    iec_load_name_len = name_len;
+    iec_load_device = device;
+    iec_load_buffer = buffer;
+    iec_load_max = max_len;
+    iec_load_len = 0;
+    iec_load_ret = UFI_OK;
     
-    // TALK Kanal 0
-    ret = ufi_iec_talk(device);
-    if (ret != 0) return ret;
+    // OPEN 0,"name" (Dateiname im nächsten Schritt)
+    int ret = ufi_iec_open_begin(device, 0);
+    iec_load_step = (ret == UFI_OK) ? LOAD_OPEN : LOAD_IDLE;
+    return ret;
+}
+
+/**
+ * LOAD-Fortschritt prüfen und nächsten Schritt starten
+ * @param len  Bisher empfangene Bytes
+ * @return 1 = läuft, sonst UFI_OK / Fehlercode
+ */
+int ufi_iec_load_poll(uint32_t* len) {
+    iec_rx_status_t status;
+    uint32_t n;
+    int error;
+    int ret;
     
-    ret = ufi_iec_secondary(0x60);
-    if (ret != 0) return ret;
+    *len = iec_load_len;
+    if (iec_load_step == LOAD_IDLE) {
+        return iec_load_ret;
+    }
     
-    ufi_iec_atn(false);
-    iec_release_clk();
-    iec_delay_us(100);
+    if (iec_load_step == LOAD_DATA) {
+        status = ufi_iec_rx_poll(&n, &error);
+    } else {
+        status = ufi_iec_tx_poll(&n, &error);
+    }
+    if (status == IEC_RX_BUSY) {
+        return 1;
+    }
+    ret = (status == IEC_RX_DONE) ? UFI_OK : error;
     
-    // Directory-Daten lesen
-    *len = 0;
-    bool eoi = false;
-    while (!eoi && *len < max_len) {
-        ret = ufi_iec_receive_byte(&buffer[*len], &eoi);
-        if (ret != 0) break;
-        (*len)++;
+    switch (iec_load_step) {
+        case LOAD_OPEN:
+            // Kein Gerät: nichts zu schließen
+            if (ret != UFI_OK) {
+                iec_load_ret = ret;
+                break;
+            }
+            iec_load_step = LOAD_NAME;
+            ret = ufi_iec_tx_start((const uint8_t*)iec_load_name, iec_load_name_len, IEC_TX_EOI);
+            break;
+            
+        case LOAD_NAME:
+            iec_load_ret = ret;
+            iec_load_step = LOAD_UNLISTEN;
+            ret = ufi_iec_unlisten_begin();
+            break;
+            
+        case LOAD_UNLISTEN:
+            if (iec_load_ret != UFI_OK) {
+                ret = iec_load_ret;
+                break;
+            }
+            iec_load_step = LOAD_TALK;
+            ret = ufi_iec_talk_sa_begin(iec_load_device, 0);
+            break;
+            
+        case LOAD_TALK:
+            if (ret == UFI_OK) {
+                iec_load_step = LOAD_DATA;
+                ret = ufi_iec_rx_start(iec_load_buffer, iec_load_max);
+                break;
+            }
+            iec_load_ret = ret;
+            iec_load_step = LOAD_UNTALK;
+            ret = ufi_iec_untalk_begin();
+            break;
+            
+        case LOAD_DATA:
+            iec_load_len = n;
+            *len = n;
+            iec_load_ret = ret;
+            iec_load_step = LOAD_UNTALK;
+            ret = ufi_iec_untalk_begin();
+            break;
+            
+        case LOAD_UNTALK:
+            // CLOSE 0 (auch nach Fehler, sonst bleibt der Kanal offen)
+            iec_load_step = LOAD_CLOSE;
+            ret = ufi_iec_close_begin(iec_load_device, 0);
+            break;
+            
+        default:
+            ret = iec_load_ret;
+            iec_load_step = LOAD_IDLE;
+            return ret;
     }
     
-    ret = ufi_iec_untalk();
+    if (ret != UFI_OK) {
+        iec_load_ret = ret;
+        iec_load_step = LOAD_IDLE;
+        return ret;
+    }
+    return 1;
+}
+
+/**
+ * Datei komplett laden (blockierend, schläft während des Empfangs)
+ * Die ersten zwei Bytes sind die Ladeadresse (wie auf Disk).
+ */
+int ufi_iec_load_file(uint8_t device, const char* name, uint8_t name_len,
+                      uint8_t* buffer, uint32_t max_len, uint32_t* len) {
+    *len = 0;
     
-    // Close Kanal 0
-    ret = ufi_iec_listen(device);
-    ret = ufi_iec_secondary(0xE0);  // CLOSE Kanal 0
-    ufi_iec_atn(false);
-    ret = ufi_iec_unlisten();
+    int ret = ufi_iec_load_begin(device, name, name_len, buffer, max_len);
+    if (ret != 0) {
+        return ret;
+    }
     
-    return 0;
+    while ((ret = ufi_iec_load_poll(len)) == 1) {
+        __WFI();
+    }
+    return ret;
 }
@@ -0,0 +1,1102 @@
+/**
+ * UFI Flux Engine - IEC Fast-Transfer Module
+ *
+ * Schnelle IEC-Protokolle für 1541/1571/1581:
+ * - JiffyDOS (Erkennung im ATN-Byte, 2 Bit pro Fenster auf CLK+DATA)
+ * - UFI 2-Bit Protokoll für hochgeladenen Drive-Code (M-W / M-E)
+ *
+ * Die Bit-Fenster sind DWT-getaktet und lesen/schreiben direkt IDR/BSRR,
+ * Interrupts sind nur für die Dauer eines Bytes (< 65µs) gesperrt. Längere
+ * Transfers laufen als Job aus task_iec, höchstens FAST_JOB_CHUNK Bytes
+ * pro Scheduler-Durchlauf.
+ */
+
+#include "ufi_firmware.h"
+#include "stm32h7xx_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+/* ============================================================================
+ * GPIO (Leitungstreiber aus ufi_firmware.h)
+ * ============================================================================ */
+
+#define IEC_RELEASE(pins)   iec_lines_set((pins), 0)
+#define IEC_PULL(pins)      iec_lines_set(0, (pins))
+#define IEC_IS_LOW(pin)     ((iec_lines_asserted() & (pin)) != 0)
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+#define CYCLES_PER_US       (SYSCLK_FREQ / 1000000)
+#define US_TO_CYCLES(us)    ((uint32_t)(us) * CYCLES_PER_US)
+
+#define FAST_READY_TIMEOUT_US   5000    // Warten auf Drive-Bereitschaft
+#define FAST_BYTE_GAP_US        20      // Drive holt nächstes Byte
+#define JIFFY_DETECT_US         400     // Verzögerung vor Bit 7 (ATN)
+#define ATN_BIT_US              60      // Standard Bit-Setup/-Valid
+#define ATN_ACK_US              1000    // Frame-Acknowledge
+
+/**
+ * Protokoll-Beschreibung: 4 Fenster mit je 2 Bits (CLK, DATA),
+ * relativ zum "Go"-Signal des Hosts. Bit-Index 0xFF = ungenutzt.
+ */
+typedef struct {
+    uint16_t window_ns[4];      // Abtastzeitpunkt nach Go
+    uint8_t clk_bit[4];         // Bit-Nummer auf CLK
+    uint8_t data_bit[4];        // Bit-Nummer auf DATA
+    uint16_t status_ns;         // EOI-Fenster (0 = keins)
+    uint16_t go_pin;            // Leitung, die der Host als Go freigibt
+    uint16_t ready_pin;         // Leitung, die der Drive als Ready freigibt
+    bool low_is_one;            // Leitung low = Bit 1
+} iec_fast_proto_t;
+
+/*
+ * JiffyDOS Empfang (Drive → Host)
+ * Fenster nach Drive-ROM Zykluszählung (1 MHz), Abtastung mittig.
+ */
+static const iec_fast_proto_t proto_jiffy_rx = {
+    .window_ns = { 15000, 25000, 36000, 46000 },
+    .clk_bit   = { 0, 2, 4, 6 },
+    .data_bit  = { 1, 3, 5, 7 },
+    .status_ns = 57000,
+    .go_pin    = IEC_DATA_PIN,
+    .ready_pin = IEC_CLK_PIN,
+    .low_is_one = false
+};
+
+/*
+ * JiffyDOS Senden (Host → Drive)
+ */
+static const iec_fast_proto_t proto_jiffy_tx = {
+    .window_ns = { 13000, 24000, 34000, 44000 },
+    .clk_bit   = { 4, 6, 3, 2 },
+    .data_bit  = { 5, 7, 1, 0 },
+    .status_ns = 0,
+    .go_pin    = IEC_CLK_PIN,
+    .ready_pin = IEC_DATA_PIN,
+    .low_is_one = false
+};
+
+/*
+ * UFI 2-Bit Empfang (mit hochgeladenem Drive-Code, siehe disk_reader_code)
+ * Drive gibt DATA frei = Byte bereit, Host gibt CLK frei = Go,
+ * Drive legt alle 14 Zyklen zwei Bits auf CLK/DATA (über 7406 invertiert).
+ * Go-Erkennung 0..7 Zyklen + 10 bis zum ersten STA → Fenster [17, 24]µs.
+ */
+static const iec_fast_proto_t proto_ufi2_rx = {
+    .window_ns = { 20500, 34500, 48500, 62500 },
+    .clk_bit   = { 0, 2, 4, 6 },
+    .data_bit  = { 1, 3, 5, 7 },
+    .status_ns = 0,
+    .go_pin    = IEC_CLK_PIN,
+    .ready_pin = IEC_DATA_PIN,
+    .low_is_one = true
+};
+
+static const iec_fast_proto_t* iec_fast_rx_proto(iec_fast_mode_t mode) {
+    switch (mode) {
+        case IEC_FAST_JIFFY:    return &proto_jiffy_rx;
+        case IEC_FAST_UFI_2BIT: return &proto_ufi2_rx;
+        default:                return NULL;
+    }
+}
+
+/* ============================================================================
+ * DWT HILFSFUNKTIONEN
+ * ============================================================================ */
+
+static inline void fast_wait_until(uint32_t start, uint32_t cycles) {
+    while ((DWT->CYCCNT - start) < cycles);
+}
+
+static inline int fast_wait_level(uint16_t pin, bool low, uint32_t timeout_us) {
+    uint32_t start = DWT->CYCCNT;
+    while (IEC_IS_LOW(pin) != low) {
+        if ((DWT->CYCCNT - start) > US_TO_CYCLES(timeout_us)) {
+            return UFI_ERR_TIMEOUT;
+        }
+    }
+    return UFI_OK;
+}
+
+/* ============================================================================
+ * JIFFYDOS ERKENNUNG (im ATN-Befehlsbyte)
+ * ============================================================================ */
+
+/**
+ * ATN-Befehlsbyte senden (ATN muss bereits aktiv sein)
+ *
+ * Vor Bit 7 wird JIFFY_DETECT_US gewartet; ein JiffyDOS-Laufwerk zieht in
+ * dieser Pause kurz DATA und schaltet für diese Transaktion auf JiffyDOS.
+ */
+int ufi_iec_jiffy_atn_byte(uint8_t byte, bool* jiffy) {
+    *jiffy = false;
+
+    // Talker-Rolle: CLK ziehen, auf Listener (DATA low) warten
+    IEC_PULL(IEC_CLK_PIN);
+    IEC_RELEASE(IEC_DATA_PIN);
+    if (fast_wait_level(IEC_DATA_PIN, true, ATN_ACK_US) != UFI_OK) {
+        return UFI_ERR_IEC_NRFD;
+    }
+
+    // Ready to send, auf Ready for Data warten
+    IEC_RELEASE(IEC_CLK_PIN);
+    if (fast_wait_level(IEC_DATA_PIN, false, IEC_TIMEOUT_US) != UFI_OK) {
+        return UFI_ERR_TIMEOUT;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        IEC_PULL(IEC_CLK_PIN);
+
+        if (i == 7) {
+            // JiffyDOS-Fenster: Listener antwortet mit DATA low
+            uint32_t start = DWT->CYCCNT;
+            while ((DWT->CYCCNT - start) < US_TO_CYCLES(JIFFY_DETECT_US)) {
+                if (IEC_IS_LOW(IEC_DATA_PIN)) {
+                    *jiffy = true;
+                }
+            }
+            if (*jiffy && fast_wait_level(IEC_DATA_PIN, false, ATN_BIT_US * 4) != UFI_OK) {
+                return UFI_ERR_TIMEOUT;
+            }
+        }
+
+        if (byte & (1 << i)) {
+            IEC_RELEASE(IEC_DATA_PIN);
+        } else {
+            IEC_PULL(IEC_DATA_PIN);
+        }
+
+        uint32_t t = DWT->CYCCNT;
+        fast_wait_until(t, US_TO_CYCLES(ATN_BIT_US));
+        IEC_RELEASE(IEC_CLK_PIN);
+        t = DWT->CYCCNT;
+        fast_wait_until(t, US_TO_CYCLES(ATN_BIT_US));
+    }
+
+    // Frame-Ende: CLK ziehen, DATA freigeben, auf Acknowledge warten
+    IEC_PULL(IEC_CLK_PIN);
+    IEC_RELEASE(IEC_DATA_PIN);
+    if (fast_wait_level(IEC_DATA_PIN, true, ATN_ACK_US) != UFI_OK) {
+        return UFI_ERR_IEC_NOACK;
+    }
+
+    return UFI_OK;
+}
+
+/**
+ * TALK mit JiffyDOS-Erkennung + Secondary + Turnaround
+ * @param jiffy  true wenn das Laufwerk JiffyDOS bestätigt hat
+ */
+int ufi_iec_jiffy_talk_sa(uint8_t device, uint8_t sa, bool* jiffy) {
+    bool dummy;
+
+    ufi_iec_atn(true);
+    int ret = ufi_iec_jiffy_atn_byte(0x40 | (device & 0x1F), jiffy);
+    if (ret == UFI_OK) {
+        ret = ufi_iec_jiffy_atn_byte(0x60 | (sa & 0x0F), &dummy);
+    }
+
+    // Turnaround: DATA ziehen (Listener), CLK freigeben, ATN freigeben
+    IEC_PULL(IEC_DATA_PIN);
+    IEC_RELEASE(IEC_CLK_PIN);
+    ufi_iec_atn(false);
+
+    // Laufwerk übernimmt CLK als Talker
+    if (ret == UFI_OK && fast_wait_level(IEC_CLK_PIN, true, ATN_ACK_US) != UFI_OK) {
+        ret = UFI_ERR_TIMEOUT;
+    }
+
+    return ret;
+}
+
+/* ============================================================================
+ * BYTE-TRANSFER (DWT-getaktet, direkte Register)
+ * ============================================================================ */
+
+/**
+ * Ein Byte mit Fast-Protokoll empfangen
+ */
+int ufi_iec_fast_receive_byte(iec_fast_mode_t mode, uint8_t* byte, bool* eoi) {
+    const iec_fast_proto_t* p = iec_fast_rx_proto(mode);
+    if (!p) {
+        return UFI_ERR_NOT_IMPL;
+    }
+
+    *byte = 0;
+    *eoi = false;
+
+    // Drive bereit? (gibt ready_pin frei)
+    if (fast_wait_level(p->ready_pin, false, FAST_READY_TIMEOUT_US) != UFI_OK) {
+        return UFI_ERR_TIMEOUT;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    // Go
+    IEC_RELEASE(p->go_pin);
+    uint32_t start = DWT->CYCCNT;
+
+    for (int w = 0; w < 4; w++) {
+        fast_wait_until(start, p->window_ns[w] * CYCLES_PER_US / 1000);
+        uint16_t lines = iec_lines_asserted();
+
+        bool clk_low = (lines & IEC_CLK_PIN) != 0;
+        bool data_low = (lines & IEC_DATA_PIN) != 0;
+
+        if (clk_low == p->low_is_one)  *byte |= (1 << p->clk_bit[w]);
+        if (data_low == p->low_is_one) *byte |= (1 << p->data_bit[w]);
+    }
+
+    if (p->status_ns) {
+        fast_wait_until(start, p->status_ns * CYCLES_PER_US / 1000);
+        // JiffyDOS: CLK high + DATA low im Status-Fenster = letztes Byte
+        uint16_t lines = iec_lines_asserted();
+        *eoi = !(lines & IEC_CLK_PIN) && (lines & IEC_DATA_PIN);
+    }
+
+    // Busy: Go-Leitung wieder ziehen
+    IEC_PULL(p->go_pin);
+
+    __set_PRIMASK(primask);
+
+    return UFI_OK;
+}
+
+/**
+ * Ein Byte mit JiffyDOS an den Listener senden
+ */
+int ufi_iec_fast_send_byte(iec_fast_mode_t mode, uint8_t byte) {
+    if (mode != IEC_FAST_JIFFY) {
+        return UFI_ERR_NOT_IMPL;
+    }
+    const iec_fast_proto_t* p = &proto_jiffy_tx;
+
+    // Listener bereit (gibt DATA frei)
+    if (fast_wait_level(p->ready_pin, false, FAST_READY_TIMEOUT_US) != UFI_OK) {
+        return UFI_ERR_TIMEOUT;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    IEC_RELEASE(p->go_pin);
+    uint32_t start = DWT->CYCCNT;
+
+    for (int w = 0; w < 4; w++) {
+        // Bits kurz vor dem Abtastzeitpunkt des Empfängers anlegen
+        fast_wait_until(start, (p->window_ns[w] - 4000) * CYCLES_PER_US / 1000);
+
+        uint16_t set = 0, reset = 0;
+        if (byte & (1 << p->clk_bit[w]))  set |= IEC_CLK_PIN;  else reset |= IEC_CLK_PIN;
+        if (byte & (1 << p->data_bit[w])) set |= IEC_DATA_PIN; else reset |= IEC_DATA_PIN;
+        iec_lines_set(set, reset);  // Beide Leitungen gleichzeitig
+    }
+
+    fast_wait_until(start, (p->window_ns[3] + 6000) * CYCLES_PER_US / 1000);
+
+    // Zurück in Ruhe: CLK gezogen, DATA frei (Listener quittiert mit DATA low)
+    iec_lines_set(IEC_DATA_PIN, IEC_CLK_PIN);
+
+    __set_PRIMASK(primask);
+
+    return fast_wait_level(IEC_DATA_PIN, true, ATN_ACK_US) == UFI_OK ? UFI_OK : UFI_ERR_IEC_NOACK;
+}
+
+/* ============================================================================
+ * LAUFWERK-SPEICHER (M-W / M-E über Befehlskanal)
+ * ============================================================================ */
+
+#define MW_CHUNK    32      // Max. Bytes pro M-W (1541 Befehlspuffer)
+
+/**
+ * M-W Befehl aufbauen (n <= MW_CHUNK)
+ * @return Befehlslänge
+ */
+static uint8_t mw_command(char* cmd, uint16_t addr, const uint8_t* data, uint8_t n) {
+    cmd[0] = 'M'; cmd[1] = '-'; cmd[2] = 'W';
+    cmd[3] = (char)(addr & 0xFF);
+    cmd[4] = (char)(addr >> 8);
+    cmd[5] = (char)n;
+    memcpy(&cmd[6], data, n);
+    return 6 + n;
+}
+
+/* ============================================================================
+ * DISK-IMAGE ÜBER IEC (D64 / D71 / D81)
+ * ============================================================================ */
+
+#define DISK_CODE_ADDR      0x0500  // Puffer 2 im Laufwerk-RAM
+#define DISK_PARAM_ADDR     0x0503  // Track, Anzahl, Sektor-Reihenfolge
+#define DISK_EXEC_ADDR      0x0500
+#define DISK_INTERLEAVE     6       // Sektoren Versatz (Transfer ~45ms/Sektor)
+#define DISK_SECTOR_FRAME   258     // [Sektor, Job-Status, 256 Daten]
+#define DISK_START_MS       100     // Drive-Code gestartet (DATA busy)
+#define DISK_JOB_MS         10000   // Seek + Lesejob inkl. DOS-Wiederholungen/Kopf-Bump
+#define DISK_TRACKS_1541    40      // 1541/1571 je Seite, inkl. erweiterter Tracks 36-40
+#define DISK_TRACKS_1581    80
+
+/*
+ * 1541/1571 Drive-Code (1 MHz), geladen nach $0500:
+ *
+ *   $0500  JMP $0525
+ *   $0503  Track, $0504 Anzahl, $0505.. Sektor-Reihenfolge (max. 21)
+ *   $0521  Kodiertabelle 2 Bit → $1800 (CLK OUT = Bit 3, DATA OUT = Bit 1)
+ *   $0525  Für jeden Sektor: Job $80 (Lesen) in Puffer 0 ($0300), warten,
+ *          dann Sektor, Status und 256 Bytes im UFI 2-Bit Protokoll senden
+ *
+ * Die GCR-Dekodierung läuft im Job-Code des DOS, ohne Umweg über den
+ * Standard-Bus. Die Bit-Fenster stehen 14 Zyklen auseinander.
+ */
+static const uint8_t disk_reader_code[] = {
+    0x4C, 0x25, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x02,
+    0x0A, 0xA9, 0x02, 0x8D, 0x00, 0x18, 0xA9, 0x00, 0x8D, 0x1A, 0x05, 0xAE,
+    0x1A, 0x05, 0xBD, 0x05, 0x05, 0x85, 0x07, 0xAD, 0x03, 0x05, 0x85, 0x06,
+    0xA9, 0x80, 0x85, 0x00, 0xA5, 0x00, 0x30, 0xFC, 0x8D, 0x1B, 0x05, 0xA5,
+    0x07, 0x20, 0x6E, 0x05, 0xAD, 0x1B, 0x05, 0x20, 0x6E, 0x05, 0xA0, 0x00,
+    0xB9, 0x00, 0x03, 0x20, 0x6E, 0x05, 0xC8, 0xD0, 0xF7, 0xEE, 0x1A, 0x05,
+    0xAD, 0x1A, 0x05, 0xCD, 0x04, 0x05, 0xD0, 0xC7, 0xA9, 0x00, 0x8D, 0x00,
+    0x18, 0x60, 0x8D, 0x1C, 0x05, 0x29, 0x03, 0xAA, 0xBD, 0x21, 0x05, 0x8D,
+    0x1D, 0x05, 0xAD, 0x1C, 0x05, 0x4A, 0x4A, 0x8D, 0x1C, 0x05, 0x29, 0x03,
+    0xAA, 0xBD, 0x21, 0x05, 0x8D, 0x1E, 0x05, 0xAD, 0x1C, 0x05, 0x4A, 0x4A,
+    0x8D, 0x1C, 0x05, 0x29, 0x03, 0xAA, 0xBD, 0x21, 0x05, 0x8D, 0x1F, 0x05,
+    0xAD, 0x1C, 0x05, 0x4A, 0x4A, 0xAA, 0xBD, 0x21, 0x05, 0x8D, 0x20, 0x05,
+    0xAD, 0x00, 0x18, 0x29, 0x04, 0xF0, 0xF9, 0x78, 0xA9, 0x00, 0x8D, 0x00,
+    0x18, 0xA9, 0x04, 0x2C, 0x00, 0x18, 0xD0, 0xFB, 0xAD, 0x1D, 0x05, 0x8D,
+    0x00, 0x18, 0xEA, 0xEA, 0xEA, 0xAD, 0x1E, 0x05, 0x8D, 0x00, 0x18, 0xEA,
+    0xEA, 0xEA, 0xAD, 0x1F, 0x05, 0x8D, 0x00, 0x18, 0xEA, 0xEA, 0xEA, 0xAD,
+    0x20, 0x05, 0x8D, 0x00, 0x18, 0xEA, 0xEA, 0xEA, 0xEA, 0xA9, 0x02, 0x8D,
+    0x00, 0x18, 0x58, 0x60
+};
+
+static iec_disk_type_t g_disk_type = IEC_DISK_NONE;
+static uint8_t g_disk_device = 0;
+static uint8_t g_disk_side = 0;
+
+/**
+ * Sektoren pro Track (Zonen 1541, 1581 konstant)
+ */
+static uint8_t disk_sectors(iec_disk_type_t type, uint8_t track) {
+    if (type == IEC_DISK_D81) return 40;
+    if (track <= 17) return 21;
+    if (track <= 24) return 19;
+    if (track <= 30) return 18;
+    return 17;
+}
+
+/**
+ * Track (1-basiert) und Seite gültig für den Disk-Typ?
+ */
+static bool disk_track_valid(iec_disk_type_t type, uint8_t track, uint8_t side) {
+    if (track == 0) return false;
+    if (type == IEC_DISK_D81) return track <= DISK_TRACKS_1581;
+    return track <= DISK_TRACKS_1541 && side <= (type == IEC_DISK_D71 ? 1 : 0);
+}
+
+/**
+ * Lese-Reihenfolge mit Interleave (wie DOS: belegt → nächster freier)
+ */
+static void disk_sector_order(uint8_t n, uint8_t step, uint8_t* order) {
+    uint32_t used = 0;
+    uint8_t s = 0;
+
+    for (uint8_t i = 0; i < n; i++) {
+        while (used & (1UL << s)) {
+            s = (s + 1) % n;
+        }
+        order[i] = s;
+        used |= (1UL << s);
+        s = (s + step) % n;
+    }
+}
+
+/**
+ * Fehlercode vom Befehlskanal in Job-Status umrechnen (D64 Error-Info)
+ * "00,OK" → 1, "20..29" → 2..11
+ */
+static uint8_t disk_status_code(const char* status, uint32_t len) {
+    if (len < 2) {
+        return 0x0F;    // Laufwerk antwortet nicht
+    }
+    int code = (status[0] - '0') * 10 + (status[1] - '0');
+    if (code >= 20 && code <= 29) {
+        return (uint8_t)(code - 18);
+    }
+    return 1;
+}
+
+/* ============================================================================
+ * IEC-JOBS (Fast-Load, Fast-Empfang, M-W/M-E, Disk vorbereiten, Track lesen)
+ * ============================================================================
+ * Jeder Job läuft schrittweise aus task_iec (ufi_usb_iec_poll): pro
+ * Scheduler-Durchlauf ein Standard-IEC-Teilschritt (im TIM7-Tick) oder
+ * höchstens FAST_JOB_CHUNK Fast-Bytes. Der USB-Dispatcher startet den Job
+ * nur und antwortet, wenn ufi_iec_job_poll() fertig meldet.
+ */
+
+#define FAST_JOB_CHUNK      32      // Fast-Bytes pro Durchlauf (~3ms)
+#define JOB_NAME_MAX        64
+
+typedef enum {
+    JOB_WAIT_NONE,
+    JOB_WAIT_TX,            // Sendejob (ATN-Befehle, Daten)
+    JOB_WAIT_RX,            // Empfangsjob (Standard-Protokoll)
+    JOB_WAIT_CMD            // Befehl auf Kanal 15
+} iec_job_wait_t;
+
+typedef enum {
+    JOB_IDLE = 0,
+    // Fast-Load
+    FL_NAME, FL_UNLISTEN, FL_TALK, FL_JIFFY, FL_UNTALK, FL_CLOSE,
+    // Fast-Empfang
+    FR_BYTES,
+    // Track 1541/1571 über Drive-Code
+    DT_PARAM, DT_EXEC, DT_START, DT_STARTED, DT_READY, DT_FRAME,
+    // Track 1581 Block für Block
+    DB_POINTER, DB_READ, DB_TALK, DB_RECEIVE, DB_UNTALK, DB_DONE,
+    DB_STATUS, DB_STATUS_RX, DB_STATUS_UNTALK, DB_STATUS_DONE,
+    // Laufwerk-Speicher
+    MW_DATA, ME_DONE,
+    // Disk vorbereiten: Initialize, Drive-Code bzw. Block-Kanal (1581)
+    DI_CODE, DI_NAME, DI_UNLISTEN, DI_DONE,
+    JOB_END
+} iec_job_step_t;
+
+typedef struct {
+    iec_job_step_t step;
+    iec_job_wait_t wait;
+    int result;             // Ergebnis der letzten Teiloperation
+    int ret;                // Gemerktes Job-Ergebnis (vor UNTALK/CLOSE)
+    uint8_t* buffer;
+    uint32_t max_len;
+    uint32_t len;           // Fertige Bytes im Puffer
+    uint32_t pos;           // Bytes im aktuellen Frame / Block
+    uint32_t rx_len;        // Länge des letzten Empfangsjobs
+    uint32_t count;         // Fast-Empfang: feste Anzahl (0 = bis EOI), M-W: Bytes
+    uint32_t deadline;      // HAL_GetTick()-Grenze der Warte-Schritte
+    const uint8_t* data;    // M-W Quelldaten
+    uint16_t addr;          // M-W Zieladresse
+    iec_disk_type_t type;   // Disk vorbereiten
+    iec_fast_mode_t mode;
+    uint8_t device;
+    uint8_t track;
+    uint8_t side;
+    uint8_t sector;         // Index in der Lese-Reihenfolge bzw. Block
+    uint8_t sectors;
+    bool jiffy;
+    bool eoi;
+    char name[JOB_NAME_MAX];
+    uint8_t name_len;
+    char status[40];
+} iec_job_t;
+
+static iec_job_t g_job;
+
+/**
+ * Teiloperation gestartet: ab dem nächsten Durchlauf auf ihr Ende warten
+ * @param start  Rückgabe der Start-Funktion (Fehler geht an den nächsten Schritt)
+ */
+static void job_await(iec_job_wait_t wait, iec_job_step_t next, int start) {
+    g_job.step = next;
+    g_job.wait = (start == UFI_OK) ? wait : JOB_WAIT_NONE;
+    g_job.result = start;
+}
+
+/**
+ * Laufende Teiloperation prüfen
+ * @return 1 = läuft, sonst deren Ergebnis
+ */
+static int job_pending(void) {
+    iec_rx_status_t status;
+    uint32_t n;
+    int error;
+
+    switch (g_job.wait) {
+        case JOB_WAIT_TX:
+            status = ufi_iec_tx_poll(&n, &error);
+            break;
+        case JOB_WAIT_RX:
+            status = ufi_iec_rx_poll(&n, &error);
+            g_job.rx_len = n;
+            break;
+        case JOB_WAIT_CMD: {
+            int ret = ufi_iec_command_poll();
+            if (ret != 1) {
+                g_job.wait = JOB_WAIT_NONE;
+            }
+            return ret;
+        }
+        default:
+            return g_job.result;
+    }
+
+    if (status == IEC_RX_BUSY) {
+        return 1;
+    }
+    g_job.wait = JOB_WAIT_NONE;
+    return (status == IEC_RX_DONE) ? UFI_OK : error;
+}
+
+static bool job_expired(void) {
+    return (int32_t)(HAL_GetTick() - g_job.deadline) > 0;
+}
+
+/**
+ * Bis zu FAST_JOB_CHUNK Bytes empfangen (bis *pos == end oder EOI)
+ */
+static int job_fast_chunk(iec_fast_mode_t mode, uint8_t* out, uint32_t* pos, uint32_t end) {
+    for (uint32_t i = 0; i < FAST_JOB_CHUNK && *pos < end && !g_job.eoi; i++) {
+        int ret = ufi_iec_fast_receive_byte(mode, &out[*pos], &g_job.eoi);
+        if (ret != UFI_OK) {
+            return ret;
+        }
+        (*pos)++;
+
+        uint32_t t = DWT->CYCCNT;
+        fast_wait_until(t, US_TO_CYCLES(FAST_BYTE_GAP_US));
+    }
+    return UFI_OK;
+}
+
+static int job_start(iec_job_step_t step, iec_job_wait_t wait, int start) {
+    job_await(wait, step, start);
+    if (start != UFI_OK) {
+        g_job.step = JOB_IDLE;
+    }
+    return start;
+}
+
+/* ----------------------------------------------------------------------------
+ * Fast-Load: OPEN 0,"name" → TALK mit JiffyDOS-Erkennung → Daten → CLOSE
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Datei laden, JiffyDOS wenn das Laufwerk es bestätigt, sonst Standard
+ * Fortschritt mit ufi_iec_job_poll(), Protokoll mit ufi_iec_fast_load_jiffy().
+ */
+int ufi_iec_fast_load_begin(uint8_t device, const char* name, uint8_t name_len,
+                            uint8_t* buffer, uint32_t max_len) {
+    if (g_job.step != JOB_IDLE) {
+        return UFI_ERR_BUSY;
+    }
+    if (name_len > JOB_NAME_MAX) {
+        return UFI_ERR_INVALID_PARAM;
+    }
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.device = device;
+    g_job.buffer = buffer;
+    g_job.max_len = max_len;
+    memcpy(g_job.name, name, name_len);
+    g_job.name_len = name_len;
+
+    // OPEN 0 (Standard-Protokoll), Dateiname im nächsten Schritt
+    return job_start(FL_NAME, JOB_WAIT_TX, ufi_iec_open_begin(device, 0));
+}
+
+bool ufi_iec_fast_load_jiffy(void) {
+    return g_job.jiffy;
+}
+
+static int fast_load_step(int ret) {
+    switch (g_job.step) {
+        case FL_NAME:
+            // Kein Gerät: nichts zu schließen
+            if (ret != UFI_OK) return ret;
+            job_await(JOB_WAIT_TX, FL_UNLISTEN,
+                      ufi_iec_tx_start((const uint8_t*)g_job.name, g_job.name_len, IEC_TX_EOI));
+            return 1;
+
+        case FL_UNLISTEN:
+            g_job.ret = ret;
+            job_await(JOB_WAIT_TX, FL_TALK, ufi_iec_unlisten_begin());
+            return 1;
+
+        case FL_TALK:
+            if (g_job.ret != UFI_OK) return g_job.ret;
+
+            // TALK mit JiffyDOS-Erkennung (zwei ATN-Bytes, wenige ms)
+            ret = ufi_iec_jiffy_talk_sa(g_job.device, 0, &g_job.jiffy);
+            if (ret != UFI_OK) {
+                job_await(JOB_WAIT_NONE, FL_UNTALK, ret);
+            } else if (g_job.jiffy) {
+                // Host busy, bis das erste Byte bereitliegt
+                IEC_PULL(proto_jiffy_rx.go_pin);
+                job_await(JOB_WAIT_NONE, FL_JIFFY, UFI_OK);
+            } else {
+                job_await(JOB_WAIT_RX, FL_UNTALK,
+                          ufi_iec_rx_start(g_job.buffer, g_job.max_len));
+            }
+            return 1;
+
+        case FL_JIFFY:
+            ret = job_fast_chunk(IEC_FAST_JIFFY, g_job.buffer, &g_job.len, g_job.max_len);
+            if (ret == UFI_OK && !g_job.eoi) {
+                if (g_job.len < g_job.max_len) return 1;
+                ret = UFI_ERR_BUFFER_FULL;
+            }
+            job_await(JOB_WAIT_NONE, FL_UNTALK, ret);
+            return 1;
+
+        case FL_UNTALK:
+            if (!g_job.jiffy) {
+                g_job.len = g_job.rx_len;
+            }
+            g_job.ret = ret;
+            job_await(JOB_WAIT_TX, FL_CLOSE, ufi_iec_untalk_begin());
+            return 1;
+
+        case FL_CLOSE:
+            // CLOSE 0 (auch nach Fehler, sonst bleibt der Kanal offen)
+            job_await(JOB_WAIT_TX, JOB_END, ufi_iec_close_begin(g_job.device, 0));
+            return 1;
+
+        default:
+            return g_job.ret;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Fast-Empfang vom aktuellen Talker
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Empfangen bis EOI (JiffyDOS) bzw. bis count Bytes (2-Bit, count > 0)
+ * Fortschritt mit ufi_iec_job_poll(), Teildaten bleiben auch bei Fehler.
+ */
+int ufi_iec_fast_recv_begin(iec_fast_mode_t mode, uint8_t* buffer,
+                            uint32_t max_len, uint32_t count) {
+    const iec_fast_proto_t* p = iec_fast_rx_proto(mode);
+
+    if (g_job.step != JOB_IDLE) {
+        return UFI_ERR_BUSY;
+    }
+    if (!p) {
+        return UFI_ERR_NOT_IMPL;
+    }
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.mode = mode;
+    g_job.buffer = buffer;
+    g_job.count = count;
+    g_job.max_len = (count > 0 && count < max_len) ? count : max_len;
+
+    // Host busy, bis das erste Byte bereitliegt
+    IEC_PULL(p->go_pin);
+
+    return job_start(FR_BYTES, JOB_WAIT_NONE, UFI_OK);
+}
+
+static int fast_recv_step(void) {
+    int ret = job_fast_chunk(g_job.mode, g_job.buffer, &g_job.len, g_job.max_len);
+    if (ret != UFI_OK) {
+        return ret;
+    }
+    if (!g_job.eoi && g_job.len < g_job.max_len) {
+        return 1;
+    }
+
+    if (g_job.mode == IEC_FAST_UFI_2BIT) {
+        // Drive-Code kehrt nach count Bytes zurück, Bus freigeben
+        IEC_RELEASE(IEC_CLK_PIN | IEC_DATA_PIN);
+    }
+    return (!g_job.eoi && g_job.count == 0) ? UFI_ERR_BUFFER_FULL : UFI_OK;
+}
+
+/* ----------------------------------------------------------------------------
+ * Track lesen
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Kompletten Track lesen
+ *
+ * Ausgabe: pro Sektor [Sektor, Status, 256 Bytes] in Lese-Reihenfolge,
+ * Status wie D64 Error-Info (1 = OK, 2..11 = Fehler 20..29).
+ * Fortschritt mit ufi_iec_job_poll().
+ */
+int ufi_iec_disk_track_begin(uint8_t track, uint8_t side, uint8_t* buffer,
+                             uint32_t max_len) {
+    uint8_t n = disk_sectors(g_disk_type, track);
+
+    if (g_job.step != JOB_IDLE || g_disk_type == IEC_DISK_NONE) {
+        return UFI_ERR_BUSY;
+    }
+    if (!disk_track_valid(g_disk_type, track, side)) {
+        return UFI_ERR_INVALID_PARAM;
+    }
+    if ((uint32_t)n * DISK_SECTOR_FRAME > max_len) {
+        return UFI_ERR_BUFFER_FULL;
+    }
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.device = g_disk_device;
+    g_job.buffer = buffer;
+    g_job.max_len = max_len;
+    g_job.track = track;
+    g_job.side = side;
+    g_job.sectors = n;
+
+    if (g_disk_type == IEC_DISK_D81) {
+        // 1581: Block für Block auf dem Gerät, ein USB-Roundtrip pro Track
+        return job_start(DB_POINTER, JOB_WAIT_NONE, UFI_OK);
+    }
+
+    // 1571: Seite im 1541-Modus umschalten
+    if (g_disk_type == IEC_DISK_D71 && side != g_disk_side) {
+        return job_start(DT_PARAM, JOB_WAIT_CMD,
+                         ufi_iec_command_begin(g_job.device, side ? "U0>H1" : "U0>H0", 5));
+    }
+    return job_start(DT_PARAM, JOB_WAIT_NONE, UFI_OK);
+}
+
+// Drive-Code hängt im Handshake: Laufwerk zurücksetzen
+static int disk_code_abort(int ret) {
+    IEC_RELEASE(IEC_CLK_PIN | IEC_DATA_PIN);
+    ufi_iec_reset();
+    g_disk_type = IEC_DISK_NONE;
+    return ret;
+}
+
+static int disk_code_step(int ret) {
+    switch (g_job.step) {
+        case DT_PARAM: {
+            if (ret != UFI_OK) return ret;
+            g_disk_side = g_job.side;
+
+            // Parameter: Track, Anzahl, Reihenfolge
+            uint8_t param[2 + 21];
+            char cmd[6 + sizeof(param)];
+            param[0] = g_job.track;
+            param[1] = g_job.sectors;
+            disk_sector_order(g_job.sectors, DISK_INTERLEAVE, &param[2]);
+
+            uint8_t len = mw_command(cmd, DISK_PARAM_ADDR, param, 2 + g_job.sectors);
+            job_await(JOB_WAIT_CMD, DT_EXEC, ufi_iec_command_begin(g_job.device, cmd, len));
+            return 1;
+        }
+
+        case DT_EXEC: {
+            if (ret != UFI_OK) return ret;
+            char cmd[5] = { 'M', '-', 'E', (char)(DISK_EXEC_ADDR & 0xFF), (char)(DISK_EXEC_ADDR >> 8) };
+            job_await(JOB_WAIT_CMD, DT_START, ufi_iec_command_begin(g_job.device, cmd, sizeof(cmd)));
+            return 1;
+        }
+
+        case DT_START:
+            if (ret != UFI_OK) return ret;
+
+            // Host busy (CLK), DATA dem Laufwerk überlassen
+            IEC_RELEASE(IEC_DATA_PIN);
+            IEC_PULL(IEC_CLK_PIN);
+            g_job.deadline = HAL_GetTick() + DISK_START_MS;
+            job_await(JOB_WAIT_NONE, DT_STARTED, UFI_OK);
+            return 1;
+
+        case DT_STARTED:
+            // Drive-Code läuft, sobald er DATA zieht
+            if (IEC_IS_LOW(IEC_DATA_PIN)) {
+                g_job.deadline = HAL_GetTick() + DISK_JOB_MS;
+                job_await(JOB_WAIT_NONE, DT_READY, UFI_OK);
+            } else if (job_expired()) {
+                return disk_code_abort(UFI_ERR_TIMEOUT);
+            }
+            return 1;
+
+        case DT_READY:
+            // Erstes Byte erst nach Seek/Lesejob bereit. Fehlerhafte Sektoren
+            // kommen mit Job-Status, Timeout heißt: Drive-Code hängt
+            if (!IEC_IS_LOW(IEC_DATA_PIN)) {
+                g_job.pos = 0;
+                job_await(JOB_WAIT_NONE, DT_FRAME, UFI_OK);
+            } else if (job_expired()) {
+                return disk_code_abort(UFI_ERR_TIMEOUT);
+            }
+            return 1;
+
+        case DT_FRAME:
+            ret = job_fast_chunk(IEC_FAST_UFI_2BIT, &g_job.buffer[g_job.len],
+                                 &g_job.pos, DISK_SECTOR_FRAME);
+            if (ret != UFI_OK) {
+                return disk_code_abort(ret);
+            }
+            if (g_job.pos < DISK_SECTOR_FRAME) {
+                return 1;
+            }
+
+            g_job.len += DISK_SECTOR_FRAME;
+            if (++g_job.sector < g_job.sectors) {
+                g_job.deadline = HAL_GetTick() + DISK_JOB_MS;
+                job_await(JOB_WAIT_NONE, DT_READY, UFI_OK);
+                return 1;
+            }
+            IEC_RELEASE(IEC_CLK_PIN | IEC_DATA_PIN);
+            return UFI_OK;
+
+        default:
+            return UFI_ERR_BUSY;
+    }
+}
+
+// Block fertig, nächster oder Track komplett
+static int disk_block_next(void) {
+    g_job.len += DISK_SECTOR_FRAME;
+    if (++g_job.sector >= g_job.sectors) {
+        return UFI_OK;
+    }
+    job_await(JOB_WAIT_NONE, DB_POINTER, UFI_OK);
+    return 1;
+}
+
+static int disk_block_step(int ret) {
+    uint8_t* out = &g_job.buffer[g_job.len];
+
+    switch (g_job.step) {
+        case DB_POINTER:
+            out[0] = g_job.sector;
+            g_job.pos = 0;
+            job_await(JOB_WAIT_CMD, DB_READ, ufi_iec_command_begin(g_job.device, "B-P:2 0", 7));
+            return 1;
+
+        case DB_READ: {
+            if (ret != UFI_OK) break;
+            // U1 Befehl: "U1:channel drive track sector", Kanal 2
+            char cmd[20];
+            snprintf(cmd, sizeof(cmd), "U1:2 0 %d %d", g_job.track, g_job.sector);
+            job_await(JOB_WAIT_CMD, DB_TALK, ufi_iec_command_begin(g_job.device, cmd, strlen(cmd)));
+            return 1;
+        }
+
+        case DB_TALK:
+            if (ret != UFI_OK) break;
+            job_await(JOB_WAIT_TX, DB_RECEIVE, ufi_iec_talk_sa_begin(g_job.device, 2));
+            return 1;
+
+        case DB_RECEIVE:
+            if (ret != UFI_OK) break;
+            g_job.rx_len = 0;
+            job_await(JOB_WAIT_RX, DB_UNTALK, ufi_iec_rx_start(&out[2], 256));
+            return 1;
+
+        case DB_UNTALK:
+            // Puffer voll ohne EOI ist hier das normale Ende
+            g_job.pos = g_job.rx_len;
+            job_await(JOB_WAIT_TX, DB_DONE, ufi_iec_untalk_begin());
+            return 1;
+
+        case DB_DONE:
+            if (g_job.pos != 256) break;
+            out[1] = 1;
+            return disk_block_next();
+
+        case DB_STATUS:
+            // Fehlercode vom Befehlskanal (TALK 15)
+            job_await(JOB_WAIT_TX, DB_STATUS_RX, ufi_iec_talk_sa_begin(g_job.device, 15));
+            return 1;
+
+        case DB_STATUS_RX:
+            if (ret != UFI_OK) {
+                out[1] = 0x0F;      // Laufwerk antwortet nicht
+                return disk_block_next();
+            }
+            g_job.rx_len = 0;
+            job_await(JOB_WAIT_RX, DB_STATUS_UNTALK,
+                      ufi_iec_rx_start((uint8_t*)g_job.status, sizeof(g_job.status)));
+            return 1;
+
+        case DB_STATUS_UNTALK:
+            out[1] = disk_status_code(g_job.status, g_job.rx_len);
+            job_await(JOB_WAIT_TX, DB_STATUS_DONE, ufi_iec_untalk_begin());
+            return 1;
+
+        case DB_STATUS_DONE:
+            return disk_block_next();
+
+        default:
+            return UFI_ERR_BUSY;
+    }
+
+    // Block nicht lesbar: Rest nullen, Status vom Laufwerk holen
+    memset(&out[2 + g_job.pos], 0, 256 - g_job.pos);
+    job_await(JOB_WAIT_NONE, DB_STATUS, UFI_OK);
+    return 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * Laufwerk-Speicher: M-W in MW_CHUNK-Stücken, M-E
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Nächstes M-W Stück starten (Quelle, Adresse, Länge aus g_job)
+ * @return false = alle Bytes geschrieben
+ */
+static bool job_mw_next(iec_job_step_t step) {
+    if (g_job.pos >= g_job.count) {
+        return false;
+    }
+
+    uint32_t left = g_job.count - g_job.pos;
+    uint8_t n = (left > MW_CHUNK) ? MW_CHUNK : (uint8_t)left;
+    char cmd[6 + MW_CHUNK];
+    uint8_t len = mw_command(cmd, (uint16_t)(g_job.addr + g_job.pos), &g_job.data[g_job.pos], n);
+
+    g_job.pos += n;
+    job_await(JOB_WAIT_CMD, step, ufi_iec_command_begin(g_job.device, cmd, len));
+    return true;
+}
+
+/**
+ * Daten in den Laufwerk-RAM schreiben
+ * data muss bis zum Job-Ende gültig bleiben, Fortschritt mit ufi_iec_job_poll().
+ */
+int ufi_iec_mem_write_begin(uint8_t device, uint16_t addr, const uint8_t* data, uint32_t len) {
+    if (g_job.step != JOB_IDLE) {
+        return UFI_ERR_BUSY;
+    }
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.device = device;
+    g_job.addr = addr;
+    g_job.data = data;
+    g_job.count = len;
+
+    return job_start(MW_DATA, JOB_WAIT_NONE, UFI_OK);
+}
+
+/**
+ * Code im Laufwerk starten
+ * Fortschritt mit ufi_iec_job_poll().
+ */
+int ufi_iec_mem_exec_begin(uint8_t device, uint16_t addr) {
+    char cmd[5] = { 'M', '-', 'E', (char)(addr & 0xFF), (char)(addr >> 8) };
+
+    if (g_job.step != JOB_IDLE) {
+        return UFI_ERR_BUSY;
+    }
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.device = device;
+
+    return job_start(ME_DONE, JOB_WAIT_CMD, ufi_iec_command_begin(device, cmd, sizeof(cmd)));
+}
+
+/* ----------------------------------------------------------------------------
+ * Disk vorbereiten
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Disk-Lesen vorbereiten: Initialize, Drive-Code hochladen bzw.
+ * Block-Kanal öffnen (1581)
+ * Fortschritt mit ufi_iec_job_poll().
+ */
+int ufi_iec_disk_begin(uint8_t device, iec_disk_type_t type) {
+    if (g_job.step != JOB_IDLE) {
+        return UFI_ERR_BUSY;
+    }
+    if (type != IEC_DISK_D64 && type != IEC_DISK_D71 && type != IEC_DISK_D81) {
+        return UFI_ERR_NOT_IMPL;
+    }
+
+    g_disk_type = IEC_DISK_NONE;
+    g_disk_device = device;
+    g_disk_side = 0;
+
+    memset(&g_job, 0, sizeof(g_job));
+    g_job.device = device;
+    g_job.type = type;
+    g_job.addr = DISK_CODE_ADDR;
+    g_job.data = disk_reader_code;
+    g_job.count = sizeof(disk_reader_code);
+
+    return job_start(DI_CODE, JOB_WAIT_CMD, ufi_iec_command_begin(device, "I0", 2));
+}
+
+static int disk_mem_step(int ret) {
+    switch (g_job.step) {
+        case MW_DATA:
+            if (ret != UFI_OK) return ret;
+            return job_mw_next(MW_DATA) ? 1 : UFI_OK;
+
+        case ME_DONE:
+            return ret;
+
+        case DI_CODE:
+            if (ret != UFI_OK) return ret;
+
+            if (g_job.type == IEC_DISK_D81) {
+                // 1581 läuft mit 2 MHz: Standard-Protokoll über Kanal 2 ("#")
+                job_await(JOB_WAIT_TX, DI_NAME, ufi_iec_open_begin(g_job.device, 2));
+                return 1;
+            }
+            if (job_mw_next(DI_CODE)) {
+                return 1;
+            }
+            if (g_job.type == IEC_DISK_D71) {
+                job_await(JOB_WAIT_CMD, DI_DONE, ufi_iec_command_begin(g_job.device, "U0>H0", 5));
+                return 1;
+            }
+            g_disk_type = g_job.type;
+            return UFI_OK;
+
+        case DI_NAME:
+            // Kein Gerät: nichts zu schließen
+            if (ret != UFI_OK) return ret;
+            job_await(JOB_WAIT_TX, DI_UNLISTEN,
+                      ufi_iec_tx_start((const uint8_t*)"#", 1, IEC_TX_EOI));
+            return 1;
+
+        case DI_UNLISTEN:
+            g_job.ret = ret;
+            job_await(JOB_WAIT_TX, DI_DONE, ufi_iec_unlisten_begin());
+            return 1;
+
+        case DI_DONE:
+            if (ret == UFI_OK) ret = g_job.ret;
+            if (ret == UFI_OK) {
+                g_disk_type = g_job.type;
+            }
+            return ret;
+
+        default:
+            return UFI_ERR_BUSY;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Job-Fortschritt
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Laufenden Job einen Schritt weiterführen (aus task_iec)
+ * @param len  Bisher fertige Bytes im Puffer
+ * @return 1 = läuft, sonst UFI_OK / Fehlercode
+ */
+int ufi_iec_job_poll(uint32_t* len) {
+    int ret = UFI_OK;
+
+    if (g_job.step != JOB_IDLE) {
+        ret = job_pending();
+        if (ret != 1) {
+            if (g_job.step >= MW_DATA && g_job.step < JOB_END) {
+                ret = disk_mem_step(ret);
+            } else if (g_job.step >= DB_POINTER && g_job.step < MW_DATA) {
+                ret = disk_block_step(ret);
+            } else if (g_job.step >= DT_PARAM && g_job.step < DB_POINTER) {
+                ret = disk_code_step(ret);
+            } else if (g_job.step == FR_BYTES) {
+                ret = fast_recv_step();
+            } else {
+                ret = fast_load_step(ret);
+            }
+            if (ret != 1) {
+                g_job.step = JOB_IDLE;
+            }
+        }
+    }
+
+    *len = g_job.len;
+    return ret;
+}
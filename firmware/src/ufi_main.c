@@ -12,8 +12,10 @@
  * ============================================================================ */
 
 capture_context_t g_capture;
-static drive_status_t g_drive_status[5];  // Max 5 Laufwerke
-static drive_type_t g_active_drive = DRIVE_NONE;
+
+// Timer + DMA Handles (ufi_flux.c)
+extern TIM_HandleTypeDef htim2;
+extern DMA_HandleTypeDef hdma_tim2;
 
 // DMA Buffer für Flux-Capture (im DTCM für schnellen Zugriff)
 __attribute__((section(".dtcm")))
@@ -83,14 +85,15 @@ void ufi_init(void) {
     ufi_gpio_init();
     ufi_flux_init();   // Timer + DMA (in ufi_flux.c mit globalen Handles)
     ufi_write_init();  // Write-Support initialisieren
+    ufi_drive_events_init();  // EXTI für DKCHG/READY/WPROT
     ufi_usb_init();
+    ufi_telemetry_init();
     
     // Capture Buffer zuweisen
     g_capture.buffer = g_revolution_buffer;
     
     // Status initialisieren
     g_capture.state = CAPTURE_IDLE;
-    g_active_drive = DRIVE_NONE;
     
     // LEDs: Power an
     HAL_GPIO_WritePin(PIN_LED_PWR.port, PIN_LED_PWR.pin, GPIO_PIN_SET);
@@ -174,18 +177,15 @@ int ufi_capture_start(uint8_t track, uint8_t side, uint8_t revolutions) {
         return -1;  // Bereits aktiv
     }
     
-    if (g_active_drive == DRIVE_NONE) {
+    if (ufi_drive_get_current() == DRIVE_NONE) {
         return -2;  // Kein Laufwerk aktiv
     }
     
-    // Zum Track fahren
-    if (ufi_drive_seek(track) != 0) {
+    // Zum Track fahren (nicht-blockierend, weiter in task_capture)
+    if (ufi_drive_seek_begin(track) != 0) {
         return -3;
     }
     
-    // Seite wählen
-    ufi_drive_select_side(side);
-    
     // Capture konfigurieren
     g_capture.current_track = track;
     g_capture.current_side = side;
@@ -193,19 +193,7 @@ int ufi_capture_start(uint8_t track, uint8_t side, uint8_t revolutions) {
     g_capture.revolutions_captured = 0;
     g_capture.buffer = g_revolution_buffer;
     g_capture.error_code = 0;
-    
-    // DMA konfigurieren
-    HAL_DMA_Start(DMA1_Stream0, 
-                  (uint32_t)&TIM2->CCR1, 
-                  (uint32_t)g_flux_dma_buffer, 
-                  MAX_FLUX_PER_REV);
-    
-    // Timer starten
-    __HAL_TIM_SET_COUNTER(TIM2, 0);
-    HAL_TIM_IC_Start_DMA(TIM2, TIM_CHANNEL_1, g_flux_dma_buffer, MAX_FLUX_PER_REV);
-    
-    // Warte auf Index-Puls
-    g_capture.state = CAPTURE_WAITING_INDEX;
+    g_capture.state = CAPTURE_SEEKING;
     
     // LED an
     HAL_GPIO_WritePin(PIN_LED_FDD.port, PIN_LED_FDD.pin, GPIO_PIN_SET);
@@ -213,292 +201,57 @@ int ufi_capture_start(uint8_t track, uint8_t side, uint8_t revolutions) {
     return 0;
 }
 
-int ufi_capture_abort(void) {
-    HAL_TIM_IC_Stop_DMA(TIM2, TIM_CHANNEL_1);
-    HAL_DMA_Abort(DMA1_Stream0);
-    
-    g_capture.state = CAPTURE_IDLE;
-    
-    HAL_GPIO_WritePin(PIN_LED_FDD.port, PIN_LED_FDD.pin, GPIO_PIN_RESET);
-    
-    return 0;
-}
-
-/* ============================================================================
- * LAUFWERK-STEUERUNG
- * ============================================================================ */
+static uint8_t g_capture_tx_rev = 0;    // Nächste zu sendende Revolution
 
-int ufi_drive_select(drive_type_t type) {
-    // Alle Drives deselektieren
-    HAL_GPIO_WritePin(PIN_FDD_DRV_SEL_A.port, PIN_FDD_DRV_SEL_A.pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(PIN_FDD_DRV_SEL_B.port, PIN_FDD_DRV_SEL_B.pin, GPIO_PIN_SET);
-    
-    switch (type) {
-        case DRIVE_SHUGART_A:
-            HAL_GPIO_WritePin(PIN_FDD_DRV_SEL_A.port, PIN_FDD_DRV_SEL_A.pin, GPIO_PIN_RESET);
-            break;
-        case DRIVE_SHUGART_B:
-            HAL_GPIO_WritePin(PIN_FDD_DRV_SEL_B.port, PIN_FDD_DRV_SEL_B.pin, GPIO_PIN_RESET);
-            break;
-        case DRIVE_APPLE_II:
-        case DRIVE_AMIGA:
-            // TODO: Spezifische Select-Logik
-            break;
-        case DRIVE_IEC:
-            // IEC braucht kein Drive-Select
-            break;
-        default:
-            g_active_drive = DRIVE_NONE;
-            return -1;
-    }
-    
-    g_active_drive = type;
-    HAL_Delay(10);  // Settle time
-    
-    return 0;
-}
-
-int ufi_drive_motor(bool on) {
-    gpio_pin_t motor_pin;
-    
-    switch (g_active_drive) {
-        case DRIVE_SHUGART_A:
-            motor_pin = PIN_FDD_MOTOR_A;
-            break;
-        case DRIVE_SHUGART_B:
-            motor_pin = PIN_FDD_MOTOR_B;
-            break;
-        default:
-            return -1;
-    }
+/**
+ * Kopf steht: Seite wählen, DMA + Timer scharf schalten
+ */
+static void capture_arm(void) {
+    g_capture_tx_rev = 0;
     
-    HAL_GPIO_WritePin(motor_pin.port, motor_pin.pin, on ? GPIO_PIN_RESET : GPIO_PIN_SET);
-    g_drive_status[g_active_drive].motor_on = on;
+    // Seite wählen
+    ufi_drive_select_side(g_capture.current_side);
     
-    if (on) {
-        HAL_Delay(500);  // Motor Spin-up Zeit
-    }
+    // Timer + DMA starten (TIM2 CCR1 → g_flux_dma_buffer)
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
+    HAL_TIM_IC_Start_DMA(&htim2, TIM_CHANNEL_1, g_flux_dma_buffer, MAX_FLUX_PER_REV);
     
-    return 0;
-}
-
-int ufi_drive_step(int direction) {
-    // Direction setzen
-    HAL_GPIO_WritePin(PIN_FDD_DIR.port, PIN_FDD_DIR.pin, 
-                      (direction > 0) ? GPIO_PIN_RESET : GPIO_PIN_SET);
-    HAL_Delay(1);  // Setup time
-    
-    // Step-Puls (3µs minimum)
-    HAL_GPIO_WritePin(PIN_FDD_STEP.port, PIN_FDD_STEP.pin, GPIO_PIN_RESET);
-    for (volatile int i = 0; i < 100; i++);  // ~3µs @ 550MHz
-    HAL_GPIO_WritePin(PIN_FDD_STEP.port, PIN_FDD_STEP.pin, GPIO_PIN_SET);
-    
-    // Step Rate: 3ms
-    HAL_Delay(3);
-    
-    // Track-Counter aktualisieren
-    if (direction > 0) {
-        g_drive_status[g_active_drive].current_track++;
-    } else if (g_drive_status[g_active_drive].current_track > 0) {
-        g_drive_status[g_active_drive].current_track--;
-    }
+    // Warte auf Index-Puls
+    g_capture.state = CAPTURE_WAITING_INDEX;
     
-    return 0;
+    UFI_TRACE_MARK(TRACE_ID_CAPTURE_ARM, g_capture.current_track);
 }
 
-int ufi_drive_seek(uint8_t track) {
-    drive_status_t* status = &g_drive_status[g_active_drive];
-    
-    // Zuerst recalibrate wenn Position unbekannt
-    if (!status->track0 && status->current_track == 0) {
-        ufi_drive_recalibrate();
-    }
-    
-    // Steps berechnen
-    int steps = (int)track - (int)status->current_track;
-    int direction = (steps > 0) ? 1 : -1;
-    steps = (steps > 0) ? steps : -steps;
+int ufi_capture_abort(void) {
+    HAL_TIM_IC_Stop_DMA(&htim2, TIM_CHANNEL_1);
+    HAL_DMA_Abort(&hdma_tim2);
     
-    // Steppen
-    for (int i = 0; i < steps; i++) {
-        ufi_drive_step(direction);
-    }
+    g_capture.state = CAPTURE_IDLE;
     
-    // Head Settle Time
-    HAL_Delay(15);
+    HAL_GPIO_WritePin(PIN_LED_FDD.port, PIN_LED_FDD.pin, GPIO_PIN_RESET);
     
     return 0;
 }
 
-int ufi_drive_recalibrate(void) {
-    // Bis Track 0 steppen (max 85 Steps)
-    for (int i = 0; i < 85; i++) {
-        // Track0 Signal prüfen
-        if (HAL_GPIO_ReadPin(PIN_FDD_TRACK0.port, PIN_FDD_TRACK0.pin) == GPIO_PIN_RESET) {
-            g_drive_status[g_active_drive].current_track = 0;
-            g_drive_status[g_active_drive].track0 = true;
-            HAL_Delay(15);  // Settle
-            return 0;
-        }
-        ufi_drive_step(-1);  // Step out
+/**
+ * Seek-Fortschritt: Kopf steht → DMA scharf schalten
+ * (task_capture und blockierende Aufrufer wie ufi_write_verify)
+ */
+void ufi_capture_poll(void) {
+    if (g_capture.state == CAPTURE_SEEKING && ufi_drive_seek_poll() == 0) {
+        capture_arm();
     }
-    
-    return -1;  // Track 0 nicht gefunden
-}
-
-int ufi_drive_select_side(uint8_t side) {
-    HAL_GPIO_WritePin(PIN_FDD_SIDE_SEL.port, PIN_FDD_SIDE_SEL.pin, 
-                      (side == 0) ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    g_drive_status[g_active_drive].current_side = side;
-    HAL_Delay(1);  // Settle
-    return 0;
-}
-
-drive_status_t ufi_drive_get_status(void) {
-    drive_status_t* status = &g_drive_status[g_active_drive];
-    
-    // Aktuelle Signale lesen
-    status->track0 = (HAL_GPIO_ReadPin(PIN_FDD_TRACK0.port, PIN_FDD_TRACK0.pin) == GPIO_PIN_RESET);
-    status->write_protected = (HAL_GPIO_ReadPin(PIN_FDD_WPROT.port, PIN_FDD_WPROT.pin) == GPIO_PIN_RESET);
-    status->disk_changed = (HAL_GPIO_ReadPin(PIN_FDD_DKCHG.port, PIN_FDD_DKCHG.pin) == GPIO_PIN_RESET);
-    
-    return *status;
-}
-
-/* ============================================================================
- * IEC BUS (C64)
- * ============================================================================ */
-
-// IEC Timing (µs)
-#define IEC_T_NE    40      // Non-EOI Response
-#define IEC_T_S     70      // Send
-#define IEC_T_R     20      // Release
-
-static void iec_delay_us(uint32_t us) {
-    // Präzise Verzögerung mit DWT Cycle Counter
-    uint32_t start = DWT->CYCCNT;
-    uint32_t cycles = us * (SYSCLK_FREQ / 1000000);
-    while ((DWT->CYCCNT - start) < cycles);
-}
-
-static void iec_clk(bool low) {
-    HAL_GPIO_WritePin(PIN_IEC_CLK.port, PIN_IEC_CLK.pin, low ? GPIO_PIN_RESET : GPIO_PIN_SET);
-}
-
-static void iec_data(bool low) {
-    HAL_GPIO_WritePin(PIN_IEC_DATA.port, PIN_IEC_DATA.pin, low ? GPIO_PIN_RESET : GPIO_PIN_SET);
-}
-
-static bool iec_read_clk(void) {
-    return HAL_GPIO_ReadPin(PIN_IEC_CLK.port, PIN_IEC_CLK.pin) == GPIO_PIN_RESET;
-}
-
-static bool iec_read_data(void) {
-    return HAL_GPIO_ReadPin(PIN_IEC_DATA.port, PIN_IEC_DATA.pin) == GPIO_PIN_RESET;
-}
-
-int ufi_iec_reset(void) {
-    HAL_GPIO_WritePin(PIN_IEC_RESET.port, PIN_IEC_RESET.pin, GPIO_PIN_RESET);
-    HAL_Delay(20);
-    HAL_GPIO_WritePin(PIN_IEC_RESET.port, PIN_IEC_RESET.pin, GPIO_PIN_SET);
-    HAL_Delay(500);  // 1541 Boot-Zeit
-    return 0;
-}
-
-int ufi_iec_atn(bool state) {
-    HAL_GPIO_WritePin(PIN_IEC_ATN.port, PIN_IEC_ATN.pin, state ? GPIO_PIN_RESET : GPIO_PIN_SET);
-    return 0;
 }
 
-int ufi_iec_send_byte(uint8_t byte, bool eoi) {
-    uint32_t timeout_start;
-    
-    // Listener bereit?
-    if (!iec_read_data()) {
-        return UFI_ERR_IEC_NRFD;
-    }
-    
-    // EOI Handshake
-    if (eoi) {
-        iec_delay_us(200);
-        
-        // ⚠️ FIX #2: Timeout statt Endlosschleife!
-        // Warte auf Listener EOI-ACK (DATA high)
-        timeout_start = DWT->CYCCNT;
-        while (!iec_read_data()) {
-            if ((DWT->CYCCNT - timeout_start) > IEC_TIMEOUT_CYCLES)
-                return UFI_ERR_TIMEOUT;
-        }
-        // Warte auf DATA low
-        timeout_start = DWT->CYCCNT;
-        while (iec_read_data()) {
-            if ((DWT->CYCCNT - timeout_start) > IEC_TIMEOUT_CYCLES)
-                return UFI_ERR_TIMEOUT;
-        }
-    }
-    
-    // 8 Bits senden
-    for (int i = 0; i < 8; i++) {
-        iec_clk(true);
-        iec_data((byte & (1 << i)) == 0);  // Inverted!
-        iec_delay_us(IEC_T_S);
-        iec_clk(false);
-        iec_delay_us(IEC_T_R);
-    }
-    
-    iec_data(false);  // Release
-    
-    // Warte auf ACK
-    iec_delay_us(1000);
-    if (iec_read_data()) {
-        return UFI_ERR_IEC_NOACK;
-    }
-    
-    return UFI_OK;
+capture_state_t ufi_capture_get_state(void) {
+    return g_capture.state;
 }
 
-int ufi_iec_receive_byte(uint8_t* byte) {
-    uint32_t timeout_start;
-    *byte = 0;
-    
-    // Ready to receive
-    iec_data(false);
-    
-    // ⚠️ FIX #2: Timeout statt Endlosschleife!
-    // Warte auf Talker (CLK high)
-    timeout_start = DWT->CYCCNT;
-    while (!iec_read_clk()) {
-        if ((DWT->CYCCNT - timeout_start) > IEC_TIMEOUT_CYCLES)
-            return UFI_ERR_TIMEOUT;
+flux_revolution_t* ufi_capture_get_data(uint8_t revolution) {
+    if (revolution >= g_capture.revolutions_captured) {
+        return NULL;
     }
-    
-    // 8 Bits empfangen
-    for (int i = 0; i < 8; i++) {
-        // Warte CLK low
-        timeout_start = DWT->CYCCNT;
-        while (iec_read_clk()) {
-            if ((DWT->CYCCNT - timeout_start) > IEC_TIMEOUT_CYCLES)
-                return UFI_ERR_TIMEOUT;
-        }
-        
-        if (iec_read_data()) {
-            *byte |= (1 << i);
-        }
-        
-        // Warte CLK high
-        timeout_start = DWT->CYCCNT;
-        while (!iec_read_clk()) {
-            if ((DWT->CYCCNT - timeout_start) > IEC_TIMEOUT_CYCLES)
-                return UFI_ERR_TIMEOUT;
-        }
-    }
-    
-    // ACK senden
-    iec_data(true);
-    iec_delay_us(IEC_T_NE);
-    iec_data(false);
-    
-    return UFI_OK;
+    return &g_capture.buffer[revolution];
 }
 
 /* ============================================================================
@@ -507,7 +260,7 @@ int ufi_iec_receive_byte(uint8_t* byte) {
 
 void ufi_flux_index_handler(void) {
     // Index-Puls erkannt!
-    uint32_t index_time = __HAL_TIM_GET_COUNTER(TIM2);
+    uint32_t index_time = __HAL_TIM_GET_COUNTER(&htim2);
     
     // Write-Modus?
     write_state_t ws = ufi_write_get_state();
@@ -518,16 +271,22 @@ void ufi_flux_index_handler(void) {
     
     // Read-Modus
     if (g_capture.state == CAPTURE_WAITING_INDEX) {
-        // Capture starten
-        __HAL_TIM_SET_COUNTER(TIM2, 0);
+        // Capture starten: DMA läuft seit capture_arm und hat Flanken
+        // vor dem Index gesammelt - verwerfen, Umdrehung 0 beginnt hier
+        HAL_DMA_Abort(&hdma_tim2);
+        __HAL_TIM_SET_COUNTER(&htim2, 0);
+        HAL_DMA_Start(&hdma_tim2,
+                      (uint32_t)&TIM2->CCR1,
+                      (uint32_t)g_flux_dma_buffer,
+                      MAX_FLUX_PER_REV);
         g_capture.state = CAPTURE_RUNNING;
     }
     else if (g_capture.state == CAPTURE_RUNNING) {
         // ⚠️ FIX #1: DMA ERST STOPPEN vor memcpy!
-        HAL_DMA_Abort(DMA1_Stream0);
+        HAL_DMA_Abort(&hdma_tim2);
         
         // Jetzt sicher Position lesen
-        uint32_t dma_pos = MAX_FLUX_PER_REV - __HAL_DMA_GET_COUNTER(DMA1_Stream0);
+        uint32_t dma_pos = MAX_FLUX_PER_REV - __HAL_DMA_GET_COUNTER(&hdma_tim2);
         
         // Daten in Revolution-Buffer kopieren (jetzt sicher!)
         flux_revolution_t* rev = &g_capture.buffer[g_capture.revolutions_captured];
@@ -536,17 +295,25 @@ void ufi_flux_index_handler(void) {
         rev->revolution = g_capture.revolutions_captured;
         memcpy(rev->samples, g_flux_dma_buffer, dma_pos * sizeof(uint32_t));
         
+        // DMA bis zum Ende gelaufen: Rest der Umdrehung verloren
+        if (dma_pos >= MAX_FLUX_PER_REV) {
+            UFI_TELEM_INC(flux_overruns);
+        }
+        UFI_TELEM_INC(revolutions);
+        
         g_capture.revolutions_captured++;
         
         // Mehr Revolutions nötig?
         if (g_capture.revolutions_captured >= g_capture.revolutions_requested) {
             g_capture.state = CAPTURE_COMPLETE;
+            // Kanal freigeben, sonst schlägt das nächste Start_DMA fehl (BUSY)
+            HAL_TIM_IC_Stop_DMA(&htim2, TIM_CHANNEL_1);
             HAL_GPIO_WritePin(PIN_LED_FDD.port, PIN_LED_FDD.pin, GPIO_PIN_RESET);
         } else {
             // Nächste Revolution, Timer Reset
-            __HAL_TIM_SET_COUNTER(TIM2, 0);
+            __HAL_TIM_SET_COUNTER(&htim2, 0);
             // DMA neu starten für nächste Revolution
-            HAL_DMA_Start(DMA1_Stream0, 
+            HAL_DMA_Start(&hdma_tim2, 
                           (uint32_t)&TIM2->CCR1, 
                           (uint32_t)g_flux_dma_buffer, 
                           MAX_FLUX_PER_REV);
@@ -555,63 +322,162 @@ void ufi_flux_index_handler(void) {
 }
 
 /* ============================================================================
- * HAUPTSCHLEIFE
- * ============================================================================ */
+ * KOOPERATIVER SCHEDULER
+ * ============================================================================
+ * Jede Task ist eine nicht-blockierende State Machine und kehrt sofort
+ * zurück. IEC (GPIOD + TIM7) und Flux (TIM2/DMA) laufen so parallel.
+ */
 
-void ufi_main_loop(void) {
-    static uint32_t last_blink = 0;
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    bool latency;           // Zusätzlich zwischen allen anderen Tasks
+    uint32_t runs;
+    uint32_t max_cycles;    // Längster Durchlauf (DWT)
+} ufi_task_t;
+
+static void task_usb(void) {
+    // USB Befehle verarbeiten
+    ufi_usb_process_command();
     
-    while (1) {
-        // Watchdog füttern (Fix #9)
-        UFI_WATCHDOG_FEED();
-        
-        // USB Befehle verarbeiten
-        ufi_usb_process_command();
-        
-        // Write-Prozess (wenn aktiv)
-        ufi_write_process();
-        
-        // Capture-Daten senden wenn fertig
-        if (g_capture.state == CAPTURE_COMPLETE) {
-            // Alle Revolutions an CM5 senden
-            for (int i = 0; i < g_capture.revolutions_captured; i++) {
-                flux_packet_header_t header = {
-                    .track = g_capture.current_track,
-                    .side = g_capture.current_side,
-                    .revolution = i,
-                    .flags = 0x01,  // Index gefunden
-                    .index_time = g_capture.buffer[i].index_time,
-                    .sample_count = g_capture.buffer[i].count
-                };
-                ufi_usb_send_flux(&header, g_capture.buffer[i].samples);
-            }
+    // Gepufferte Daten (Flux, Events) weitersenden
+    ufi_usb_flush();
+}
+
+static void task_iec(void) {
+    // Fertige IEC-Jobs (LOAD, RECV_BUF) beantworten
+    ufi_usb_iec_poll();
+}
+
+static void task_capture(void) {
+    switch (g_capture.state) {
+        case CAPTURE_SEEKING:
+            ufi_capture_poll();
+            break;
             
-            g_capture.state = CAPTURE_IDLE;
+        case CAPTURE_COMPLETE: {
+            // Eine Revolution pro Durchlauf an CM5, bei vollem Puffer später erneut
+            uint8_t i = g_capture_tx_rev;
+            flux_packet_header_t header = {
+                .track = g_capture.current_track,
+                .side = g_capture.current_side,
+                .revolution = i,
+                .flags = 0x01,  // Index gefunden
+                .index_time = g_capture.buffer[i].index_time,
+                .sample_count = g_capture.buffer[i].count
+            };
+            if (ufi_usb_send_flux(&header, g_capture.buffer[i].samples) == UFI_OK) {
+                UFI_TRACE_MARK(TRACE_ID_CAPTURE_DONE, i);
+                g_capture_tx_rev++;
+            }
+            if (g_capture_tx_rev >= g_capture.revolutions_captured) {
+                g_capture_tx_rev = 0;
+                g_capture.state = CAPTURE_IDLE;
+            }
+            break;
         }
-        
-        // Write Complete? Verify starten wenn angefordert
-        if (ufi_write_get_state() == WRITE_COMPLETE) {
-            // Automatisches Verify wenn angefordert wird im Command Handler gemacht
+            
+        default:
+            break;
+    }
+}
+
+static void task_write(void) {
+    // Write-Prozess (wenn aktiv)
+    ufi_write_process();
+}
+
+static void task_drive(void) {
+    static uint32_t last_blink = 0;
+    
+    // Laufwerk-Signale (Disk-Wechsel etc.) an CM5 melden
+    ufi_drive_poll_events();
+    
+    // MOTOR_ON beantworten, sobald die Drehzahl stabil ist
+    ufi_usb_drive_poll();
+    
+    // Status-LED blinken wenn aktiv (Fix #12: mit Timer)
+    if (g_capture.state == CAPTURE_RUNNING || 
+        ufi_write_get_state() == WRITE_ACTIVE) {
+        uint32_t now = HAL_GetTick();
+        if (now - last_blink > 100) {
+            HAL_GPIO_TogglePin(PIN_LED_ACT.port, PIN_LED_ACT.pin);
+            last_blink = now;
         }
+    }
+}
+
+static ufi_task_t g_tasks[] = {
+    { "usb",     task_usb,     false, 0, 0 },
+    { "iec",     task_iec,     false, 0, 0 },
+    { "capture", task_capture, false, 0, 0 },
+    { "write",   task_write,   true,  0, 0 },   // Flux-Timing pro Übergang
+    { "drive",   task_drive,   false, 0, 0 },
+};
+
+#define TASK_COUNT  (sizeof(g_tasks) / sizeof(g_tasks[0]))
+
+static void task_run(ufi_task_t* task) {
+    uint8_t id = TRACE_ID_TASK + (uint8_t)(task - g_tasks);
+    
+    UFI_TRACE_ENTER(id);
+    uint32_t start = DWT->CYCCNT;
+    task->run();
+    uint32_t cycles = DWT->CYCCNT - start;
+    UFI_TRACE_EXIT(id);
+    
+    task->runs++;
+    if (cycles > task->max_cycles) {
+        task->max_cycles = cycles;
+    }
+}
+
+/* ============================================================================
+ * HAUPTSCHLEIFE
+ * ============================================================================ */
+
+/**
+ * Ein Durchlauf über alle Tasks (Host-Simulation ruft dies direkt auf)
+ */
+void ufi_main_poll(void) {
+    static uint32_t loop_start = 0;
+    
+    // Watchdog füttern (Fix #9)
+    UFI_WATCHDOG_FEED();
+    UFI_TRACE_MARK(TRACE_ID_LOOP, 0);
+    
+    uint32_t now = DWT->CYCCNT;
+    if (loop_start != 0) {
+        ufi_telemetry_gauge(&g_telemetry.loop_time, now - loop_start);
+    }
+    loop_start = now;
+    
+    for (uint32_t i = 0; i < TASK_COUNT; i++) {
+        task_run(&g_tasks[i]);
         
-        // Status-LED blinken wenn aktiv (Fix #12: mit Timer)
-        if (g_capture.state == CAPTURE_RUNNING || 
-            ufi_write_get_state() == WRITE_ACTIVE) {
-            uint32_t now = HAL_GetTick();
-            if (now - last_blink > 100) {
-                HAL_GPIO_TogglePin(PIN_LED_ACT.port, PIN_LED_ACT.pin);
-                last_blink = now;
+        // Latenzkritische Tasks zwischen allen anderen
+        for (uint32_t j = 0; j < TASK_COUNT; j++) {
+            if (g_tasks[j].latency && j != i) {
+                g_tasks[j].run();
             }
         }
     }
 }
 
+void ufi_main_loop(void) {
+    while (1) {
+        ufi_main_poll();
+    }
+}
+
 /* ============================================================================
  * MAIN
  * ============================================================================ */
 
+#ifndef UFI_HOST_SIM
 int main(void) {
     ufi_init();
     ufi_main_loop();
     return 0;
 }
+#endif
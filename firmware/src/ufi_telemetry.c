@@ -0,0 +1,70 @@
+/**
+ * UFI Flux Engine - Telemetrie
+ * 
+ * Laufzeit-Zähler (DMA, Überläufe, USB, verworfene Frames) und
+ * Min/Max/Mittel-Gauges (Befehlslatenz, Schleifenzeit, TX-Füllstand).
+ * Auslesen/Nullen über UFI_CMD_GET_TELEMETRY, CM5: /api/metrics.
+ */
+
+#include "ufi_firmware.h"
+#include "stm32h7xx_hal.h"
+#include <string.h>
+
+/* ============================================================================
+ * ZÄHLER
+ * ============================================================================ */
+
+ufi_telemetry_t g_telemetry;
+
+static uint32_t telemetry_reset_tick = 0;
+
+static void gauge_clear(telemetry_gauge_t* gauge) {
+    memset(gauge, 0, sizeof(*gauge));
+    gauge->min = UINT32_MAX;
+}
+
+void ufi_telemetry_init(void) {
+    ufi_telemetry_reset();
+}
+
+/**
+ * Alle Zähler nullen
+ * Inkremente aus ISRs während des Nullens gehen höchstens einzeln verloren.
+ */
+void ufi_telemetry_reset(void) {
+    memset(&g_telemetry, 0, sizeof(g_telemetry));
+    gauge_clear(&g_telemetry.cmd_latency);
+    gauge_clear(&g_telemetry.loop_time);
+    gauge_clear(&g_telemetry.usb_tx_fill);
+    telemetry_reset_tick = HAL_GetTick();
+}
+
+/**
+ * Messwert in Gauge aufnehmen (nur aus der Hauptschleife)
+ */
+void ufi_telemetry_gauge(telemetry_gauge_t* gauge, uint32_t value) {
+    gauge->count++;
+    gauge->sum += value;
+    gauge->last = value;
+    if (value < gauge->min) gauge->min = value;
+    if (value > gauge->max) gauge->max = value;
+}
+
+/**
+ * Konsistente Kopie für den Host (Kopf-Felder ausgefüllt)
+ */
+void ufi_telemetry_snapshot(ufi_telemetry_t* out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &g_telemetry, sizeof(*out));
+    __set_PRIMASK(primask);
+    
+    uint32_t now = HAL_GetTick();
+    out->size = sizeof(ufi_telemetry_t);
+    out->version = TELEMETRY_VERSION;
+    out->cpu_hz = SystemCoreClock;
+    out->uptime_ms = now;
+    out->since_reset_ms = now - telemetry_reset_tick;
+    
+    ufi_drive_rpm_monitor(&out->rpm);
+}
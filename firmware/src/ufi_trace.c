@@ -0,0 +1,92 @@
+/**
+ * UFI Flux Engine - ISR / Main-Loop Trace
+ * 
+ * Ring-Puffer mit DWT-Zeitstempeln bei Eintritt/Austritt der ISRs und
+ * an Meilensteinen der Hauptschleife. Auslesen über UFI_CMD_DEBUG_TIMER,
+ * Umwandlung in Chrome Trace JSON mit software/tools/ufi-trace.
+ */
+
+#include "ufi_firmware.h"
+#include "stm32h7xx_hal.h"
+#include <string.h>
+
+/* ============================================================================
+ * TRACE RING
+ * ============================================================================ */
+
+volatile bool g_trace_enabled = false;
+
+static trace_entry_t trace_ring[TRACE_RING_SIZE];
+static volatile uint32_t trace_head = 0;    // Nächster Slot (läuft frei)
+
+/**
+ * Eintrag aufzeichnen (aus ISRs aller Prioritäten)
+ * Slot-Reservierung mit LDREX/STREX, kein Sperren der Interrupts.
+ * Zeitstempel erst nach der Reservierung: ein verdrängender ISR liegt dann
+ * höchstens um seine eigene Laufzeit vor dem unterbrochenen Eintrag
+ * (ufi-trace rechnet mit vorzeichenbehafteten Deltas).
+ */
+void ufi_trace_record(uint8_t id, uint8_t type, uint16_t arg) {
+    uint32_t slot;
+    
+    do {
+        slot = __LDREXW(&trace_head);
+    } while (__STREXW(slot + 1, &trace_head) != 0);
+    
+    trace_entry_t* e = &trace_ring[slot & (TRACE_RING_SIZE - 1)];
+    e->cycles = DWT->CYCCNT;
+    e->id = id;
+    e->type = type;
+    e->arg = arg;
+}
+
+void ufi_trace_enable(bool enable) {
+    if (enable) {
+        // DWT Zähler sicher aktiv
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    g_trace_enabled = enable;
+}
+
+void ufi_trace_clear(void) {
+    bool was = g_trace_enabled;
+    g_trace_enabled = false;
+    trace_head = 0;
+    g_trace_enabled = was;
+}
+
+/**
+ * Ring auslesen: Header + Einträge (älteste zuerst)
+ * Aufzeichnung ist währenddessen angehalten.
+ * @return Anzahl Bytes in out
+ */
+uint32_t ufi_trace_dump(uint8_t* out, uint32_t max_len) {
+    bool was = g_trace_enabled;
+    g_trace_enabled = false;
+    
+    uint32_t head = trace_head;
+    uint32_t count = (head < TRACE_RING_SIZE) ? head : TRACE_RING_SIZE;
+    uint32_t fit = (max_len - sizeof(trace_dump_header_t)) / sizeof(trace_entry_t);
+    if (count > fit) {
+        count = fit;
+    }
+    
+    trace_dump_header_t hdr = {
+        .cpu_hz = SystemCoreClock,
+        .total = head,
+        .count = (uint16_t)count,
+        .entry_size = sizeof(trace_entry_t)
+    };
+    memcpy(out, &hdr, sizeof(hdr));
+    
+    trace_entry_t* dst = (trace_entry_t*)(out + sizeof(hdr));
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = head - count + i;
+        memcpy(&dst[i], &trace_ring[slot & (TRACE_RING_SIZE - 1)], sizeof(trace_entry_t));
+    }
+    
+    g_trace_enabled = was;
+    
+    return sizeof(hdr) + count * sizeof(trace_entry_t);
+}
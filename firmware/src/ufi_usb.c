@@ -65,9 +65,24 @@ static inline void usb_wait_tx_complete(void) {
 static volatile uint32_t usb_tx_head = 0;
 static volatile uint32_t usb_tx_tail = 0;
 
-// Command Buffer
-static uint8_t cmd_buffer[64];
+// Command Buffer (ein voller HS-Bulk-Frame, z.B. für IEC_SEND_BUF)
+static uint8_t cmd_buffer[USB_BULK_EP_SIZE];
+
+// IEC Transfer-Puffer (LOAD / RECV_BUF)
+__attribute__((section(".axi_sram")))
+static uint8_t iec_xfer_buffer[IEC_XFER_BUFFER_SIZE];
 static volatile uint8_t cmd_ready = 0;
+static uint32_t cmd_rx_cycles = 0;     // DWT beim Empfang (Befehlslatenz)
+
+// Laufender IEC-Job (LOAD / RECV_BUF / Fast-Jobs), Antwort folgt aus ufi_usb_iec_poll
+static uint8_t iec_pending_cmd = 0;
+
+// MOTOR_ON wartet auf Spin-up, Antwort folgt aus ufi_usb_drive_poll
+static bool motor_pending = false;
+
+// Trace-Dump (Header + ganzer Ring)
+__attribute__((section(".axi_sram")))
+static uint8_t trace_dump_buffer[sizeof(trace_dump_header_t) + TRACE_RING_SIZE * sizeof(trace_entry_t)];
 
 /* ============================================================================
  * USB INITIALISIERUNG
@@ -113,7 +128,12 @@ void ufi_usb_receive_callback(uint8_t* buf, uint32_t len) {
     // Befehl in Command-Buffer kopieren
     if (len <= sizeof(cmd_buffer)) {
         memcpy(cmd_buffer, buf, len);
+        // Fehlende optionale Parameter = 0, nicht Reste des Vorgängers
+        memset(cmd_buffer + len, 0, sizeof(cmd_buffer) - len);
+        cmd_rx_cycles = DWT->CYCCNT;
         cmd_ready = 1;
+    } else {
+        UFI_TELEM_INC(usb_rx_dropped);
     }
 }
 
@@ -121,29 +141,98 @@ void ufi_usb_receive_callback(uint8_t* buf, uint32_t len) {
  * FLUX-DATEN SENDEN
  * ============================================================================ */
 
+static void usb_tx_write(const uint8_t* data, uint32_t len);
+
+// Bereits eingereihte Bytes des laufenden Flux-Frames (0 = keiner)
+static uint32_t flux_tx_offset = 0;
+
+/**
+ * Flux-Frame (Header + Samples) in den TX-Ring stellen
+ * 
+ * Eine Umdrehung (bis 200 KB) ist größer als der Ring: der Frame wird
+ * stückweise eingereiht, so weit Platz ist. Aufrufer wiederholt mit
+ * denselben Argumenten, bis UFI_OK kommt. Bis dahin werden keine
+ * anderen Frames (Events, Antworten) dazwischen geschoben.
+ * 
+ * @return UFI_OK Frame komplett, UFI_ERR_BUSY teilweise, UFI_ERR_BUFFER_FULL kein Platz
+ */
 int ufi_usb_send_flux(flux_packet_header_t* header, flux_sample_t* data) {
     uint32_t total_size = sizeof(flux_packet_header_t) + header->sample_count * sizeof(flux_sample_t);
     
     // ⚠️ FIX #3: Korrekte Ring-Buffer Berechnung!
     uint32_t free_space = ring_buffer_free(usb_tx_head, usb_tx_tail, USB_HS_BUFFER_SIZE);
     
-    if (free_space < total_size + 4) {
+    if (free_space == 0) {
+        UFI_TELEM_INC(flux_drops);
+        ufi_usb_flush();
         return UFI_ERR_BUFFER_FULL;
     }
     
-    // Header in Buffer kopieren
-    uint8_t* ptr = usb_tx_buffer + usb_tx_head;
-    memcpy(ptr, header, sizeof(flux_packet_header_t));
-    ptr += sizeof(flux_packet_header_t);
-    
-    // Flux-Daten in Buffer kopieren
-    memcpy(ptr, data, header->sample_count * sizeof(flux_sample_t));
+    // Header (falls noch nicht eingereiht)
+    if (flux_tx_offset < sizeof(flux_packet_header_t)) {
+        uint32_t n = sizeof(flux_packet_header_t) - flux_tx_offset;
+        if (n > free_space) n = free_space;
+        usb_tx_write((const uint8_t*)header + flux_tx_offset, n);
+        flux_tx_offset += n;
+        free_space -= n;
+    }
     
-    usb_tx_head = (usb_tx_head + total_size) % USB_HS_BUFFER_SIZE;
+    // Samples
+    if (flux_tx_offset >= sizeof(flux_packet_header_t)) {
+        uint32_t n = total_size - flux_tx_offset;
+        if (n > free_space) n = free_space;
+        usb_tx_write((const uint8_t*)data + (flux_tx_offset - sizeof(flux_packet_header_t)), n);
+        flux_tx_offset += n;
+    }
     
     // Übertragung starten
     ufi_usb_flush();
     
+    if (flux_tx_offset < total_size) {
+        return UFI_ERR_BUSY;
+    }
+    
+    flux_tx_offset = 0;
+    return UFI_OK;
+}
+
+/* ============================================================================
+ * ASYNCHRONE EVENTS
+ * ============================================================================ */
+
+// In TX Ring-Buffer schreiben (mit Wrap-Around)
+static void usb_tx_write(const uint8_t* data, uint32_t len) {
+    uint32_t first = USB_HS_BUFFER_SIZE - usb_tx_head;
+    if (first > len) first = len;
+    
+    memcpy(usb_tx_buffer + usb_tx_head, data, first);
+    memcpy(usb_tx_buffer, data + first, len - first);
+    
+    usb_tx_head = (usb_tx_head + len) % USB_HS_BUFFER_SIZE;
+}
+
+/**
+ * Event-Frame in den TX-Puffer stellen
+ * Gleiches Format wie eine Antwort: Header (command = Event-ID) + Daten
+ */
+int ufi_usb_send_event(uint8_t event, const void* data, uint16_t len) {
+    ufi_response_header_t header = {
+        .command = event,
+        .status = 0,
+        .length = len
+    };
+    
+    uint32_t free_space = ring_buffer_free(usb_tx_head, usb_tx_tail, USB_HS_BUFFER_SIZE);
+    if (flux_tx_offset != 0 || free_space < sizeof(header) + len) {
+        UFI_TELEM_INC(event_drops);
+        return UFI_ERR_BUFFER_FULL;
+    }
+    
+    usb_tx_write((const uint8_t*)&header, sizeof(header));
+    usb_tx_write((const uint8_t*)data, len);
+    
+    ufi_usb_flush();
+    
     return UFI_OK;
 }
 
@@ -157,10 +246,15 @@ void ufi_usb_flush(void) {
     uint32_t timeout = HAL_GetTick() + 100;  // 100ms Timeout
     while (USBD_CDC_GetTxState(&hUsbDevice) != 0) {
         if (HAL_GetTick() > timeout) {
+            UFI_TELEM_INC(usb_tx_stalls);
             return;  // Timeout - nicht blockieren
         }
     }
     
+    // Belegte Bytes (ring_buffer_free hält einen Slot zur Voll/Leer-Unterscheidung frei)
+    ufi_telemetry_gauge(&g_telemetry.usb_tx_fill,
+                        USB_HS_BUFFER_SIZE - 1 - ring_buffer_free(usb_tx_head, usb_tx_tail, USB_HS_BUFFER_SIZE));
+    
     uint32_t len;
     if (usb_tx_head > usb_tx_tail) {
         len = usb_tx_head - usb_tx_tail;
@@ -175,6 +269,8 @@ void ufi_usb_flush(void) {
     
     if (USBD_CDC_TransmitPacket(&hUsbDevice) == USBD_OK) {
         usb_tx_tail = (usb_tx_tail + len) % USB_HS_BUFFER_SIZE;
+        UFI_TELEM_ADD(usb_tx_bytes, len);
+        UFI_TELEM_INC(usb_tx_packets);
     }
 }
 
@@ -182,8 +278,28 @@ void ufi_usb_flush(void) {
  * BEFEHLE VERARBEITEN
  * ============================================================================ */
 
+// Antwort-Header + optionale Daten senden
+static void usb_send_response(ufi_response_header_t* response, const uint8_t* data, uint16_t len) {
+    // Gepufferte Frames (Flux, Events) zuerst ausliefern: keine Vermischung
+    uint32_t timeout = HAL_GetTick() + 100;
+    while (usb_tx_head != usb_tx_tail && HAL_GetTick() < timeout) {
+        ufi_usb_flush();
+    }
+    usb_wait_tx_complete();
+    
+    response->length = len;
+    USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)response, 4);
+    USBD_CDC_TransmitPacket(&hUsbDevice);
+    if (len > 0) {
+        usb_wait_tx_complete();
+        USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)data, len);
+        USBD_CDC_TransmitPacket(&hUsbDevice);
+    }
+}
+
 int ufi_usb_process_command(void) {
-    if (!cmd_ready) {
+    // Kein Befehl, oder Flux-Frame erst teilweise im Ring (Antwort würde ihn teilen)
+    if (!cmd_ready || flux_tx_offset != 0) {
         return 0;
     }
     
@@ -196,6 +312,16 @@ int ufi_usb_process_command(void) {
         .length = 0
     };
     
+    UFI_TRACE_MARK(TRACE_ID_USB_CMD, cmd);
+    UFI_TELEM_INC(usb_rx_commands);
+    
+    // IEC-Job läuft noch: weitere IEC-Befehle abweisen, alles andere normal
+    if (iec_pending_cmd != 0 && (cmd & 0xF0) == 0x40) {
+        response.status = (uint8_t)(-UFI_ERR_BUSY);
+        usb_send_response(&response, NULL, 0);
+        return 1;
+    }
+    
     switch (cmd) {
         case UFI_CMD_NOP:
             // Nichts tun
@@ -225,6 +351,24 @@ int ufi_usb_process_command(void) {
             break;
         }
         
+        case UFI_CMD_SET_EVENTS:
+            // [CMD, mask] - DRIVE_SIG_* Bits, 0 = keine Events
+            ufi_drive_set_event_mask(cmd_buffer[1]);
+            USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
+            USBD_CDC_TransmitPacket(&hUsbDevice);
+            break;
+        
+        case UFI_CMD_GET_TELEMETRY: {
+            // [CMD, reset] - Schnappschuss, optional danach nullen
+            ufi_telemetry_t telemetry;
+            ufi_telemetry_snapshot(&telemetry);
+            if (cmd_buffer[1] != 0) {
+                ufi_telemetry_reset();
+            }
+            usb_send_response(&response, (const uint8_t*)&telemetry, sizeof(telemetry));
+            break;
+        }
+        
         case UFI_CMD_SELECT_DRIVE: {
             drive_type_t type = (drive_type_t)cmd_buffer[1];
             if (ufi_drive_select(type) != 0) {
@@ -236,8 +380,14 @@ int ufi_usb_process_command(void) {
         }
         
         case UFI_CMD_MOTOR_ON:
+            // Optional: [CMD, timeout_lo, timeout_hi] Spin-up Timeout in ms (0 = Default)
+            // Antwort erst nach Spin-up (ufi_usb_drive_poll)
+            ufi_drive_set_spinup_timeout(cmd_buffer[1] | (cmd_buffer[2] << 8));
             if (ufi_drive_motor(true) != 0) {
                 response.status = 1;
+            } else if (ufi_drive_spinup_poll(NULL) == 1) {
+                motor_pending = true;
+                break;
             }
             USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
             USBD_CDC_TransmitPacket(&hUsbDevice);
@@ -245,6 +395,7 @@ int ufi_usb_process_command(void) {
             
         case UFI_CMD_MOTOR_OFF:
             ufi_drive_motor(false);
+            motor_pending = false;
             USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
             USBD_CDC_TransmitPacket(&hUsbDevice);
             break;
@@ -259,6 +410,17 @@ int ufi_usb_process_command(void) {
             break;
         }
         
+        case UFI_CMD_SEEK_QTRACK: {
+            // [CMD, qtrack] - Track N = N*4, Halb-Tracks = N*4+2
+            if (ufi_drive_get_current() != DRIVE_APPLE_II ||
+                ufi_drive_apple_seek_qtrack(cmd_buffer[1]) != 0) {
+                response.status = 1;
+            }
+            USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
+            USBD_CDC_TransmitPacket(&hUsbDevice);
+            break;
+        }
+        
         case UFI_CMD_RECALIBRATE:
             if (ufi_drive_recalibrate() != 0) {
                 response.status = 1;
@@ -307,29 +469,184 @@ int ufi_usb_process_command(void) {
             break;
             
         case UFI_CMD_IEC_SEND: {
-            uint8_t byte = cmd_buffer[1];
-            bool eoi = cmd_buffer[2] != 0;
-            if (ufi_iec_send_byte(byte, eoi) != 0) {
-                response.status = 1;
+            // [CMD, byte, eoi] - Antwort nach Byte-Acknowledge (ufi_usb_iec_poll)
+            iec_xfer_buffer[0] = cmd_buffer[1];
+            int ret = ufi_iec_tx_start(iec_xfer_buffer, 1, cmd_buffer[2] ? IEC_TX_EOI : 0);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
             }
-            USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
-            USBD_CDC_TransmitPacket(&hUsbDevice);
             break;
         }
         
         case UFI_CMD_IEC_RECEIVE: {
-            uint8_t byte;
-            if (ufi_iec_receive_byte(&byte) == 0) {
-                response.length = 1;
-                USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
-                USBD_CDC_TransmitPacket(&hUsbDevice);
-                usb_wait_tx_complete();
-                USBD_CDC_SetTxBuffer(&hUsbDevice, &byte, 1);
-                USBD_CDC_TransmitPacket(&hUsbDevice);
+            // Ein Byte, Antwort aus ufi_usb_iec_poll
+            int ret = ufi_iec_rx_start(iec_xfer_buffer, 1);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
             } else {
-                response.status = 1;
-                USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
-                USBD_CDC_TransmitPacket(&hUsbDevice);
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_LISTEN:
+        case UFI_CMD_IEC_TALK:
+        case UFI_CMD_IEC_UNLISTEN:
+        case UFI_CMD_IEC_UNTALK: {
+            // ATN-Befehle laufen im TIM7-Tick, Antwort aus ufi_usb_iec_poll
+            uint8_t device = cmd_buffer[1];
+            uint8_t sa = cmd_buffer[2];
+            int ret;
+            switch (cmd) {
+                case UFI_CMD_IEC_LISTEN:   ret = ufi_iec_listen_sa_begin(device, sa); break;
+                case UFI_CMD_IEC_TALK:     ret = ufi_iec_talk_sa_begin(device, sa); break;
+                case UFI_CMD_IEC_UNLISTEN: ret = ufi_iec_unlisten_begin(); break;
+                default:                   ret = ufi_iec_untalk_begin(); break;
+            }
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_SEND_BUF: {
+            // [CMD, eoi, len_lo, len_hi, data...] - Daten im selben Paket
+            bool eoi = cmd_buffer[1] != 0;
+            uint16_t len = cmd_buffer[2] | (cmd_buffer[3] << 8);
+            int ret = UFI_ERR_BUFFER_FULL;
+            if (len <= sizeof(cmd_buffer) - 4) {
+                // Kopie: cmd_buffer wird vom nächsten Befehl überschrieben
+                memcpy(iec_xfer_buffer, &cmd_buffer[4], len);
+                ret = ufi_iec_tx_start(iec_xfer_buffer, len, eoi ? IEC_TX_EOI : 0);
+            }
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_RECV_BUF: {
+            // [CMD, max_lo, max_hi] - 0 = ganzer Puffer, Antwort bei EOI (ufi_usb_iec_poll)
+            uint32_t max_len = cmd_buffer[1] | (cmd_buffer[2] << 8);
+            if (max_len == 0 || max_len > IEC_XFER_BUFFER_SIZE) {
+                max_len = IEC_XFER_BUFFER_SIZE;
+            }
+            int ret = ufi_iec_rx_start(iec_xfer_buffer, max_len);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_LOAD: {
+            // [CMD, device, name_len, name...] - Antwort: Datei inkl. Ladeadresse
+            uint8_t device = cmd_buffer[1];
+            uint8_t name_len = cmd_buffer[2];
+            int ret = ufi_iec_load_begin(device, (const char*)&cmd_buffer[3], name_len,
+                                         iec_xfer_buffer, IEC_XFER_BUFFER_SIZE);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_MEM_WRITE: {
+            // [CMD, device, addr_lo, addr_hi, len, data...] - 32-Byte M-W Job (ufi_usb_iec_poll)
+            uint8_t device = cmd_buffer[1];
+            uint16_t addr = cmd_buffer[2] | (cmd_buffer[3] << 8);
+            uint8_t len = cmd_buffer[4];
+            // Kopie: cmd_buffer wird vom nächsten Befehl überschrieben
+            memcpy(iec_xfer_buffer, &cmd_buffer[5], len);
+            int ret = ufi_iec_mem_write_begin(device, addr, iec_xfer_buffer, len);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_MEM_EXEC: {
+            // [CMD, device, addr_lo, addr_hi] - Antwort aus ufi_usb_iec_poll
+            uint16_t addr = cmd_buffer[2] | (cmd_buffer[3] << 8);
+            int ret = ufi_iec_mem_exec_begin(cmd_buffer[1], addr);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_FAST_LOAD: {
+            // [CMD, device, name_len, name...] - Antwort: [jiffy, Datei...] (ufi_usb_iec_poll)
+            uint8_t device = cmd_buffer[1];
+            uint8_t name_len = cmd_buffer[2];
+            int ret = ufi_iec_fast_load_begin(device, (const char*)&cmd_buffer[3], name_len,
+                                              &iec_xfer_buffer[1], IEC_XFER_BUFFER_SIZE - 1);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_FAST_RECV: {
+            // [CMD, mode, count_lo, count_hi] - count 0 = bis EOI (nur JiffyDOS)
+            iec_fast_mode_t mode = (iec_fast_mode_t)cmd_buffer[1];
+            uint16_t count = cmd_buffer[2] | (cmd_buffer[3] << 8);
+            int ret = ufi_iec_fast_recv_begin(mode, iec_xfer_buffer,
+                                              IEC_XFER_BUFFER_SIZE, count);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_DISK_BEGIN: {
+            // [CMD, device, type] - Initialize + Drive-Code als Job (ufi_usb_iec_poll)
+            int ret = ufi_iec_disk_begin(cmd_buffer[1], (iec_disk_type_t)cmd_buffer[2]);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
+            }
+            break;
+        }
+        
+        case UFI_CMD_IEC_DISK_TRACK: {
+            // [CMD, track, side] - Antwort: pro Sektor [sector, status, 256 Bytes] (ufi_usb_iec_poll)
+            int ret = ufi_iec_disk_track_begin(cmd_buffer[1], cmd_buffer[2],
+                                               iec_xfer_buffer, IEC_XFER_BUFFER_SIZE);
+            if (ret != 0) {
+                response.status = (uint8_t)(-ret);
+                usb_send_response(&response, NULL, 0);
+            } else {
+                iec_pending_cmd = cmd;
             }
             break;
         }
@@ -460,6 +777,21 @@ int ufi_usb_process_command(void) {
                 usb_wait_tx_complete();
                 USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&info, sizeof(info));
                 USBD_CDC_TransmitPacket(&hUsbDevice);
+            } else if (subcmd == 4) {
+                // Trace steuern: [.., 4, 0=aus / 1=an / 2=löschen]
+                uint8_t op = cmd_buffer[2];
+                if (op == 2) {
+                    ufi_trace_clear();
+                } else if (op <= 1) {
+                    ufi_trace_enable(op == 1);
+                } else {
+                    response.status = 0xFF;
+                }
+                usb_send_response(&response, NULL, 0);
+            } else if (subcmd == 5) {
+                // Trace-Ring auslesen: trace_dump_header_t + Einträge
+                uint32_t len = ufi_trace_dump(trace_dump_buffer, sizeof(trace_dump_buffer));
+                usb_send_response(&response, trace_dump_buffer, (uint16_t)len);
             } else {
                 response.status = 0xFF;
                 USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*)&response, 4);
@@ -475,7 +807,106 @@ int ufi_usb_process_command(void) {
             break;
     }
     
+    ufi_telemetry_gauge(&g_telemetry.cmd_latency, DWT->CYCCNT - cmd_rx_cycles);
+    
     return 1;
 }
 
 /* USB CDC Interface ist in usbd_cdc_if.c definiert */
+
+/* ============================================================================
+ * IEC-JOBS ABSCHLIESSEN (Scheduler-Task)
+ * ============================================================================ */
+
+void ufi_usb_iec_poll(void) {
+    uint32_t len = 0;
+    int ret;
+    
+    // Kein Job, oder Flux-Frame erst teilweise im Ring (Antwort würde ihn teilen)
+    if (iec_pending_cmd == 0 || flux_tx_offset != 0) {
+        return;
+    }
+    
+    if (iec_pending_cmd == UFI_CMD_IEC_LOAD) {
+        ret = ufi_iec_load_poll(&len);
+        if (ret == 1) {
+            return;
+        }
+    } else if (iec_pending_cmd == UFI_CMD_IEC_FAST_LOAD ||
+               iec_pending_cmd == UFI_CMD_IEC_FAST_RECV ||
+               iec_pending_cmd == UFI_CMD_IEC_MEM_WRITE ||
+               iec_pending_cmd == UFI_CMD_IEC_MEM_EXEC ||
+               iec_pending_cmd == UFI_CMD_IEC_DISK_BEGIN ||
+               iec_pending_cmd == UFI_CMD_IEC_DISK_TRACK) {
+        // Ein Teilschritt bzw. FAST_JOB_CHUNK Bytes pro Durchlauf
+        ret = ufi_iec_job_poll(&len);
+        if (ret == 1) {
+            return;
+        }
+    } else if (iec_pending_cmd == UFI_CMD_IEC_RECV_BUF ||
+               iec_pending_cmd == UFI_CMD_IEC_RECEIVE) {
+        int error;
+        iec_rx_status_t status = ufi_iec_rx_poll(&len, &error);
+        if (status == IEC_RX_BUSY) {
+            return;
+        }
+        ret = (status == IEC_RX_DONE) ? UFI_OK : error;
+        if (iec_pending_cmd == UFI_CMD_IEC_RECEIVE && ret == UFI_ERR_BUFFER_FULL) {
+            ret = UFI_OK;       // Ein Byte ohne EOI
+        }
+    } else {
+        // Sendejobs: LISTEN/TALK/UNLISTEN/UNTALK/SEND/SEND_BUF
+        int error;
+        iec_rx_status_t status = ufi_iec_tx_poll(&len, &error);
+        if (status == IEC_RX_BUSY) {
+            return;
+        }
+        ret = (status == IEC_RX_DONE) ? UFI_OK : error;
+        len = 0;
+    }
+    
+    ufi_response_header_t response = {
+        .command = iec_pending_cmd,
+        .status = 0,
+        .length = 0
+    };
+    uint8_t cmd = iec_pending_cmd;
+    iec_pending_cmd = 0;
+    
+    if (ret != 0) {
+        response.status = (uint8_t)(-ret);
+        // Fast-Empfang: Teildaten auch bei Fehler zurückgeben
+        if (cmd != UFI_CMD_IEC_FAST_RECV) {
+            len = 0;
+        }
+    }
+    if (cmd == UFI_CMD_IEC_FAST_LOAD) {
+        iec_xfer_buffer[0] = ufi_iec_fast_load_jiffy() ? 1 : 0;
+        len++;
+    }
+    usb_send_response(&response, iec_xfer_buffer, (uint16_t)len);
+}
+
+/* ============================================================================
+ * SPIN-UP ABSCHLIESSEN (Scheduler-Task)
+ * ============================================================================ */
+
+void ufi_usb_drive_poll(void) {
+    // Antwort erst nach einem teilweise eingereihten Flux-Frame
+    if (!motor_pending || flux_tx_offset != 0) {
+        return;
+    }
+    
+    int ret = ufi_drive_spinup_poll(NULL);
+    if (ret == 1) {
+        return;
+    }
+    motor_pending = false;
+    
+    ufi_response_header_t response = {
+        .command = UFI_CMD_MOTOR_ON,
+        .status = (ret != 0) ? 1 : 0,
+        .length = 0
+    };
+    usb_send_response(&response, NULL, 0);
+}
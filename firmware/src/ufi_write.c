@@ -22,17 +22,6 @@ extern capture_context_t g_capture;
 #define WRITE_BUFFER_SIZE   65536   // Max 64K Flux-Samples pro Track
 #define WRITE_PRECOMP_NS    140     // ns - Write Precompensation
 
-/* Write State Machine */
-typedef enum {
-    WRITE_IDLE,
-    WRITE_RECEIVING,        // Empfange Flux-Daten
-    WRITE_WAITING_INDEX,    // Warte auf Index für Sync
-    WRITE_ACTIVE,           // Schreibe Daten
-    WRITE_COMPLETE,
-    WRITE_VERIFYING,
-    WRITE_ERROR
-} write_state_t;
-
 typedef struct {
     write_state_t state;
     uint8_t track;
@@ -271,6 +260,7 @@ int ufi_write_verify(void) {
     
     uint32_t timeout = HAL_GetTick() + 1000;
     while (ufi_capture_get_state() != CAPTURE_COMPLETE) {
+        ufi_capture_poll();
         if (HAL_GetTick() > timeout) {
             g_write.state = WRITE_ERROR;
             return UFI_ERR_TIMEOUT;
@@ -64,6 +64,8 @@ apt-get install -y \
     python3-usb \
     libusb-1.0-0 \
     libusb-1.0-0-dev \
+    cmake \
+    g++ \
     nginx \
     git \
     htop \
@@ -108,6 +110,11 @@ mkdir -p $UFI_DIR/cache
 cp -r software/cm5/* $UFI_DIR/
 cp -r software/web $UFI_DIR/
 
+# Native Flux-Core (NEON-optimiert für die CM5) bauen
+cmake -S software -B software/build -DCMAKE_BUILD_TYPE=Release
+cmake --build software/build -j"$(nproc)"
+cp software/build/libufi_flux.so $UFI_DIR/
+
 # Berechtigungen setzen
 chown -R ufi:ufi $UFI_DIR
 chmod +x $UFI_DIR/*.py
@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+"""
+UFI Flux-Core Bindings
+======================
+
+ctypes-Anbindung der nativen Flux-Bibliothek (libufi_flux, software/src/
+ufi_flux_core.cpp). Die numpy-Arrays werden ohne Kopie als Zeiger
+übergeben (structure of arrays, siehe ufi_flux_core.h).
+
+Suchreihenfolge der Bibliothek:
+- $UFI_FLUX_CORE (Pfad zur .so)
+- Verzeichnis dieses Moduls (Installation nach /opt/ufi)
+- software/build (cmake -S software -B software/build)
+- Systempfad (ldconfig)
+
+Fehlt die Bibliothek, liefert load() None und die Verarbeitung bleibt bei
+den numpy-Pfaden.
+"""
+
+import os
+import ctypes
+import ctypes.util
+import logging
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional, Tuple
+import numpy as np
+
+log = logging.getLogger('UFI.FluxCore')
+
+# ============================================================================
+# KONFIGURATION
+# ============================================================================
+
+UFI_FLUX_CORE_ENV = 'UFI_FLUX_CORE'
+UFI_FLUX_CORE_VERSION = 6           # ufi_flux_core.h
+
+UFI_FLUX_OK = 0
+UFI_FLUX_ERR_PARAM = -1
+UFI_FLUX_ERR_OVERFLOW = -2
+
+SYNC_MAX_WIDTH = 32
+
+# PLL-Standardwerte (Greaseweazle-ähnlich)
+PLL_PERIOD_ADJ = 0.05
+PLL_PHASE_ADJ = 0.60
+PLL_TOLERANCE = 0.10
+
+# Ausrichtung der Umdrehungen: Fenstergröße und Suchradius in Bitzellen
+ALIGN_WINDOW = 1024
+ALIGN_MAX_LAG = 32
+
+# Umdrehungsanalyse: Histogramm (100 ns je Bin bis 25,6 µs), Anomalie-
+# Schwellen relativ zum Median, Abstand innerhalb eines Bereichs
+ANALYZE_BIN_NS = 100.0
+ANALYZE_BINS = 256
+ANALYZE_SHORT = 0.3
+ANALYZE_LONG = 3.0
+ANALYZE_RUN_GAP = 16
+ANALYZE_MAX_RUNS = 64
+
+_LIB_NAME = 'libufi_flux.so'
+
+
+class _PllParams(ctypes.Structure):
+    _fields_ = [
+        ('clock_ns', ctypes.c_float),
+        ('period_adj', ctypes.c_float),
+        ('phase_adj', ctypes.c_float),
+        ('tolerance', ctypes.c_float),
+    ]
+
+
+class _Bitstream(ctypes.Structure):
+    _fields_ = [
+        ('bits', ctypes.c_void_p),
+        ('capacity', ctypes.c_uint32),
+        ('nbits', ctypes.c_uint32),
+        ('bit_pos', ctypes.c_void_p),
+        ('phase', ctypes.c_void_p),
+    ]
+
+
+class _AnalyzeParams(ctypes.Structure):
+    _fields_ = [
+        ('ns_per_tick', ctypes.c_float),
+        ('bin_ns', ctypes.c_float),
+        ('short_factor', ctypes.c_float),
+        ('long_factor', ctypes.c_float),
+        ('run_gap', ctypes.c_uint32),
+    ]
+
+
+class _FluxStats(ctypes.Structure):
+    _fields_ = [
+        ('deltas_ns', ctypes.c_void_p),
+        ('hist', ctypes.c_void_p),
+        ('bins', ctypes.c_uint32),
+        ('runs', ctypes.c_void_p),
+        ('max_runs', ctypes.c_uint32),
+        ('total_ns', ctypes.c_double),
+        ('median_ns', ctypes.c_float),
+        ('max_ns', ctypes.c_float),
+        ('short_count', ctypes.c_uint32),
+        ('long_count', ctypes.c_uint32),
+        ('nruns', ctypes.c_uint32),
+    ]
+
+
+# ============================================================================
+# DATENSTRUKTUREN
+# ============================================================================
+
+@dataclass
+class Bitstream:
+    """Bitzellen einer Umdrehung (Ausgabe des Datenseparators)"""
+    bits: np.ndarray        # uint8, gepackt, MSB zuerst
+    nbits: int
+    bit_pos: np.ndarray     # uint32 je Flux-Intervall (0xFFFFFFFF = verschmolzen)
+    phase: np.ndarray       # int8 je Flux-Intervall, ±127 = ±halbe Zelle
+    clock_ns: float
+
+    def unpacked(self) -> np.ndarray:
+        """Bitzellen als uint8-Array (0/1)"""
+        return np.unpackbits(self.bits, count=self.nbits)
+
+
+@dataclass
+class FluxStats:
+    """Statistik einer Umdrehung (Ausgabe der Umdrehungsanalyse)"""
+    count: int
+    hist: np.ndarray        # uint32, bin_ns je Bin, Überläufe im letzten
+    bin_ns: float
+    total_ns: float
+    median_ns: float
+    max_ns: float
+    short_count: int        # Intervalle < ANALYZE_SHORT * Median
+    long_count: int         # Intervalle > ANALYZE_LONG * Median
+    runs: np.ndarray        # uint32 (n, 2): erstes Intervall, Anzahl Intervalle
+    nruns: int              # Anomalie-Bereiche (auch über ANALYZE_MAX_RUNS hinaus)
+
+    @property
+    def anomalies(self) -> int:
+        return self.short_count + self.long_count
+
+    def percentile(self, q: float) -> float:
+        """Perzentil der Intervalle aus dem Histogramm (ns, Bin-Mitte)"""
+        if self.count == 0:
+            return 0.0
+        k = int(np.searchsorted(np.cumsum(self.hist), self.count * q / 100.0, side='right'))
+        return (min(k, len(self.hist) - 1) + 0.5) * self.bin_ns
+
+
+# ============================================================================
+# BIBLIOTHEK
+# ============================================================================
+
+def _ptr(a: np.ndarray) -> ctypes.c_void_p:
+    return ctypes.c_void_p(a.ctypes.data)
+
+
+def _f32(a) -> np.ndarray:
+    return np.ascontiguousarray(a, dtype=np.float32)
+
+
+class FluxCore:
+    """Native Flux-Kernels (Analyse, PLL, Klassifikation, Histogramm, Sync-Suche, MFM, CRC, Nibbles, Ausrichtung)"""
+
+    def __init__(self, path: str):
+        self.path = path
+        lib = ctypes.CDLL(path)
+
+        lib.ufi_flux_version.restype = ctypes.c_uint32
+        lib.ufi_flux_version.argtypes = []
+        lib.ufi_flux_simd.restype = ctypes.c_char_p
+        lib.ufi_flux_simd.argtypes = []
+        lib.ufi_flux_analyze.restype = ctypes.c_int
+        lib.ufi_flux_analyze.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32,
+            ctypes.POINTER(_AnalyzeParams), ctypes.POINTER(_FluxStats)]
+        lib.ufi_flux_pll_decode.restype = ctypes.c_int
+        lib.ufi_flux_pll_decode.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32,
+            ctypes.POINTER(_PllParams), ctypes.POINTER(_Bitstream)]
+        lib.ufi_flux_classify.restype = None
+        lib.ufi_flux_classify.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_float, ctypes.c_uint8, ctypes.c_void_p]
+        lib.ufi_flux_histogram.restype = None
+        lib.ufi_flux_histogram.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_float, ctypes.c_void_p, ctypes.c_uint32]
+        lib.ufi_flux_find_sync.restype = ctypes.c_uint32
+        lib.ufi_flux_find_sync.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint32,
+            ctypes.c_void_p, ctypes.c_uint32]
+        lib.ufi_flux_get_bits.restype = None
+        lib.ufi_flux_get_bits.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_void_p]
+        lib.ufi_flux_mfm_data.restype = None
+        lib.ufi_flux_mfm_data.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_void_p]
+        lib.ufi_flux_crc16.restype = ctypes.c_uint16
+        lib.ufi_flux_crc16.argtypes = [ctypes.c_uint16, ctypes.c_char_p, ctypes.c_uint32]
+        lib.ufi_flux_nibbles.restype = ctypes.c_uint32
+        lib.ufi_flux_nibbles.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint32]
+        lib.ufi_flux_align.restype = ctypes.c_uint32
+        lib.ufi_flux_align.argtypes = [
+            ctypes.c_void_p, ctypes.c_uint32, ctypes.c_void_p, ctypes.c_uint32,
+            ctypes.c_uint32, ctypes.c_uint32, ctypes.c_void_p, ctypes.c_void_p]
+
+        version = lib.ufi_flux_version()
+        if version != UFI_FLUX_CORE_VERSION:
+            raise OSError(f"{path}: API-Version {version}, erwartet {UFI_FLUX_CORE_VERSION}")
+
+        self._lib = lib
+        self.simd = lib.ufi_flux_simd().decode()
+
+    def analyze(self, ticks: np.ndarray, ns_per_tick: float) -> Tuple[np.ndarray, FluxStats]:
+        """Umdrehungsanalyse: Intervalle (ns) und Statistik in einem Aufruf"""
+        t = np.ascontiguousarray(ticks, dtype=np.uint32)
+        count = len(t)
+        deltas = np.empty(count, dtype=np.float32)
+        hist = np.empty(ANALYZE_BINS, dtype=np.uint32)
+        runs = np.empty((ANALYZE_MAX_RUNS, 2), dtype=np.uint32)
+
+        params = _AnalyzeParams(ns_per_tick, ANALYZE_BIN_NS, ANALYZE_SHORT, ANALYZE_LONG,
+                                ANALYZE_RUN_GAP)
+        st = _FluxStats(deltas.ctypes.data, hist.ctypes.data, ANALYZE_BINS,
+                        runs.ctypes.data, ANALYZE_MAX_RUNS)
+        rc = self._lib.ufi_flux_analyze(_ptr(t), count, ctypes.byref(params), ctypes.byref(st))
+        if rc != UFI_FLUX_OK:
+            raise ValueError(f"ufi_flux_analyze: Fehler {rc}")
+
+        return deltas, FluxStats(
+            count=count, hist=hist, bin_ns=ANALYZE_BIN_NS, total_ns=st.total_ns,
+            median_ns=st.median_ns, max_ns=st.max_ns, short_count=st.short_count,
+            long_count=st.long_count, runs=runs[:min(st.nruns, ANALYZE_MAX_RUNS)],
+            nruns=st.nruns)
+
+    def pll_decode(self, deltas_ns: np.ndarray, clock_ns: float,
+                   period_adj: float = PLL_PERIOD_ADJ,
+                   phase_adj: float = PLL_PHASE_ADJ,
+                   tolerance: float = PLL_TOLERANCE) -> Bitstream:
+        """Datenseparator: Flux-Intervalle (ns) → Bitzellen"""
+        deltas = _f32(deltas_ns)
+        count = len(deltas)
+
+        # Obergrenze: kürzeste erlaubte Zelle + Rundung je Intervall
+        total = float(deltas.sum(dtype=np.float64)) if count else 0.0
+        capacity = int(total / (clock_ns * (1 - tolerance))) + count + 64
+
+        bits = np.zeros((capacity + 7) // 8, dtype=np.uint8)
+        bit_pos = np.empty(count, dtype=np.uint32)
+        phase = np.empty(count, dtype=np.int8)
+
+        params = _PllParams(clock_ns, period_adj, phase_adj, tolerance)
+        out = _Bitstream(bits.ctypes.data, capacity, 0, bit_pos.ctypes.data, phase.ctypes.data)
+        rc = self._lib.ufi_flux_pll_decode(_ptr(deltas), count, ctypes.byref(params), ctypes.byref(out))
+        if rc != UFI_FLUX_OK:
+            raise ValueError(f"ufi_flux_pll_decode: Fehler {rc}")
+
+        nbits = out.nbits
+        return Bitstream(bits=bits[:(nbits + 7) // 8], nbits=nbits,
+                         bit_pos=bit_pos, phase=phase, clock_ns=clock_ns)
+
+    def classify(self, deltas_ns: np.ndarray, clock_ns: float, max_cells: int = 255) -> np.ndarray:
+        """Intervalle in ganze Bitzellen (gerundet, 0..max_cells)"""
+        deltas = _f32(deltas_ns)
+        cells = np.empty(len(deltas), dtype=np.uint8)
+        self._lib.ufi_flux_classify(_ptr(deltas), len(deltas), clock_ns, max_cells, _ptr(cells))
+        return cells
+
+    def histogram(self, deltas_ns: np.ndarray, bin_ns: float, bins: int) -> np.ndarray:
+        """Intervall-Histogramm, Überläufe im letzten Bin"""
+        deltas = _f32(deltas_ns)
+        hist = np.empty(bins, dtype=np.uint32)
+        self._lib.ufi_flux_histogram(_ptr(deltas), len(deltas), bin_ns, _ptr(hist), bins)
+        return hist
+
+    def find_sync(self, bits: Bitstream, pattern: int, width: int,
+                  max_positions: int = 4096) -> np.ndarray:
+        """Bit-Offsets aller Vorkommen eines Sync-Musters (aufsteigend)"""
+        if not 1 <= width <= SYNC_MAX_WIDTH:
+            raise ValueError(f"Sync-Breite {width} nicht unterstützt")
+        data = np.ascontiguousarray(bits.bits, dtype=np.uint8)
+        positions = np.empty(max_positions, dtype=np.uint32)
+        found = self._lib.ufi_flux_find_sync(_ptr(data), bits.nbits, pattern, width,
+                                             _ptr(positions), max_positions)
+        if found > max_positions:
+            # Selten (unformatierte Spur): mit passender Größe wiederholen
+            positions = np.empty(found, dtype=np.uint32)
+            self._lib.ufi_flux_find_sync(_ptr(data), bits.nbits, pattern, width,
+                                         _ptr(positions), found)
+        return positions[:found]
+
+
+    def raw_bits(self, bits: Bitstream, start_bit: int, nbytes: int) -> bytes:
+        """Rohe Bitzellen ab start_bit, byteweise (8 Zellen je Byte)"""
+        data = np.ascontiguousarray(bits.bits, dtype=np.uint8)
+        out = ctypes.create_string_buffer(nbytes)
+        self._lib.ufi_flux_get_bits(_ptr(data), bits.nbits, start_bit, nbytes, out)
+        return out.raw
+
+    def mfm_data(self, bits: Bitstream, start_bit: int, nbytes: int) -> bytes:
+        """MFM-Datenbits ab Taktzelle start_bit (z.B. Sync-Position) als Bytes"""
+        data = np.ascontiguousarray(bits.bits, dtype=np.uint8)
+        out = ctypes.create_string_buffer(nbytes)
+        self._lib.ufi_flux_mfm_data(_ptr(data), bits.nbits, start_bit, nbytes, out)
+        return out.raw
+
+    def crc16(self, data: bytes, crc: int = 0xFFFF) -> int:
+        """CRC-CCITT (0x1021), 0 über Block inklusive eigener CRC"""
+        return self._lib.ufi_flux_crc16(crc, data, len(data))
+
+    def nibbles(self, bits: Bitstream) -> Tuple[np.ndarray, np.ndarray]:
+        """Apple-II-Nibbles einer Umdrehung und ihre Bit-Offsets"""
+        data = np.ascontiguousarray(bits.bits, dtype=np.uint8)
+        capacity = bits.nbits // 8 + 1
+        nibbles = np.empty(capacity, dtype=np.uint8)
+        positions = np.empty(capacity, dtype=np.uint32)
+        found = self._lib.ufi_flux_nibbles(_ptr(data), bits.nbits, _ptr(nibbles),
+                                           _ptr(positions), capacity)
+        return nibbles[:found], positions[:found]
+
+    def align(self, ref: Bitstream, bits: Bitstream, window: int = ALIGN_WINDOW,
+              max_lag: int = ALIGN_MAX_LAG) -> Tuple[np.ndarray, np.ndarray]:
+        """Versatz je Fenster (Referenz-Zelle k ~ Zelle k + Versatz) und abweichende Zellen"""
+        a = np.ascontiguousarray(ref.bits, dtype=np.uint8)
+        b = np.ascontiguousarray(bits.bits, dtype=np.uint8)
+        nwin = (ref.nbits + window - 1) // window
+        shifts = np.zeros(nwin, dtype=np.int32)
+        mismatches = np.zeros(nwin, dtype=np.uint32)
+        self._lib.ufi_flux_align(_ptr(a), ref.nbits, _ptr(b), bits.nbits, window, max_lag,
+                                 _ptr(shifts), _ptr(mismatches))
+        return shifts, mismatches
+
+
+def _candidates():
+    env = os.environ.get(UFI_FLUX_CORE_ENV)
+    if env:
+        yield env
+    here = Path(__file__).resolve().parent
+    yield str(here / _LIB_NAME)
+    yield str(here.parent / 'build' / _LIB_NAME)
+    found = ctypes.util.find_library('ufi_flux')
+    if found:
+        yield found
+
+
+def load() -> Optional[FluxCore]:
+    """Native Bibliothek laden, None wenn nicht vorhanden"""
+    for path in _candidates():
+        if os.sep in path and not os.path.exists(path):
+            continue
+        try:
+            core = FluxCore(path)
+        except OSError as e:
+            log.warning(f"Flux-Core {path}: {e}")
+            continue
+        log.info(f"Flux-Core {core.path} ({core.simd})")
+        return core
+
+    log.warning("Flux-Core nicht gefunden (cmake -S software -B software/build), nur numpy")
+    return None
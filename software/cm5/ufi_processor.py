@@ -11,16 +11,30 @@ Aufgaben:
 """
 
 import asyncio
+import os
+import socket
 import struct
+import time
 import logging
 import json
 import hashlib
+import itertools
+import queue
+import threading
+import multiprocessing
+from multiprocessing import shared_memory
+from collections import deque
+from concurrent.futures import Future, ProcessPoolExecutor
+from concurrent.futures.process import BrokenProcessPool
 from typing import List, Dict, Optional, Tuple
-from dataclasses import dataclass, field
+from dataclasses import dataclass, field, asdict
 from enum import IntEnum
 from pathlib import Path
 import numpy as np
 
+# Native Flux-Kernels (optional, libufi_flux)
+import ufi_flux_core
+
 # USB Kommunikation mit STM32
 import usb.core
 import usb.util
@@ -39,6 +53,53 @@ UFI_PID = 0x4F54  # "OT" für Open Tool
 USB_EP_IN = 0x81   # Flux-Daten vom STM32
 USB_EP_OUT = 0x02  # Befehle zum STM32
 
+# Virtuelles Gerät (firmware/sim, ufi_sim --listen) statt USB, z.B. tcp://127.0.0.1:4242
+UFI_DEVICE_ENV = 'UFI_DEVICE'
+
+# Asynchrone Events vom STM32 (Header wie Antwort, command = Event-ID)
+UFI_EVT_DRIVE_SIGNALS = 0xE0
+
+# Laufwerk-Signale (Event-Bitmaske)
+DRIVE_SIG_DISK_CHANGE = 1 << 0
+DRIVE_SIG_READY = 1 << 1
+DRIVE_SIG_WRITE_PROT = 1 << 2
+DRIVE_SIG_INDEX = 1 << 3
+
+# Disk-Images über IEC: Typ-ID (Firmware), Tracks, Seiten
+IEC_IMAGE_FORMATS = {
+    'd64': (1, 35, 1),
+    'd71': (2, 35, 2),
+    'd81': (3, 80, 1),
+}
+IEC_SECTOR_TIMEOUT_MS = 11000   # DISK_JOB_MS (Firmware, DOS-Wiederholungen) + Transfer
+IEC_STATUS_NOT_READY = 0x0F     # D64 Error-Info: Fehler 74, Track nicht gelesen
+
+# Lese-Pipeline: Erfassungs-Thread (USB) → begrenzte Warteschlange → Verarbeitung
+READ_REVOLUTIONS = 3
+RETRY_REVOLUTIONS = 5       # Wiederholung bei Qualität < RETRY_QUALITY (nur Disk)
+RETRY_QUALITY = 80
+CAPTURE_QUEUE_TRACKS = 8    # Gelesene Tracks vor der Verarbeitung, dann Rückstau
+PROCESS_WORKERS = 3         # Verarbeitungs-Prozesse (CM5: 4 Kerne), 0 = im eigenen Prozess
+SHARED_FLUX_BYTES = 4 << 20 # Ticks je Verarbeitungs-Prozess: 5 Umdrehungen ED, wächst bei Bedarf
+JOB_HISTORY = 16            # Abgeschlossene Aufträge für /api/jobs
+
+# Telemetrie (ufi_telemetry_t): Kopf, Zähler, Gauges (count, min, max, last, sum)
+TELEMETRY_HEADER = struct.Struct('<HHIII')
+TELEMETRY_COUNTERS = (
+    'dma_half', 'dma_complete', 'dma_errors', 'flux_overruns', 'index_pulses',
+    'revolutions', 'usb_tx_bytes', 'usb_tx_packets', 'usb_tx_stalls',
+    'usb_rx_commands', 'usb_rx_dropped', 'flux_drops', 'event_drops',
+)
+TELEMETRY_GAUGES = ('cmd_latency', 'loop_time', 'usb_tx_fill')
+TELEMETRY_CYCLE_GAUGES = ('cmd_latency', 'loop_time')   # in CPU-Zyklen
+TELEMETRY_GAUGE = struct.Struct('<IIIIQ')
+# Ab Version 2: rpm_monitor_t (Index-Perioden, Wow & Flutter)
+TELEMETRY_RPM = struct.Struct('<HH8I16H')
+TELEMETRY_RPM_FIELDS = (
+    'period_last_ns', 'period_mean_ns', 'period_min_ns', 'period_max_ns',
+    'period_std_ns', 'rpm_x100', 'wow_rms_ppm', 'wow_pp_ppm',
+)
+
 FLUX_CLOCK_HZ = 275_000_000  # STM32 Timer Clock
 FLUX_NS_PER_TICK = 1e9 / FLUX_CLOCK_HZ  # ~3.6ns
 
@@ -46,6 +107,86 @@ FLUX_NS_PER_TICK = 1e9 / FLUX_CLOCK_HZ  # ~3.6ns
 MFM_CELL_NS = 2000      # MFM Bit-Cell (500 kbit/s)
 GCR_CELL_NS = 4000      # GCR Bit-Cell (C64/Amiga)
 
+# IBM-PC MFM: drei A1-Syncs (0x4489, Takt fehlt) vor jeder Adressmarke
+MFM_SYNC = 0x4489
+MFM_SYNC_CRC = 0xCDB4   # CRC-CCITT über A1 A1 A1
+IBM_IDAM = 0xFE         # ID: Zylinder, Kopf, Sektor, Größe, CRC
+IBM_DAM = 0xFB          # Daten
+IBM_DDAM = 0xF8         # Daten, als gelöscht markiert
+IBM_ID_TO_DAM_MAX = 80  # Bytes von IDAM bis DAM (Gap 2 bei ED: 41)
+
+# Amiga trackdisk: 0x4489 0x4489, dann Info, Label, Prüfsummen und Daten
+# jeweils als odd/even-Hälften (erst alle ungeraden, dann alle geraden Bits)
+AMIGA_SYNC = 0x44894489
+AMIGA_SECTOR_RAW = 1080     # Rohbytes nach dem Sync: 270 MFM-Langwörter
+AMIGA_MFM_MASK = 0x55555555
+AMIGA_LONG_TRACK = 1.03     # Bitzellen über Nominal: Long Track (Kopierschutz)
+
+FUSED_REVOLUTION = 99       # Revolution-Nummer der fusionierten Umdrehung
+
+# Weak-Bits: Bereiche uneiniger Bitzellen der ausgerichteten Umdrehungen
+WEAK_GAP_CELLS = 16         # Kleinere Lücken werden überbrückt
+WEAK_MIN_CELLS = 16         # Mindestlänge eines Bereichs
+WEAK_MIN_CONFIDENCE = 0.3
+WEAK_SINGLE_REV = 0.9       # Anteil einer einzelnen Umdrehung: Versatz, kein Weak-Bit
+
+ERROR_RUNS_LISTED = 5       # Anomalie-Bereiche je Meldung (detect_errors)
+
+# Format-Erkennung: Takt aus den Spitzen des Intervall-Histogramms,
+# Bestätigung per Sync-Suche auf einem Teil der Umdrehung
+CLOCK_PEAK_SHARE = 0.03     # Mindestanteil der Intervalle einer Spitze
+CLOCK_FIT_MAX_ERROR = 0.08  # Mittlere Abweichung der Spitzen von ganzen Zellen
+CLOCK_FIT_TOLERANCE = 0.035 # Abweichung vom Format-Takt (halber C64-Zonenabstand)
+FORMAT_PROBE_SHARE = 0.25   # Anteil der Umdrehung für die kurze Sync-Suche
+
+# Commodore 1541 GCR: Sync aus >= 10 Einsen, dann Header (08) oder
+# Datenblock (07), je 4 Bytes als 5 GCR-Bytes
+C64_SYNC_BITS = 10
+C64_HEADER = 0x08
+C64_DATA = 0x07
+C64_BLOCK_RAW = 325         # GCR-Bytes eines Datenblocks (260 Bytes)
+C64_HEADER_TO_DATA_MAX = 64 # GCR-Bytes von Header- bis Daten-Sync-Ende
+C64_ZONES = (               # Tracks bis (0-basiert, exklusiv), Bitzelle ns, Sektoren
+    (17, 3250, 21),
+    (24, 3500, 19),
+    (30, 3750, 18),
+    (255, 4000, 17),
+)
+GCR_ENCODE = (0x0A, 0x0B, 0x12, 0x13, 0x0E, 0x0F, 0x16, 0x17,
+              0x09, 0x19, 0x1A, 0x1B, 0x0D, 0x1D, 0x1E, 0x15)
+G64_TRACK_MAX = 7928        # Bytes je Track im G64
+G64_HALF_TRACKS = 84
+
+# Apple II GCR: Nibbles (Bit 7 gesetzt), Prolog D5 AA, dann 96 (Adressfeld,
+# 16 Sektoren, 6-and-2), B5 (Adressfeld, 13 Sektoren, 5-and-3) oder AD (Daten)
+APPLE_CELL_NS = 4000
+APPLE_ADDR_16 = 0x96
+APPLE_ADDR_13 = 0xB5
+APPLE_DATA = 0xAD
+APPLE_DATA_62 = 343         # Nibbles im Datenfeld inkl. Prüfsumme
+APPLE_DATA_53 = 411
+APPLE_ADDR_TO_DATA_MAX = 48 # Nibbles von Adress- bis Datenprolog
+APPLE_TRACKS = 35
+APPLE_NIB_TRACK = 6656      # Nibbles je Track im NIB
+
+APPLE_WRITE_62 = (
+    0x96, 0x97, 0x9A, 0x9B, 0x9D, 0x9E, 0x9F, 0xA6, 0xA7, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB2, 0xB3,
+    0xB4, 0xB5, 0xB6, 0xB7, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xCB, 0xCD, 0xCE, 0xCF, 0xD3,
+    0xD6, 0xD7, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE5, 0xE6, 0xE7, 0xE9, 0xEA, 0xEB, 0xEC,
+    0xED, 0xEE, 0xEF, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+)
+APPLE_WRITE_53 = (
+    0xAB, 0xAD, 0xAE, 0xAF, 0xB5, 0xB6, 0xB7, 0xBA, 0xBB, 0xBD, 0xBE, 0xBF, 0xD6, 0xD7, 0xDA, 0xDB,
+    0xDD, 0xDE, 0xDF, 0xEA, 0xEB, 0xED, 0xEE, 0xEF, 0xF5, 0xF6, 0xF7, 0xFA, 0xFB, 0xFD, 0xFE, 0xFF,
+)
+
+# Physikalischer Sektor je Image-Sektor (DOS 3.3 .dsk, ProDOS .po)
+APPLE_SKEW = {
+    'dos': (0, 13, 11, 9, 7, 5, 3, 1, 14, 12, 10, 8, 6, 4, 2, 15),
+    'prodos': (0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15),
+    'physical': tuple(range(16)),
+}
+
 logging.basicConfig(level=logging.INFO)
 log = logging.getLogger("ufi-cm5")
 
@@ -64,23 +205,30 @@ class DiskFormat(IntEnum):
     C64_GCR_40 = 6      # C64 40 Track
     APPLE_II_GCR = 7    # Apple II 140K
     ATARI_FM = 8        # Atari 8-bit
-
-
-@dataclass
-class FluxSample:
-    """Ein Flux-Übergang"""
-    timestamp: int      # Timer-Wert (Ticks)
-    delta_ns: float = 0 # Zeit zum vorherigen (ns)
+    PC_MFM_ED = 9       # PC 2.88M
 
 
 @dataclass
 class FluxRevolution:
-    """Eine Disk-Umdrehung"""
-    samples: List[FluxSample]
+    """
+    Eine Disk-Umdrehung als zusammenhängende Arrays (ca. 200 KB bei DD)
+    
+    ticks:     uint32, Timer-Wert jeder Flanke seit Index (direkt aus dem USB-Puffer)
+    deltas_ns: float32, Abstand zur vorherigen Flanke (normalize_timing)
+    stats:     Histogramm, Median, Anomalien (normalize_timing, ein Durchlauf)
+    """
+    ticks: np.ndarray
     index_time: int
     revolution: int
+    deltas_ns: np.ndarray = field(default_factory=lambda: np.zeros(0, dtype=np.float32))
+    stats: Optional[ufi_flux_core.FluxStats] = None
     duration_ns: float = 0
     rpm: float = 0
+    
+    @property
+    def count(self) -> int:
+        """Anzahl Flanken"""
+        return int(self.ticks.size)
 
 
 @dataclass
@@ -92,6 +240,41 @@ class FluxTrack:
     format: DiskFormat = DiskFormat.UNKNOWN
     quality_score: float = 0
     sectors: List['Sector'] = field(default_factory=list)
+    aligned: Optional['AlignedRevolutions'] = None    # combine_revolutions
+    weak_regions: Optional[List['WeakRegion']] = None  # detect_weak_bits
+    errors: Optional[List[str]] = None                 # detect_errors
+    clock_ns: Optional[float] = None                   # detect_format, gemessener Takt
+
+
+@dataclass
+class AlignedRevolutions:
+    """
+    Bitzellen aller Umdrehungen, auf die Referenz-Umdrehung ausgerichtet
+    
+    cells: uint8 (Umdrehungen × Referenz-Zellen), 0/1
+    valid: bool, gleiche Form; False wo die Umdrehung die Zelle nicht abdeckt
+    fused: Mehrheitsentscheid je Zelle, bei Gleichstand die Referenz
+    """
+    clock_ns: float
+    reference: int
+    bitstreams: List[Optional[ufi_flux_core.Bitstream]]   # je Umdrehung, None = leer
+    shifts: np.ndarray      # int32 (Umdrehungen × Fenster), Versatz zur Referenz
+    cells: np.ndarray
+    valid: np.ndarray
+    fused: ufi_flux_core.Bitstream
+    
+    @property
+    def count(self) -> int:
+        """Anzahl ausgerichteter Umdrehungen"""
+        return sum(b is not None for b in self.bitstreams)
+
+
+@dataclass
+class WeakRegion:
+    """Bereich uneiniger Bitzellen (Zellen der Referenz-Umdrehung)"""
+    start: int
+    length: int
+    confidence: float       # Anteil uneiniger Zellen relativ zu Zufallsbits, 0..1
 
 
 @dataclass
@@ -102,6 +285,24 @@ class Sector:
     crc_ok: bool
     quality: float
     weak_bits: List[int] = field(default_factory=list)
+    cylinder: int = -1      # Aus dem Sektor-Header (IBM: C/H)
+    head: int = -1
+    revolution: int = -1    # Umdrehung der gewählten Kopie
+    deleted: bool = False   # IBM: Deleted Data Address Mark
+
+
+@dataclass
+class DriveEvent:
+    """Signaländerung am Laufwerk (UFI_EVT_DRIVE_SIGNALS)"""
+    drive: int
+    signals: int        # Aktueller Zustand (DRIVE_SIG_*)
+    changed: int        # Geänderte Bits
+    timestamp_ms: int   # STM32 HAL_GetTick()
+    
+    @property
+    def disk_inserted(self) -> bool:
+        """Index-Pulse sind (wieder) da"""
+        return bool(self.changed & DRIVE_SIG_INDEX and self.signals & DRIVE_SIG_INDEX)
 
 
 @dataclass
@@ -115,22 +316,129 @@ class ProcessingResult:
     raw_flux: Optional[FluxTrack] = None
     warnings: List[str] = field(default_factory=list)
     protection_info: Dict = field(default_factory=dict)
+    track_raw: Optional[bytes] = None   # Roher Track einer Umdrehung (G64-Bitzellen, NIB-Nibbles)
 
 
 # ============================================================================
 # USB KOMMUNIKATION MIT STM32
 # ============================================================================
 
+def parse_telemetry(raw: bytes) -> Dict:
+    """ufi_telemetry_t → Dict; Zyklen-Gauges zusätzlich in µs"""
+    size, version, cpu_hz, uptime_ms, since_reset_ms = TELEMETRY_HEADER.unpack_from(raw, 0)
+    offset = TELEMETRY_HEADER.size
+    
+    counters = struct.unpack_from(f'<{len(TELEMETRY_COUNTERS)}I', raw, offset)
+    offset += 4 * len(TELEMETRY_COUNTERS)
+    
+    result = {
+        'version': version,
+        'cpu_hz': cpu_hz,
+        'uptime_ms': uptime_ms,
+        'since_reset_ms': since_reset_ms,
+        'counters': dict(zip(TELEMETRY_COUNTERS, counters)),
+        'gauges': {},
+    }
+    
+    for name in TELEMETRY_GAUGES:
+        count, vmin, vmax, last, total = TELEMETRY_GAUGE.unpack_from(raw, offset)
+        offset += TELEMETRY_GAUGE.size
+        gauge = {
+            'count': count,
+            'min': vmin if count else 0,
+            'max': vmax,
+            'last': last,
+            'avg': total / count if count else 0.0,
+        }
+        if name in TELEMETRY_CYCLE_GAUGES and cpu_hz:
+            scale = 1e6 / cpu_hz
+            gauge.update({f'{k}_us': gauge[k] * scale for k in ('min', 'max', 'last', 'avg')})
+        result['gauges'][name] = gauge
+    
+    if version >= 2:
+        values = TELEMETRY_RPM.unpack_from(raw, offset)
+        samples, bins = values[0], values[1]
+        rpm = dict(zip(TELEMETRY_RPM_FIELDS, values[2:10]))
+        rpm['samples'] = samples
+        rpm['rpm'] = rpm.pop('rpm_x100') / 100
+        rpm['flutter_ppm'] = list(values[10:10 + bins])
+        result['rpm'] = rpm
+    
+    return result
+
+
+def telemetry_to_prometheus(t: Dict) -> str:
+    """Telemetrie im Prometheus Text-Format"""
+    lines = [f'ufi_uptime_seconds {t["uptime_ms"] / 1000:.3f}',
+             f'ufi_since_reset_seconds {t["since_reset_ms"] / 1000:.3f}']
+    for name, value in t['counters'].items():
+        lines.append(f'ufi_{name}_total {value}')
+    for name, gauge in t['gauges'].items():
+        unit = '_us' if 'avg_us' in gauge else ''
+        for stat in ('min', 'max', 'avg', 'last'):
+            lines.append(f'ufi_{name}{unit}{{stat="{stat}"}} {gauge[stat + unit]}')
+        lines.append(f'ufi_{name}_samples_total {gauge["count"]}')
+    if 'rpm' in t:
+        rpm = t['rpm']
+        lines.append(f'ufi_rpm {rpm["rpm"]}')
+        lines.append(f'ufi_rpm_window_samples {rpm["samples"]}')
+        for name in ('period_mean_ns', 'period_std_ns', 'wow_rms_ppm', 'wow_pp_ppm'):
+            lines.append(f'ufi_{name} {rpm[name]}')
+        for k, ppm in enumerate(rpm['flutter_ppm'], 1):
+            lines.append(f'ufi_flutter_ppm{{bin="{k}"}} {ppm}')
+    return '\n'.join(lines) + '\n'
+
+
+class SocketEndpoint:
+    """
+    Bulk-Endpunkt des virtuellen Geräts (TCP), gleiche Schnittstelle wie pyusb
+    
+    OUT: pro Transfer [Länge u16][Daten], IN: Bytestrom. read() liefert
+    genau `size` Bytes, bei Timeout usb.core.USBTimeoutError wie pyusb.
+    """
+    
+    def __init__(self, sock: socket.socket):
+        self.sock = sock
+    
+    def write(self, data: bytes) -> int:
+        self.sock.sendall(struct.pack('<H', len(data)) + data)
+        return len(data)
+    
+    def read(self, size: int, timeout: int = 1000) -> bytes:
+        buf = bytearray(size)
+        view = memoryview(buf)
+        deadline = time.monotonic() + timeout / 1000
+        pos = 0
+        while pos < size:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                raise usb.core.USBTimeoutError('Timeout', None, None)
+            self.sock.settimeout(remaining)
+            try:
+                n = self.sock.recv_into(view[pos:])
+            except socket.timeout:
+                continue
+            if n == 0:
+                raise ConnectionError("Virtuelles Gerät getrennt")
+            pos += n
+        return bytes(buf)
+
+
 class STM32Connection:
-    """USB Verbindung zum STM32 Flux Engine"""
+    """USB Verbindung zum STM32 Flux Engine (oder virtuelles Gerät per TCP)"""
     
-    def __init__(self):
+    def __init__(self, device: Optional[str] = None):
+        self.device = device or os.environ.get(UFI_DEVICE_ENV)
         self.dev = None
         self.ep_in = None
         self.ep_out = None
+        self.events: deque = deque(maxlen=256)
     
     def connect(self) -> bool:
         """Verbindung zum STM32 herstellen"""
+        if self.device:
+            return self._connect_socket(self.device)
+        
         self.dev = usb.core.find(idVendor=UFI_VID, idProduct=UFI_PID)
         if self.dev is None:
             log.error("STM32 nicht gefunden!")
@@ -150,21 +458,146 @@ class STM32Connection:
         log.info("STM32 verbunden")
         return True
     
-    def send_command(self, cmd: int, data: bytes = b'') -> bytes:
-        """Befehl an STM32 senden und Antwort empfangen"""
-        packet = struct.pack('<BH', cmd, len(data)) + data
+    def _connect_socket(self, url: str) -> bool:
+        """Virtuelles Gerät (tcp://host:port)"""
+        host, _, port = url.removeprefix('tcp://').rpartition(':')
+        try:
+            sock = socket.create_connection((host or '127.0.0.1', int(port)), timeout=5)
+        except (OSError, ValueError) as e:
+            log.error(f"Virtuelles Gerät {url} nicht erreichbar: {e}")
+            return False
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.ep_in = self.ep_out = SocketEndpoint(sock)
+        log.info(f"Virtuelles Gerät {url} verbunden")
+        return True
+    
+    def send_command(self, cmd: int, data: bytes = b'', timeout: int = 5000) -> bytes:
+        """Befehl an STM32 senden und Antwort empfangen (timeout in ms bis zur Antwort)"""
+        # Ein Bulk-Transfer [Befehl][Parameter], wie cmd_buffer in ufi_usb.c
+        packet = struct.pack('<B', cmd) + data
         self.ep_out.write(packet)
         
-        # Antwort lesen
-        response = self.ep_in.read(4, timeout=5000)
-        cmd_echo, status, length = struct.unpack('<BBH', bytes(response))
+        # Antwort lesen (dazwischen eintreffende Events puffern)
+        while True:
+            response = self.ep_in.read(4, timeout=timeout)
+            cmd_echo, status, length = struct.unpack('<BBH', bytes(response))
+            if cmd_echo != UFI_EVT_DRIVE_SIGNALS:
+                break
+            self._queue_event(bytes(self.ep_in.read(length, timeout=5000)))
+        
+        payload = bytes(self.ep_in.read(length, timeout=5000)) if length > 0 else b''
         
+        # Fehler-Antworten können Teildaten tragen (FAST_LOAD/FAST_RECV),
+        # sie werden trotzdem gelesen, sonst verschiebt sich der Strom
         if status != 0:
             raise Exception(f"STM32 Fehler: {status}")
         
-        if length > 0:
-            return bytes(self.ep_in.read(length, timeout=5000))
-        return b''
+        return payload
+    
+    def _queue_event(self, payload: bytes):
+        """Event-Daten (drive_event_t) dekodieren und puffern"""
+        drive, signals, changed, _, ts = struct.unpack('<BBBBI', payload[:8])
+        self.events.append(DriveEvent(drive, signals, changed, ts))
+    
+    def enable_events(self, mask: int = DRIVE_SIG_DISK_CHANGE | DRIVE_SIG_INDEX):
+        """Signal-Events aktivieren (0 = aus)"""
+        self.send_command(0x03, struct.pack('<B', mask))  # UFI_CMD_SET_EVENTS
+    
+    def wait_event(self, timeout_ms: int = 1000) -> Optional[DriveEvent]:
+        """Auf nächstes Laufwerk-Event warten (ohne Befehl zu senden)"""
+        if self.events:
+            return self.events.popleft()
+        try:
+            header = self.ep_in.read(4, timeout=timeout_ms)
+        except usb.core.USBTimeoutError:
+            return None
+        cmd_echo, _, length = struct.unpack('<BBH', bytes(header))
+        payload = bytes(self.ep_in.read(length, timeout=1000)) if length else b''
+        if cmd_echo != UFI_EVT_DRIVE_SIGNALS:
+            log.warning(f"Unerwartete Antwort 0x{cmd_echo:02X} ohne Befehl")
+            return None
+        self._queue_event(payload)
+        return self.events.popleft()
+    
+    def get_telemetry(self, reset: bool = False) -> Dict:
+        """Laufzeit-Zähler und Gauges lesen (optional danach nullen)"""
+        raw = self.send_command(0x04, struct.pack('<B', int(reset)))  # UFI_CMD_GET_TELEMETRY
+        return parse_telemetry(raw)
+    
+    def iec_load(self, device: int, name: str) -> bytes:
+        """Datei über IEC laden (komplett auf dem STM32, eine Antwort)"""
+        raw = name.encode('ascii')
+        data = struct.pack('<BB', device, len(raw)) + raw
+        return self.send_command(0x49, data)  # UFI_CMD_IEC_LOAD
+
+    def iec_fast_load(self, device: int, name: str) -> Tuple[bytes, bool]:
+        """Datei mit JiffyDOS laden (Fallback Standard) - (Daten, jiffy)"""
+        raw = name.encode('ascii')
+        data = struct.pack('<BB', device, len(raw)) + raw
+        result = self.send_command(0x4C, data)  # UFI_CMD_IEC_FAST_LOAD
+        return result[1:], bool(result[0])
+
+    def iec_mem_write(self, device: int, addr: int, code: bytes):
+        """Drive-Code in Laufwerk-RAM schreiben (M-W, max. 255 Bytes pro Befehl)"""
+        for off in range(0, len(code), 255):
+            chunk = code[off:off + 255]
+            data = struct.pack('<BHB', device, addr + off, len(chunk)) + chunk
+            self.send_command(0x4A, data)  # UFI_CMD_IEC_MEM_WRITE
+
+    def iec_mem_exec(self, device: int, addr: int):
+        """Drive-Code starten (M-E)"""
+        self.send_command(0x4B, struct.pack('<BH', device, addr))  # UFI_CMD_IEC_MEM_EXEC
+
+    def iec_fast_receive(self, count: int, mode: int = 2) -> bytes:
+        """Bytes über Fast-Protokoll empfangen (2 = UFI 2-Bit, 1 = JiffyDOS)"""
+        return self.send_command(0x4D, struct.pack('<BH', mode, count))  # UFI_CMD_IEC_FAST_RECV
+
+    def iec_read_image(self, device: int = 8, fmt: str = 'd64') -> bytes:
+        """
+        Sektor-Image über IEC lesen (Drive-Code + 2-Bit Protokoll, 1581 Standard)
+        Error-Info Bytes werden nur angehängt, wenn ein Sektor fehlerhaft ist.
+        Ein nicht lesbarer Track wird als Fehler 74 eingetragen, das Lesen geht weiter.
+        """
+        disk_type, tracks, sides = IEC_IMAGE_FORMATS[fmt]
+        begin = struct.pack('<BB', device, disk_type)
+        self.send_command(0x4E, begin, timeout=30000)  # UFI_CMD_IEC_DISK_BEGIN
+        
+        image = bytearray()
+        errors = bytearray()
+        for side in range(sides):
+            for track in range(1, tracks + 1):
+                sectors = 40 if fmt == 'd81' else c64_zone(track - 1)[1]
+                try:
+                    raw = self.send_command(0x4F, struct.pack('<BB', track, side),  # UFI_CMD_IEC_DISK_TRACK
+                                            timeout=sectors * IEC_SECTOR_TIMEOUT_MS)
+                except usb.core.USBTimeoutError:
+                    raise
+                except Exception as e:
+                    # Firmware hat das Laufwerk zurückgesetzt: Drive-Code neu laden
+                    log.warning(f"IEC Track {track}/{side} nicht lesbar: {e}")
+                    image += bytes(sectors * 256)
+                    errors += bytes([IEC_STATUS_NOT_READY]) * sectors
+                    self.send_command(0x4E, begin, timeout=30000)
+                    continue
+                
+                # Frames [Sektor, Status, 256 Bytes] in Lese-Reihenfolge
+                count = len(raw) // 258
+                blocks = [b''] * count
+                status = [1] * count
+                for off in range(0, count * 258, 258):
+                    sector = raw[off]
+                    status[sector] = raw[off + 1]
+                    blocks[sector] = raw[off + 2:off + 258]
+                
+                image += b''.join(blocks)
+                errors += bytes(status)
+                bad = sum(1 for e in status if e != 1)
+                if bad:
+                    log.warning(f"IEC Track {track}/{side}: {bad} fehlerhafte Sektoren")
+        
+        if any(e != 1 for e in errors):
+            image += errors
+        return bytes(image)
     
     def read_track(self, track: int, side: int, revolutions: int = 3) -> FluxTrack:
         """Track vom Laufwerk lesen"""
@@ -176,26 +609,633 @@ class STM32Connection:
         flux_track = FluxTrack(track=track, side=side, revolutions=[])
         
         for _ in range(revolutions):
-            # Header lesen
-            header_data = self.ep_in.read(16, timeout=10000)
+            # Header lesen (flux_packet_header_t, 12 Bytes)
+            header_data = self._read_flux_header()
             trk, sid, rev, flags, idx_time, sample_count = struct.unpack(
-                '<BBBBII', bytes(header_data)
+                '<BBBBII', header_data
             )
             
-            # Samples lesen
+            # Samples lesen (ohne Kopie als uint32-Array über dem Puffer)
             samples_data = self.ep_in.read(sample_count * 4, timeout=10000)
-            timestamps = struct.unpack(f'<{sample_count}I', bytes(samples_data))
+            ticks = np.frombuffer(samples_data, dtype='<u4', count=sample_count)
             
             # Revolution erstellen
-            samples = [FluxSample(timestamp=t) for t in timestamps]
             flux_rev = FluxRevolution(
-                samples=samples,
+                ticks=ticks,
                 index_time=idx_time,
                 revolution=rev
             )
             flux_track.revolutions.append(flux_rev)
         
         return flux_track
+    
+    def _read_flux_header(self) -> bytes:
+        """Nächsten Flux-Header lesen, Events zwischen den Umdrehungen puffern
+        
+        task_drive darf zwischen zwei Revolution-Frames ein Event stellen.
+        Es ist ebenfalls 12 Bytes lang, unterscheidet sich aber im ersten
+        Byte (Event-ID statt Track-Nummer).
+        """
+        while True:
+            head = bytes(self.ep_in.read(4, timeout=10000))
+            if head[0] != UFI_EVT_DRIVE_SIGNALS:
+                return head + bytes(self.ep_in.read(8, timeout=10000))
+            _, _, length = struct.unpack('<BBH', head)
+            self._queue_event(bytes(self.ep_in.read(length, timeout=10000)))
+
+
+# ============================================================================
+# SEKTOR-DEKODIERUNG
+# ============================================================================
+
+# Bitzellen-Takt je Format (ns, normiert auf 300 RPM)
+FORMAT_CLOCK_NS = {
+    DiskFormat.PC_MFM_DD: MFM_CELL_NS,
+    DiskFormat.PC_MFM_HD: MFM_CELL_NS / 2,
+    DiskFormat.PC_MFM_ED: MFM_CELL_NS / 4,
+    DiskFormat.AMIGA_DD: MFM_CELL_NS,
+    DiskFormat.AMIGA_HD: MFM_CELL_NS / 2,
+    DiskFormat.APPLE_II_GCR: APPLE_CELL_NS,
+}
+
+# Intervalle in Bitzellen je Kodierung (MFM: 1-3 Nullen, GCR: 0-2 Nullen)
+ENCODING_CELLS = {
+    'mfm': (2, 3, 4),
+    'gcr': (1, 2, 3),
+}
+
+FORMAT_ENCODING = {
+    DiskFormat.PC_MFM_DD: 'mfm',
+    DiskFormat.PC_MFM_HD: 'mfm',
+    DiskFormat.PC_MFM_ED: 'mfm',
+    DiskFormat.AMIGA_DD: 'mfm',
+    DiskFormat.AMIGA_HD: 'mfm',
+    DiskFormat.C64_GCR: 'gcr',
+    DiskFormat.C64_GCR_40: 'gcr',
+    DiskFormat.APPLE_II_GCR: 'gcr',
+}
+
+AMIGA_SECTORS = {
+    DiskFormat.AMIGA_DD: 11,
+    DiskFormat.AMIGA_HD: 22,
+}
+
+C64_FORMATS = (DiskFormat.C64_GCR, DiskFormat.C64_GCR_40)
+
+# GCR: zwei Quintette (10 Bit) → Byte, -1 = ungültiger Code
+GCR_DECODE_10 = np.full(1024, -1, dtype=np.int16)
+for _hi, _code_hi in enumerate(GCR_ENCODE):
+    for _lo, _code_lo in enumerate(GCR_ENCODE):
+        GCR_DECODE_10[(_code_hi << 5) | _code_lo] = (_hi << 4) | _lo
+GCR_WEIGHTS_10 = (1 << np.arange(9, -1, -1)).astype(np.uint16)
+
+
+# Apple: Nibble → 6 bzw. 5 Bit, -1 = ungültig
+APPLE_READ_62 = np.full(256, -1, dtype=np.int16)
+APPLE_READ_62[list(APPLE_WRITE_62)] = np.arange(64)
+APPLE_READ_53 = np.full(256, -1, dtype=np.int16)
+APPLE_READ_53[list(APPLE_WRITE_53)] = np.arange(32)
+
+
+def c64_zone(track: int) -> Tuple[int, int]:
+    """1541-Zone eines Tracks (0-basiert): Bitzelle in ns, Sektoren"""
+    for last, cell_ns, sectors in C64_ZONES:
+        if track < last:
+            return cell_ns, sectors
+    return C64_ZONES[-1][1:]
+
+
+def format_clock_ns(fmt: DiskFormat, track: int) -> Optional[float]:
+    """Bitzellen-Takt eines Formats auf einem Track (None = unbekannt)"""
+    if fmt in C64_FORMATS:
+        return c64_zone(track)[0]
+    return FORMAT_CLOCK_NS.get(fmt)
+
+
+@dataclass
+class ClockFit:
+    """Bitzellen-Takt aus dem Intervall-Histogramm"""
+    encoding: str           # Schlüssel in ENCODING_CELLS
+    clock_ns: float
+    error: float            # mittlere Abweichung der Spitzen in Zellen
+
+
+def fit_clock(hist: np.ndarray, bin_ns: float) -> List[ClockFit]:
+    """
+    Bitzellen-Takt aus den Spitzen eines Intervall-Histogramms
+    
+    Spitzen: lokale Maxima des geglätteten Histogramms mit mindestens
+    CLOCK_PEAK_SHARE der Intervalle, Lage als Schwerpunkt über ±2 Bins.
+    Je Kodierung bestimmt die kürzeste Spitze den Takt, ein gewichteter
+    Ausgleich über alle Spitzen verfeinert ihn. Liefert die passenden
+    Kodierungen, beste zuerst (eine einzelne Spitze passt zu beiden).
+    """
+    h = hist[:-1].astype(np.float64)    # letzter Bin: Überläufe
+    total = h.sum()
+    if total == 0:
+        return []
+    
+    smooth = np.convolve(h, (1, 2, 1), mode='same')
+    is_peak = (smooth[1:-1] >= smooth[:-2]) & (smooth[1:-1] > smooth[2:]) & \
+              (smooth[1:-1] >= 4 * CLOCK_PEAK_SHARE * total)
+    centers = (np.arange(h.size) + 0.5) * bin_ns
+    peaks, weights = [], []
+    for k in np.flatnonzero(is_peak) + 1:
+        lo, hi = max(k - 2, 0), k + 3
+        w = h[lo:hi].sum()
+        peaks.append(float((h[lo:hi] * centers[lo:hi]).sum() / w))
+        weights.append(w)
+    if not peaks:
+        return []
+    peaks, weights = np.array(peaks), np.array(weights)
+    
+    fits = []
+    for encoding, cells in ENCODING_CELLS.items():
+        clock = peaks[0] / cells[0]
+        n = np.rint(peaks / clock)
+        clock = float((weights * peaks * n).sum() / (weights * n * n).sum())
+        n = np.rint(peaks / clock)
+        # Spitzen ohne erlaubte Zellzahl zählen als ganze Zelle Abweichung
+        err = np.where(np.isin(n, cells), np.abs(peaks / clock - n), 1.0)
+        error = float((weights * err).sum() / weights.sum())
+        if error <= CLOCK_FIT_MAX_ERROR:
+            fits.append(ClockFit(encoding, clock, error))
+    return sorted(fits, key=lambda f: f.error)
+
+
+def gcr_decode(raw: np.ndarray) -> np.ndarray:
+    """GCR-Bytes (Blöcke × 5n) → Bytes (Blöcke × 4n) per Tabelle, -1 = ungültig"""
+    cells = np.unpackbits(raw, axis=1).reshape(raw.shape[0], -1, 10)
+    return GCR_DECODE_10[cells.dot(GCR_WEIGHTS_10)]
+
+
+@dataclass
+class DecodedTrack:
+    """Sektoren eines Tracks plus formatspezifische Track-Informationen"""
+    sectors: List[Sector]
+    info: Dict = field(default_factory=dict)
+
+
+def phase_quality(bits: ufi_flux_core.Bitstream):
+    """
+    Qualität eines Bitzellen-Bereichs aus den PLL-Phasenfehlern
+    
+    Liefert eine Funktion (start, end) → 0..100: 100 = alle Flanken in
+    Zellmitte, 0 = mittlerer Fehler von einer halben Zelle (Rauschen).
+    """
+    valid = bits.bit_pos != 0xFFFFFFFF
+    pos = bits.bit_pos[valid]
+    err = np.concatenate(([0], np.cumsum(np.abs(bits.phase[valid].astype(np.int32)))))
+    
+    def quality(start: int, end: int) -> float:
+        a, b = np.searchsorted(pos, (start, end))
+        if b <= a:
+            return 0.0
+        mean = (err[b] - err[a]) / (b - a)
+        return float(max(0.0, 100.0 - mean * 100.0 / 63.5))
+    
+    return quality
+
+
+def best_sectors(candidates: List[Sector]) -> List[Sector]:
+    """Beste Kopie je Sektor: CRC vor Qualität"""
+    best: Dict[Tuple[int, int, int], Sector] = {}
+    for s in candidates:
+        key = (s.cylinder, s.head, s.number)
+        cur = best.get(key)
+        if cur is None or (s.crc_ok, s.quality) > (cur.crc_ok, cur.quality):
+            best[key] = s
+    return [best[k] for k in sorted(best)]
+
+
+class SectorDecoder:
+    """
+    Gemeinsamer Ablauf der Format-Decoder
+    
+    Jede Umdrehung wird unabhängig dekodiert (decode_revolution), pro
+    Sektor gewinnt die beste Kopie. Weitere Umdrehungen werden nur
+    dekodiert, solange die bisherigen beschädigte Felder enthalten; bleibt
+    keine fehlerfrei, kommt die fusionierte Umdrehung (Mehrheit je
+    Bitzelle) als weiterer Kandidat hinzu.
+    """
+    
+    def __init__(self, core: ufi_flux_core.FluxCore):
+        self.core = core
+    
+    def decode_revolution(self, bits: ufi_flux_core.Bitstream,
+                          revolution: int) -> Tuple[List[Sector], int]:
+        """Alle Sektoren einer Umdrehung und Anzahl beschädigter Felder"""
+        raise NotImplementedError
+    
+    def detect(self, bits: ufi_flux_core.Bitstream) -> bool:
+        """Format-Bestätigung: mindestens ein gültiger Sektor-Header"""
+        raise NotImplementedError
+    
+    def expected_sectors(self, track: int) -> int:
+        """Sektoren pro Track, falls vom Format fest vorgegeben (sonst 0)"""
+        return 0
+    
+    def track_info(self, info: Dict, bits: ufi_flux_core.Bitstream, clock_ns: float):
+        """Formatspezifische Track-Informationen (erste Umdrehung)"""
+    
+    def decode(self, track: FluxTrack, clock_ns: float,
+               seed_ns: Optional[float] = None) -> DecodedTrack:
+        """
+        Sektoren eines Tracks, beste Kopie aus den Umdrehungen
+        
+        clock_ns ist der Nominaltakt des Formats (Track-Länge), seed_ns der
+        gemessene Takt als Startwert des Datenseparators (sonst clock_ns).
+        """
+        candidates = []
+        info = {'track_cells': 0}
+        expected = self.expected_sectors(track.track)
+        pll_ns = seed_ns or clock_ns
+        aligned = track.aligned if track.aligned is not None and \
+            track.aligned.clock_ns == pll_ns else None
+        for i, rev in enumerate(track.revolutions):
+            if not rev.deltas_ns.size:
+                continue
+            if aligned is not None:
+                bits = aligned.bitstreams[i]    # Datenseparator schon gelaufen
+            else:
+                bits = self.core.pll_decode(rev.deltas_ns, pll_ns)
+            if not candidates:
+                self.track_info(info, bits, clock_ns)
+            info['track_cells'] = max(info['track_cells'], bits.nbits)
+            
+            sectors, damaged = self.decode_revolution(bits, rev.revolution)
+            candidates.extend(sectors)
+            # Fehlende Sektoren zählen mit (Sync zerstört)
+            damaged += max(0, expected - len({s.number for s in sectors}))
+            if sectors and damaged == 0:
+                break   # Umdrehung fehlerfrei, weitere ändern nichts
+        else:
+            if aligned is not None and aligned.count > 1:
+                sectors, _ = self.decode_revolution(aligned.fused, FUSED_REVOLUTION)
+                candidates.extend(sectors)
+        return DecodedTrack(best_sectors(candidates), info)
+
+
+class IbmMfmDecoder(SectorDecoder):
+    """
+    IBM-PC MFM (DD/HD/ED)
+    
+    Pro Umdrehung: PLL → 0x4489-Suche → A1-Dreiergruppen → IDAM/DAM-Paare
+    mit CRC-Prüfung.
+    """
+    
+    @staticmethod
+    def marks(syncs: np.ndarray) -> np.ndarray:
+        """Bitposition der Adressmarke hinter jeder Folge von drei Syncs"""
+        s = syncs.astype(np.int64)
+        if s.size < 3:
+            return s[:0]
+        triple = (s[1:-1] - s[:-2] == 16) & (s[2:] - s[1:-1] == 16)
+        last = s[2:]
+        # Nur die letzte Dreiergruppe einer längeren Folge
+        following = np.append(s[3:], -1)
+        return last[triple & (following != last + 16)] + 16
+    
+    def detect(self, bits: ufi_flux_core.Bitstream) -> bool:
+        """IDAM mit gültiger CRC"""
+        for m in self.marks(self.core.find_sync(bits, MFM_SYNC, 16)):
+            header = self.core.mfm_data(bits, int(m), 7)
+            if header[0] == IBM_IDAM and self.core.crc16(header, MFM_SYNC_CRC) == 0:
+                return True
+        return False
+    
+    def decode_revolution(self, bits: ufi_flux_core.Bitstream,
+                          revolution: int) -> Tuple[List[Sector], int]:
+        sectors = []
+        damaged = 0
+        marks = self.marks(self.core.find_sync(bits, MFM_SYNC, 16))
+        quality = phase_quality(bits)
+        
+        paired = -1
+        for i, m in enumerate(marks):
+            m = int(m)
+            header = self.core.mfm_data(bits, m, 7)
+            if header[0] != IBM_IDAM:
+                if i != paired:
+                    damaged += 1    # Daten ohne ID oder unbekannte Marke
+                continue
+            if self.core.crc16(header, MFM_SYNC_CRC) != 0:
+                damaged += 1
+                continue
+            if i + 1 >= len(marks) or marks[i + 1] - m > IBM_ID_TO_DAM_MAX * 16:
+                damaged += 1    # ID ohne Daten
+                continue
+            
+            d = int(marks[i + 1])
+            mark = self.core.mfm_data(bits, d, 1)[0]
+            if mark not in (IBM_DAM, IBM_DDAM):
+                damaged += 1
+                continue
+            paired = i + 1
+            
+            cylinder, head, number, size_code = header[1:5]
+            size = 128 << (size_code & 7)
+            block = self.core.mfm_data(bits, d, 1 + size + 2)
+            
+            crc_ok = self.core.crc16(block, MFM_SYNC_CRC) == 0
+            damaged += not crc_ok
+            sectors.append(Sector(
+                number=number,
+                data=block[1:1 + size],
+                crc_ok=crc_ok,
+                quality=quality(m, d + len(block) * 16),
+                cylinder=cylinder,
+                head=head,
+                revolution=revolution,
+                deleted=mark == IBM_DDAM,
+            ))
+        
+        return sectors, damaged
+
+
+class AmigaDecoder(SectorDecoder):
+    """
+    AmigaDOS trackdisk (DD 11 / HD 22 Sektoren)
+    
+    Alle Sektoren einer Umdrehung werden als Matrix (Sektor × MFM-Langwort)
+    verarbeitet: odd/even-Zusammenführung und Prüfsummen als Bit-
+    Operationen über den ganzen Track statt pro Sektor.
+    """
+    
+    def __init__(self, core: ufi_flux_core.FluxCore, sectors: int):
+        super().__init__(core)
+        self.sectors = sectors
+    
+    def _parse(self, bits: ufi_flux_core.Bitstream):
+        """Sync-Positionen und Rohdaten aller Sektoren einer Umdrehung"""
+        syncs = self.core.find_sync(bits, AMIGA_SYNC, 32).astype(np.int64)
+        # Bei drei Sync-Wörtern in Folge nur den letzten Treffer
+        if syncs.size:
+            syncs = syncs[np.append(syncs[1:] != syncs[:-1] + 16, True)]
+        raw = b''.join(self.core.raw_bits(bits, int(p) + 32, AMIGA_SECTOR_RAW) for p in syncs)
+        words = np.frombuffer(raw, dtype='>u4').astype(np.uint32).reshape(len(syncs), AMIGA_SECTOR_RAW // 4)
+        return syncs, words & np.uint32(AMIGA_MFM_MASK)
+    
+    @staticmethod
+    def _merge(odd: np.ndarray, even: np.ndarray) -> np.ndarray:
+        return (odd << np.uint32(1)) | even
+    
+    def _headers(self, w: np.ndarray):
+        """Info-Langwort und Header-Prüfung je Sektor"""
+        info = self._merge(w[:, 0], w[:, 1])
+        header_sum = self._merge(w[:, 10], w[:, 11])
+        header_ok = (
+            (header_sum == np.bitwise_xor.reduce(w[:, 0:10], axis=1)) &
+            (info >> 24 == 0xFF) &
+            ((info >> 8) & 0xFF < self.sectors)
+        )
+        return info, header_ok
+    
+    def detect(self, bits: ufi_flux_core.Bitstream) -> bool:
+        """Sektor-Header mit gültiger Prüfsumme"""
+        _, w = self._parse(bits)
+        return bool(w.size) and bool(self._headers(w)[1].any())
+    
+    def decode_revolution(self, bits: ufi_flux_core.Bitstream,
+                          revolution: int) -> Tuple[List[Sector], int]:
+        syncs, w = self._parse(bits)
+        if not syncs.size:
+            return [], 0
+        
+        info, header_ok = self._headers(w)
+        data_ok = self._merge(w[:, 12], w[:, 13]) == np.bitwise_xor.reduce(w[:, 14:], axis=1)
+        data = self._merge(w[:, 14:142], w[:, 142:270]).astype('>u4')
+        quality = phase_quality(bits)
+        
+        sectors = []
+        for i in np.flatnonzero(header_ok):
+            track_no = int(info[i] >> 16) & 0xFF
+            sectors.append(Sector(
+                number=int(info[i] >> 8) & 0xFF,
+                data=data[i].tobytes(),
+                crc_ok=bool(data_ok[i]),
+                quality=quality(int(syncs[i]), int(syncs[i]) + 32 + AMIGA_SECTOR_RAW * 8),
+                cylinder=track_no >> 1,
+                head=track_no & 1,
+                revolution=revolution,
+            ))
+        
+        damaged = int((~header_ok).sum() + (~data_ok[header_ok]).sum())
+        return sectors, damaged
+    
+    def expected_sectors(self, track: int) -> int:
+        return self.sectors
+    
+    def track_info(self, info: Dict, bits: ufi_flux_core.Bitstream, clock_ns: float):
+        # Nominal: 200 ms Umdrehung (300 RPM) / Bitzelle
+        nominal = 60e9 / 300 / clock_ns
+        if bits.nbits > nominal * AMIGA_LONG_TRACK:
+            info['long_track'] = True
+
+
+class C64GcrDecoder(SectorDecoder):
+    """
+    Commodore 1541 GCR (35/40 Tracks, vier Geschwindigkeitszonen)
+    
+    Alle Blöcke einer Umdrehung (Header und Daten) werden gemeinsam als
+    Matrix per 10-Bit-Tabelle dekodiert; Prüfsummen als XOR-Reduktion.
+    """
+    
+    def _blocks(self, bits: ufi_flux_core.Bitstream):
+        """Blockanfänge (erste Zelle nach dem Sync) und dekodierte Blöcke"""
+        ones = self.core.find_sync(bits, (1 << C64_SYNC_BITS) - 1, C64_SYNC_BITS).astype(np.int64)
+        if not ones.size:
+            return ones, np.zeros((0, C64_BLOCK_RAW * 4 // 5), dtype=np.int16)
+        # Letzter Treffer einer Einsen-Folge endet direkt vor dem Block
+        starts = ones[np.append(ones[1:] != ones[:-1] + 1, True)] + C64_SYNC_BITS
+        raw = b''.join(self.core.raw_bits(bits, int(p), C64_BLOCK_RAW) for p in starts)
+        raw = np.frombuffer(raw, dtype=np.uint8).reshape(len(starts), C64_BLOCK_RAW)
+        return starts, gcr_decode(raw)
+    
+    @staticmethod
+    def _headers(d: np.ndarray) -> np.ndarray:
+        return (
+            (d[:, 0] == C64_HEADER) &
+            (d[:, :8] >= 0).all(axis=1) &
+            (d[:, 1] == d[:, 2] ^ d[:, 3] ^ d[:, 4] ^ d[:, 5])
+        )
+    
+    def detect(self, bits: ufi_flux_core.Bitstream) -> bool:
+        """Header-Block mit gültiger Prüfsumme"""
+        _, d = self._blocks(bits)
+        return bool(self._headers(d).any())
+    
+    def decode_revolution(self, bits: ufi_flux_core.Bitstream,
+                          revolution: int) -> Tuple[List[Sector], int]:
+        starts, d = self._blocks(bits)
+        if not starts.size:
+            return [], 0
+        
+        header_ok = self._headers(d)
+        is_data = d[:, 0] == C64_DATA
+        data_ok = (
+            is_data &
+            (d[:, :258] >= 0).all(axis=1) &
+            (np.bitwise_xor.reduce(d[:, 1:257], axis=1) == d[:, 257])
+        )
+        quality = phase_quality(bits)
+        
+        sectors = []
+        damaged = 0
+        paired = -1
+        for i in range(len(starts)):
+            if not header_ok[i]:
+                if i != paired:
+                    damaged += 1    # Daten ohne Header oder ungültiger Block
+                continue
+            j = i + 1
+            if j >= len(starts) or not is_data[j] or \
+                    starts[j] - starts[i] > C64_HEADER_TO_DATA_MAX * 8:
+                damaged += 1        # Header ohne Daten
+                continue
+            paired = j
+            damaged += not data_ok[j]
+            
+            sectors.append(Sector(
+                number=int(d[i, 2]),
+                data=np.clip(d[j, 1:257], 0, 255).astype(np.uint8).tobytes(),
+                crc_ok=bool(data_ok[j]),
+                quality=quality(int(starts[i]), int(starts[j]) + C64_BLOCK_RAW * 8),
+                cylinder=int(d[i, 3]),      # C64-Tracknummer (1-35/40)
+                head=0,
+                revolution=revolution,
+            ))
+        
+        return sectors, damaged
+    
+    def expected_sectors(self, track: int) -> int:
+        return c64_zone(track)[1]
+    
+    def track_info(self, info: Dict, bits: ufi_flux_core.Bitstream, clock_ns: float):
+        # Rohe Bitzellen ab Index für G64
+        info['track_raw'] = bits.bits[:G64_TRACK_MAX].tobytes()
+
+
+def denibble_62(values: np.ndarray) -> np.ndarray:
+    """6-and-2: 342 Werte (86 Zweier-, 256 Sechser-Gruppen) → 256 Bytes je Zeile"""
+    i = np.arange(256)
+    low = (values[:, i % 86] >> (2 * (i // 86))) & 3
+    low = ((low & 1) << 1) | (low >> 1)     # Bitpaare vertauscht gespeichert
+    return ((values[:, 86:342] << 2) | low).astype(np.uint8)
+
+
+def denibble_53(values: np.ndarray) -> np.ndarray:
+    """5-and-3: 410 Werte (154 Dreier- rückwärts, 256 Fünfer-Gruppen) → 256 Bytes je Zeile"""
+    threes = values[:, 153::-1]
+    top = values[:, 154:410] << 3
+    g = np.arange(50, -1, -1)               # Gruppe von 5 Bytes ab Byte 0
+    t0, t1, t2 = threes[:, g], threes[:, g + 51], threes[:, g + 102]
+    out = np.empty((len(values), 51, 5), dtype=np.int16)
+    out[:, :, 0] = top[:, g] | (t0 >> 2)
+    out[:, :, 1] = top[:, g + 51] | (t1 >> 2)
+    out[:, :, 2] = top[:, g + 102] | (t2 >> 2)
+    out[:, :, 3] = top[:, g + 153] | ((t0 & 2) << 1) | (t1 & 2) | ((t2 & 2) >> 1)
+    out[:, :, 4] = top[:, g + 204] | ((t0 & 1) << 2) | ((t1 & 1) << 1) | (t2 & 1)
+    last = top[:, 255] | (threes[:, 153] & 7)
+    return np.concatenate((out.reshape(len(values), 255), last[:, None]), axis=1).astype(np.uint8)
+
+
+class AppleDecoder(SectorDecoder):
+    """
+    Apple II GCR: DOS 3.3/ProDOS (16 Sektoren, 6-and-2), DOS 3.2 (13, 5-and-3)
+    
+    Die Nibbles kommen aus dem nativen Core (Controller-Schieberegister,
+    Self-Sync inklusive). Prologe werden als Vektorvergleich gesucht, alle
+    Datenfelder einer Umdrehung gemeinsam per Tabelle dekodiert; die
+    XOR-Verkettung der Prüfsumme ist eine Akkumulation über die Zeile.
+    """
+    
+    @staticmethod
+    def _prologues(nib: np.ndarray) -> np.ndarray:
+        if len(nib) < 3:
+            return np.zeros(0, dtype=np.int64)
+        return np.flatnonzero((nib[:-2] == 0xD5) & (nib[1:-1] == 0xAA))
+    
+    @staticmethod
+    def _addresses(nib: np.ndarray, starts: np.ndarray):
+        """Adressfelder (4-and-4): Volume, Track, Sektor, Prüfsumme je Zeile"""
+        starts = starts[starts + 11 <= len(nib)]
+        f = nib[starts[:, None] + 3 + np.arange(8)].astype(np.int16)
+        v = ((f[:, 0::2] << 1) | 1) & f[:, 1::2]
+        ok = (v[:, 0] ^ v[:, 1] ^ v[:, 2]) == v[:, 3]
+        return starts, v, ok
+    
+    @staticmethod
+    def _data_fields(nib: np.ndarray, starts: np.ndarray, size: int, table: np.ndarray):
+        """Datenfelder ab Prolog: Werte nach XOR-Kette und Prüfsumme ok"""
+        raw = table[nib[starts[:, None] + 3 + np.arange(size)]]
+        chain = np.bitwise_xor.accumulate(raw, axis=1)
+        ok = (raw >= 0).all(axis=1) & (chain[:, -1] == 0)
+        return np.maximum(chain[:, :-1], 0), ok
+    
+    def detect(self, bits: ufi_flux_core.Bitstream) -> bool:
+        """Adressfeld mit gültiger Prüfsumme"""
+        nib, _ = self.core.nibbles(bits)
+        p = self._prologues(nib)
+        p = p[np.isin(nib[p + 2], (APPLE_ADDR_16, APPLE_ADDR_13))]
+        return bool(self._addresses(nib, p)[2].any())
+    
+    def decode_revolution(self, bits: ufi_flux_core.Bitstream,
+                          revolution: int) -> Tuple[List[Sector], int]:
+        nib, pos = self.core.nibbles(bits)
+        p = self._prologues(nib)
+        kind = nib[p + 2]
+        addr, v, addr_ok = self._addresses(nib, p[(kind == APPLE_ADDR_16) | (kind == APPLE_ADDR_13)])
+        data = p[kind == APPLE_DATA]
+        if not addr.size:
+            return [], len(data)
+        
+        # Datenfeld je Adressfeld: nächster Datenprolog in Reichweite
+        variant_13 = nib[addr + 2] == APPLE_ADDR_13
+        size = np.where(variant_13, APPLE_DATA_53, APPLE_DATA_62)
+        nxt = np.searchsorted(data, addr)
+        j = data[np.minimum(nxt, len(data) - 1)] if data.size else addr
+        paired = addr_ok & (nxt < len(data)) & (j - addr <= APPLE_ADDR_TO_DATA_MAX) & \
+            (j + 3 + size <= len(nib))
+        
+        # Alle Datenfelder einer Kodierung auf einmal
+        fields = {}
+        for is_13, n, table, denibble in ((False, APPLE_DATA_62, APPLE_READ_62, denibble_62),
+                                          (True, APPLE_DATA_53, APPLE_READ_53, denibble_53)):
+            sel = np.flatnonzero(paired & (variant_13 == is_13))
+            if sel.size:
+                values, ok = self._data_fields(nib, j[sel], n, table)
+                for i, payload, crc_ok in zip(sel, denibble(values), ok):
+                    fields[i] = (payload.tobytes(), bool(crc_ok))
+        
+        quality = phase_quality(bits)
+        sectors = []
+        # Ungültige Adressfelder, Adressfelder ohne Daten, Daten ohne Adressfeld
+        damaged = int((~paired).sum()) + len(np.setdiff1d(data, j[paired]))
+        for i in sorted(fields):
+            payload, crc_ok = fields[i]
+            damaged += not crc_ok
+            end = min(int(j[i]) + 3 + int(size[i]), len(pos) - 1)
+            sectors.append(Sector(
+                number=int(v[i, 2]),
+                data=payload,
+                crc_ok=crc_ok,
+                quality=quality(int(pos[addr[i]]), int(pos[end])),
+                cylinder=int(v[i, 1]),      # Track aus dem Adressfeld
+                head=0,
+                revolution=revolution,
+            ))
+        
+        # Fehlende Sektoren (13 oder 16 je nach Adressprolog)
+        if addr_ok.any():
+            per_track = 13 if variant_13[addr_ok].all() else 16
+            damaged += max(0, per_track - len({s.number for s in sectors}))
+        return sectors, damaged
+    
+    def track_info(self, info: Dict, bits: ufi_flux_core.Bitstream, clock_ns: float):
+        # Nibble-Dump für NIB, mit Sync-Nibbles auf Track-Länge aufgefüllt
+        nib, _ = self.core.nibbles(bits)
+        info['track_raw'] = nib[:APPLE_NIB_TRACK].tobytes().ljust(APPLE_NIB_TRACK, b'\xff')
 
 
 # ============================================================================
@@ -208,9 +1248,33 @@ class FluxProcessor:
     def __init__(self):
         self.format_detectors = {
             DiskFormat.PC_MFM_DD: self._detect_pc_mfm,
+            DiskFormat.PC_MFM_HD: self._detect_pc_mfm,
+            DiskFormat.PC_MFM_ED: self._detect_pc_mfm,
             DiskFormat.AMIGA_DD: self._detect_amiga,
+            DiskFormat.AMIGA_HD: self._detect_amiga,
             DiskFormat.C64_GCR: self._detect_c64_gcr,
+            DiskFormat.APPLE_II_GCR: self._detect_apple_gcr,
         }
+        self.core = ufi_flux_core.load()
+        self.disk_format = DiskFormat.UNKNOWN   # bestätigt, zuerst geprüft (new_disk)
+        self.decoders: Dict[DiskFormat, SectorDecoder] = {}
+        if self.core is not None:
+            ibm = IbmMfmDecoder(self.core)
+            self.decoders = {
+                DiskFormat.PC_MFM_DD: ibm,
+                DiskFormat.PC_MFM_HD: ibm,
+                DiskFormat.PC_MFM_ED: ibm,
+                DiskFormat.AMIGA_DD: AmigaDecoder(self.core, AMIGA_SECTORS[DiskFormat.AMIGA_DD]),
+                DiskFormat.AMIGA_HD: AmigaDecoder(self.core, AMIGA_SECTORS[DiskFormat.AMIGA_HD]),
+            }
+            c64 = C64GcrDecoder(self.core)
+            for fmt in C64_FORMATS:
+                self.decoders[fmt] = c64
+            self.decoders[DiskFormat.APPLE_II_GCR] = AppleDecoder(self.core)
+    
+    def new_disk(self):
+        """Neue Disk: erkanntes Disk-Format verwerfen"""
+        self.disk_format = DiskFormat.UNKNOWN
     
     # ========================================================================
     # TIMING-NORMALISIERUNG
@@ -221,37 +1285,119 @@ class FluxProcessor:
         log.info(f"Timing-Normalisierung Track {track.track}/{track.side}")
         
         for rev in track.revolutions:
-            if len(rev.samples) < 2:
+            if rev.count == 0:
                 continue
             
-            # Delta-Zeiten berechnen
-            prev_ts = 0
-            for sample in rev.samples:
-                delta_ticks = sample.timestamp - prev_ts
-                sample.delta_ns = delta_ticks * FLUX_NS_PER_TICK
-                prev_ts = sample.timestamp
-            
             # Umdrehungs-Dauer und RPM
             rev.duration_ns = rev.index_time * FLUX_NS_PER_TICK
             if rev.duration_ns > 0:
                 rev.rpm = 60e9 / rev.duration_ns
             
-            # Auf Referenz-RPM normalisieren (300 RPM für DD)
-            if rev.rpm > 0:
-                scale = 300.0 / rev.rpm
-                for sample in rev.samples:
-                    sample.delta_ns *= scale
+            # Delta-Zeiten (erste Flanke relativ zum Index), dabei auf
+            # Referenz-RPM normalisieren (300 RPM für DD); Statistik für
+            # Format-Erkennung, Fehler und Kopierschutz im selben Durchlauf
+            scale = FLUX_NS_PER_TICK * (300.0 / rev.rpm if rev.rpm > 0 else 1.0)
+            rev.deltas_ns, rev.stats = self.analyze_revolution(rev.ticks, scale)
         
         return track
     
+    def analyze_revolution(self, ticks: np.ndarray,
+                           ns_per_tick: float) -> Tuple[np.ndarray, ufi_flux_core.FluxStats]:
+        """Intervalle und Statistik einer Umdrehung (Flux-Core: ein Aufruf)"""
+        if self.core is not None:
+            return self.core.analyze(ticks, ns_per_tick)
+        
+        # Ohne Flux-Core: gleiche Kennzahlen über mehrere numpy-Durchläufe
+        deltas = np.diff(ticks, prepend=np.uint32(0)).astype(np.float32) * np.float32(ns_per_tick)
+        bin_ns = ufi_flux_core.ANALYZE_BIN_NS
+        bins = ufi_flux_core.ANALYZE_BINS
+        hist = np.bincount(np.minimum(deltas / bin_ns, bins - 1).astype(np.intp),
+                           minlength=bins).astype(np.uint32)
+        median = float(np.median(deltas)) if deltas.size else 0.0
+        short = deltas < median * ufi_flux_core.ANALYZE_SHORT
+        long = deltas > median * ufi_flux_core.ANALYZE_LONG
+        
+        # Anomalie-Bereiche: Lücke > ANALYZE_RUN_GAP beginnt einen neuen
+        anomalies = np.flatnonzero(short | long)
+        starts = np.flatnonzero(np.diff(anomalies, prepend=-ufi_flux_core.ANALYZE_RUN_GAP - 1)
+                                > ufi_flux_core.ANALYZE_RUN_GAP)
+        ends = np.append(starts[1:], anomalies.size)[:starts.size] - 1
+        runs = np.stack([anomalies[starts], anomalies[ends] - anomalies[starts] + 1], axis=1)
+        
+        return deltas, ufi_flux_core.FluxStats(
+            count=int(deltas.size), hist=hist, bin_ns=bin_ns,
+            total_ns=float(deltas.sum(dtype=np.float64)), median_ns=median,
+            max_ns=float(deltas.max()) if deltas.size else 0.0,
+            short_count=int(short.sum()), long_count=int(long.sum()),
+            runs=runs[:ufi_flux_core.ANALYZE_MAX_RUNS].astype(np.uint32), nruns=int(starts.size))
+    
+    # ========================================================================
+    # BITZELLEN (DATENSEPARATOR)
+    # ========================================================================
+    
+    def to_bitstream(self, rev: FluxRevolution, clock_ns: float,
+                     count: Optional[int] = None) -> ufi_flux_core.Bitstream:
+        """Flux-Intervalle einer Umdrehung in Bitzellen (PLL im Flux-Core)"""
+        deltas = rev.deltas_ns if count is None else rev.deltas_ns[:count]
+        if self.core is not None:
+            return self.core.pll_decode(deltas, clock_ns)
+        
+        # Ohne Flux-Core: feste Zellbreite, keine Drehzahl-Nachführung
+        cells = np.rint(deltas / np.float32(clock_ns)).astype(np.int64)
+        phase = (deltas - cells * np.float32(clock_ns)) / np.float32(clock_ns) * 254
+        valid = cells > 0
+        bit_pos = np.full(cells.size, 0xFFFFFFFF, dtype=np.uint32)
+        bit_pos[valid] = np.cumsum(cells[valid]) - 1
+        nbits = int(cells[valid].sum())
+        bits = np.zeros(nbits, dtype=np.uint8)
+        bits[bit_pos[valid]] = 1
+        return ufi_flux_core.Bitstream(
+            bits=np.packbits(bits), nbits=nbits, bit_pos=bit_pos,
+            phase=np.clip(np.rint(phase), -127, 127).astype(np.int8), clock_ns=clock_ns)
+    
+    def align_bitstream(self, ref: ufi_flux_core.Bitstream,
+                        bits: ufi_flux_core.Bitstream) -> np.ndarray:
+        """Versatz je Fenster gegen die Referenz (Flux-Core, Drift nachgeführt)"""
+        if self.core is not None:
+            return self.core.align(ref, bits)[0]
+        
+        # Ohne Flux-Core: gleiche Suche, je Fenster alle Versätze auf einmal;
+        # Reihenfolge wie im Flux-Core (vorheriger, +1, -1, +2, ...), bei
+        # Gleichstand gewinnt der nächstliegende
+        window = ufi_flux_core.ALIGN_WINDOW
+        max_lag = ufi_flux_core.ALIGN_MAX_LAG
+        a, b = ref.unpacked(), bits.unpacked()
+        d = np.arange(2 * max_lag + 1)
+        steps = np.where(d & 1, (d + 1) // 2, -(d // 2))
+        shifts = np.zeros((ref.nbits + window - 1) // window, dtype=np.int32)
+        if b.size == 0:
+            return shifts
+        prev = 0
+        for w in range(shifts.size):
+            ref_win = a[w * window:(w + 1) * window]
+            idx = (w * window + prev + steps)[:, None] + np.arange(ref_win.size)
+            # Außerhalb der Umdrehung zählen Zellen als 0 (wie im Flux-Core)
+            cells = np.take(b, idx, mode='clip') & ((idx >= 0) & (idx < b.size))
+            prev += int(steps[np.argmin((cells != ref_win).sum(axis=1))])
+            shifts[w] = prev
+        return shifts
+    
     # ========================================================================
     # FEHLER-ERKENNUNG
     # ========================================================================
     
     def detect_errors(self, track: FluxTrack) -> List[str]:
-        """Fehler im Track erkennen"""
-        errors = []
+        """
+        Fehler im Track erkennen
         
+        Aus der Umdrehungsanalyse (normalize_timing), Ergebnis am Track
+        zwischengespeichert. Timing-Anomalien erscheinen als eine Meldung je
+        Umdrehung mit den ersten Bereichen, nicht als eine je Intervall.
+        """
+        if track.errors is not None:
+            return track.errors
+        
+        errors = []
         for rev in track.revolutions:
             # RPM prüfen
             if rev.rpm < 280 or rev.rpm > 320:
@@ -259,91 +1405,138 @@ class FluxProcessor:
             
             # Flux-Dichte prüfen
             expected_flux = 50000 if track.format in [DiskFormat.PC_MFM_DD, DiskFormat.AMIGA_DD] else 40000
-            if len(rev.samples) < expected_flux * 0.8:
-                errors.append(f"Rev {rev.revolution}: Zu wenig Flux-Übergänge ({len(rev.samples)})")
+            if rev.count < expected_flux * 0.8:
+                errors.append(f"Rev {rev.revolution}: Zu wenig Flux-Übergänge ({rev.count})")
             
-            # Timing-Ausreißer finden
-            deltas = [s.delta_ns for s in rev.samples if s.delta_ns > 0]
-            if deltas:
-                median = np.median(deltas)
-                for i, d in enumerate(deltas):
-                    if d > median * 3 or d < median * 0.3:
-                        errors.append(f"Rev {rev.revolution}: Timing-Anomalie bei Sample {i}")
+            # Timing-Ausreißer (< 0,3 / > 3 × Median), zu Bereichen zusammengefasst
+            stats = rev.stats
+            if stats is not None and stats.anomalies:
+                first = ', '.join(str(int(start)) for start, _ in stats.runs[:ERROR_RUNS_LISTED])
+                more = ', …' if stats.nruns > ERROR_RUNS_LISTED else ''
+                errors.append(f"Rev {rev.revolution}: {stats.anomalies} Timing-Anomalien "
+                              f"in {stats.nruns} Bereichen (ab Sample {first}{more})")
         
+        track.errors = errors
         return errors
     
     # ========================================================================
     # MULTI-READ KOMBINATION
     # ========================================================================
     
-    def combine_revolutions(self, track: FluxTrack) -> FluxRevolution:
-        """Mehrere Umdrehungen zu einer optimalen kombinieren"""
+    def combine_revolutions(self, track: FluxTrack) -> Optional[AlignedRevolutions]:
+        """
+        Umdrehungen ausrichten und je Bitzelle fusionieren
+        
+        Jede Umdrehung läuft beim Format-Takt durch den Datenseparator und
+        wird fensterweise auf die erste ausgerichtet (Flux-Core, Versatz
+        über die Umdrehung nachgeführt). Die Abbildung auf Referenz-Zellen
+        und der Mehrheitsentscheid laufen vektorisiert über den ganzen Track.
+        """
         log.info(f"Kombiniere {len(track.revolutions)} Umdrehungen")
         
-        if len(track.revolutions) == 1:
-            return track.revolutions[0]
+        present = [r for r, rev in enumerate(track.revolutions) if rev.deltas_ns.size]
+        if not present:
+            return None
         
-        # Referenz: Erste Revolution
-        ref_rev = track.revolutions[0]
-        best_samples = list(ref_rev.samples)
+        clock_ns = track.clock_ns or format_clock_ns(track.format, track.track)
+        if clock_ns is None:
+            # Unbekanntes Format: halbes kürzestes Intervall teilt MFM (2 Zellen)
+            # wie GCR (1 Zelle) ganzzahlig; nur für den Vergleich der Umdrehungen
+            clock_ns = track.revolutions[present[0]].stats.percentile(5) / 2
         
-        # Für jede Position: Bestes Sample aus allen Revolutions wählen
-        for i in range(len(best_samples)):
-            candidates = []
-            
-            for rev in track.revolutions:
-                if i < len(rev.samples):
-                    candidates.append(rev.samples[i])
-            
-            if len(candidates) > 1:
-                # Median-Timing wählen (robuster gegen Ausreißer)
-                deltas = [c.delta_ns for c in candidates]
-                median_delta = np.median(deltas)
-                
-                # Sample mit geringstem Abstand zum Median
-                best_idx = min(range(len(candidates)), 
-                              key=lambda x: abs(candidates[x].delta_ns - median_delta))
-                best_samples[i] = candidates[best_idx]
-        
-        combined = FluxRevolution(
-            samples=best_samples,
-            index_time=ref_rev.index_time,
-            revolution=99,  # Markiert als kombiniert
-            duration_ns=ref_rev.duration_ns,
-            rpm=ref_rev.rpm
-        )
+        bitstreams = [self.to_bitstream(rev, clock_ns) if rev.deltas_ns.size else None
+                      for rev in track.revolutions]
+        reference = present[0]
+        ref = bitstreams[reference]
+        
+        n = ref.nbits
+        window = ufi_flux_core.ALIGN_WINDOW
+        cells = np.zeros((len(bitstreams), n), dtype=np.uint8)
+        valid = np.zeros((len(bitstreams), n), dtype=bool)
+        shifts = np.zeros((len(bitstreams), (n + window - 1) // window), dtype=np.int32)
+        k = np.arange(n, dtype=np.int32)
+        
+        for r in present:
+            bits = bitstreams[r]
+            if r == reference:
+                cells[r] = bits.unpacked()
+                valid[r] = True
+                continue
+            shifts[r] = self.align_bitstream(ref, bits)
+            idx = k + np.repeat(shifts[r], window)[:n]
+            valid[r] = (idx >= 0) & (idx < bits.nbits)
+            np.take(bits.unpacked(), idx, out=cells[r], mode='clip')
+            cells[r] &= valid[r]
+        
+        # Mehrheit je Zelle, Gleichstand (z.B. zwei Umdrehungen) → Referenz
+        ones = cells.sum(axis=0, dtype=np.int32) * 2
+        votes = valid.sum(axis=0, dtype=np.int32)
+        fused = (ones > votes) | ((ones == votes) & (cells[reference] != 0))
         
-        return combined
+        return AlignedRevolutions(
+            clock_ns=clock_ns,
+            reference=reference,
+            bitstreams=bitstreams,
+            shifts=shifts,
+            cells=cells,
+            valid=valid,
+            fused=ufi_flux_core.Bitstream(
+                bits=np.packbits(fused), nbits=n, bit_pos=ref.bit_pos,
+                phase=ref.phase, clock_ns=clock_ns),
+        )
     
     # ========================================================================
     # WEAK-BITS ERKENNUNG
     # ========================================================================
     
-    def detect_weak_bits(self, track: FluxTrack) -> List[int]:
-        """Weak-Bits durch Vergleich mehrerer Lesungen finden"""
-        log.info("Suche Weak-Bits...")
+    def detect_weak_bits(self, track: FluxTrack) -> List[WeakRegion]:
+        """
+        Weak-Bits: Bereiche, in denen die ausgerichteten Umdrehungen uneinig sind
         
-        weak_positions = []
+        Ein vektorisierter Durchlauf über die Zellen-Matrix aus
+        combine_revolutions; das Ergebnis bleibt am Track (einmal je Track).
+        """
+        if track.weak_regions is not None:
+            return track.weak_regions
         
-        if len(track.revolutions) < 2:
-            return weak_positions
+        log.info("Suche Weak-Bits...")
+        track.weak_regions = []
+        aligned = track.aligned
+        if aligned is None or aligned.count < 2:
+            return track.weak_regions
         
-        ref_rev = track.revolutions[0]
+        majority = aligned.fused.unpacked()
+        differs = (aligned.cells != majority) & aligned.valid
+        covered = aligned.valid.sum(axis=0) >= 2
+        disagree = np.flatnonzero(differs.any(axis=0) & covered)
+        if not disagree.size:
+            return track.weak_regions
         
-        for i in range(min(len(r.samples) for r in track.revolutions)):
-            deltas = [r.samples[i].delta_ns for r in track.revolutions]
-            
-            # Hohe Varianz = Weak-Bit
-            variance = np.var(deltas)
-            mean = np.mean(deltas)
-            
-            if mean > 0 and variance / mean > 0.1:  # >10% Varianz
-                weak_positions.append(i)
+        # Lauflängen: uneinige Zellen mit kleinen Lücken zu Bereichen
+        breaks = np.flatnonzero(np.diff(disagree) > WEAK_GAP_CELLS) + 1
+        first = np.concatenate(([0], breaks))
+        last = np.concatenate((breaks, [disagree.size])) - 1
+        start = disagree[first]
+        length = disagree[last] - start + 1
+        count = last - first + 1
         
-        if weak_positions:
-            log.info(f"  {len(weak_positions)} Weak-Bits gefunden")
+        # Bei Zufallsbits sind 1 - 2^(1-R) der Zellen uneinig
+        revs = aligned.count
+        confidence = np.minimum(1.0, count / length / (1.0 - 2.0 ** (1 - revs)))
+        keep = (length >= WEAK_MIN_CELLS) & (confidence >= WEAK_MIN_CONFIDENCE)
+        if revs >= 3:
+            # Weicht fast nur eine Umdrehung ab, ist das Versatz (PLL-Schlupf)
+            per_rev = np.add.reduceat(differs[:, disagree], first, axis=1)
+            keep &= per_rev.max(axis=0) <= WEAK_SINGLE_REV * per_rev.sum(axis=0)
         
-        return weak_positions
+        track.weak_regions = [
+            WeakRegion(int(s), int(n), round(float(c), 3))
+            for s, n, c in zip(start[keep], length[keep], confidence[keep])
+        ]
+        if track.weak_regions:
+            cells = sum(r.length for r in track.weak_regions)
+            log.info(f"  {len(track.weak_regions)} Weak-Bereiche ({cells} Zellen)")
+        return track.weak_regions
     
     # ========================================================================
     # KOPIERSCHUTZ-ANALYSE
@@ -359,25 +1552,22 @@ class FluxProcessor:
         }
         
         # Weak-Bits (häufig bei Kopierschutz)
-        weak_bits = self.detect_weak_bits(track)
-        if len(weak_bits) > 10:
+        weak = self.detect_weak_bits(track)
+        if weak:
             protection['type'] = 'weak_bits'
-            protection['details']['weak_count'] = len(weak_bits)
-            protection['details']['positions'] = weak_bits[:20]  # Erste 20
+            protection['details']['weak_cells'] = sum(r.length for r in weak)
+            protection['details']['weak_regions'] = [asdict(r) for r in weak[:20]]  # Erste 20
         
         # Timing-Anomalien (z.B. lange Gaps)
         for rev in track.revolutions:
-            deltas = [s.delta_ns for s in rev.samples]
-            if deltas:
-                max_delta = max(deltas)
-                median = np.median(deltas)
-                
-                if max_delta > median * 5:
+            stats = rev.stats
+            if stats is not None and stats.count:
+                if stats.max_ns > stats.median_ns * 5:
                     protection['type'] = 'timing_protection'
-                    protection['details']['max_gap_ns'] = max_delta
+                    protection['details']['max_gap_ns'] = stats.max_ns
         
         # Track-Längen-Variation (z.B. bei Track 6-7)
-        flux_counts = [len(r.samples) for r in track.revolutions]
+        flux_counts = [r.count for r in track.revolutions]
         if max(flux_counts) - min(flux_counts) > 1000:
             protection['type'] = 'variable_density'
             protection['details']['flux_variation'] = max(flux_counts) - min(flux_counts)
@@ -389,57 +1579,102 @@ class FluxProcessor:
     # ========================================================================
     
     def detect_format(self, track: FluxTrack) -> DiskFormat:
-        """Disk-Format automatisch erkennen"""
+        """
+        Disk-Format automatisch erkennen
+        
+        Der Takt kommt aus den Spitzen des Intervall-Histogramms (Umdrehungs-
+        analyse, kein weiterer Durchlauf). In Frage kommen Formate gleicher
+        Kodierung mit passendem Nominaltakt, das bereits bestätigte Disk-
+        Format zuerst; widerspricht der Track ihm, wird es übersprungen.
+        Bestätigt wird per Sync-Suche auf FORMAT_PROBE_SHARE der ersten
+        Umdrehung, Startwert des Datenseparators ist der gemessene Takt.
+        Ohne Flux-Core (keine Dekoder) gilt unbestätigt das Format mit dem
+        nächstliegenden Nominaltakt.
+        Der Takt bleibt am Track (clock_ns) für Kombination und Dekodierung.
+        """
         log.info("Erkenne Disk-Format...")
         
-        if not track.revolutions or not track.revolutions[0].samples:
+        if not track.revolutions or track.revolutions[0].count == 0:
             return DiskFormat.UNKNOWN
         
         rev = track.revolutions[0]
+        stats = [r.stats for r in track.revolutions if r.stats is not None]
+        fits = fit_clock(sum(st.hist for st in stats), stats[0].bin_ns) if stats else []
+        if fits:
+            track.clock_ns = fits[0].clock_ns
         
-        # Durchschnittliche Bitcell-Zeit
-        deltas = [s.delta_ns for s in rev.samples if s.delta_ns > 0]
-        if not deltas:
-            return DiskFormat.UNKNOWN
-        
-        avg_delta = np.mean(deltas)
+        candidates = []     # (Disk-Format?, Abweichung, Format, Takt)
+        for fmt in self.format_detectors:
+            nominal = format_clock_ns(fmt, track.track)
+            for fit in fits:
+                deviation = abs(fit.clock_ns / nominal - 1)
+                if fit.encoding == FORMAT_ENCODING[fmt] and deviation <= CLOCK_FIT_TOLERANCE:
+                    candidates.append((fmt != self.disk_format, deviation, fmt, fit.clock_ns))
+        candidates.sort(key=lambda c: c[:2])
         
-        # MFM: ~2000ns (kurz), ~3000ns (mittel), ~4000ns (lang)
-        # GCR: ~3200ns, ~3500ns, ~4000ns, ~4500ns
+        def confirm(probes, count: int) -> Optional[DiskFormat]:
+            # Ein Bitstrom je Takt, von allen Formaten mit diesem Takt genutzt
+            bitstreams = {}
+            for fmt, clock_ns in probes:
+                if clock_ns not in bitstreams:
+                    bitstreams[clock_ns] = self.to_bitstream(rev, clock_ns, count)
+                if self.format_detectors[fmt](bitstreams[clock_ns], fmt):
+                    return fmt
+            return None
         
-        if 1500 < avg_delta < 2500:
-            # Wahrscheinlich MFM
-            if len(rev.samples) > 80000:
-                return DiskFormat.PC_MFM_HD
-            else:
-                return DiskFormat.PC_MFM_DD
-        
-        elif 2500 < avg_delta < 4000:
-            # Amiga oder C64
-            if rev.rpm > 290 and rev.rpm < 310:
-                return DiskFormat.AMIGA_DD
-            else:
-                return DiskFormat.C64_GCR
+        # Bestätigen nur mit Dekoder (Flux-Core); ohne bleibt der Takt-Fit
+        probes = [(fmt, clock_ns) for _, _, fmt, clock_ns in candidates if fmt in self.decoders]
+        fmt = None
+        if probes:
+            fmt = confirm(probes, max(1, int(rev.count * FORMAT_PROBE_SHARE))) or \
+                confirm(probes, rev.count)
+        elif self.decoders:
+            # Kein passender Takt: alle Formate beim Nominaltakt, ganze Umdrehung
+            fmt = confirm([(f, format_clock_ns(f, track.track)) for f in self.decoders
+                           if f in self.format_detectors], rev.count)
+            if fmt is not None:
+                track.clock_ns = None
         
-        elif 3500 < avg_delta < 5000:
-            return DiskFormat.APPLE_II_GCR
+        if fmt is not None:
+            track.clock_ns = next((c for _, _, f, c in candidates if f == fmt), track.clock_ns)
+            if self.disk_format == DiskFormat.UNKNOWN:
+                self.disk_format = fmt
+                clock_ns = track.clock_ns or format_clock_ns(fmt, track.track)
+                log.info(f"  Disk-Format {fmt.name} bestätigt, Takt {clock_ns:.0f} ns")
+            return fmt
         
+        # Unbestätigt: Format mit dem passendsten Takt (nicht für die Disk)
+        if candidates:
+            track.clock_ns = candidates[0][3]
+            return candidates[0][2]
         return DiskFormat.UNKNOWN
     
-    def _detect_pc_mfm(self, track: FluxTrack) -> bool:
-        """PC MFM Format erkennen"""
-        # TODO: Sync-Pattern suchen (0x4489)
-        return True
+    def _detect_pc_mfm(self, bits: ufi_flux_core.Bitstream,
+                       fmt: DiskFormat = DiskFormat.PC_MFM_DD) -> bool:
+        """PC MFM Format erkennen: IDAM (A1 A1 A1 FE) mit gültiger CRC"""
+        return self.decoders[fmt].detect(bits)
     
-    def _detect_amiga(self, track: FluxTrack) -> bool:
-        """Amiga Format erkennen"""
-        # TODO: Amiga Sync suchen (0x4489 4489)
-        return True
+    def _detect_amiga(self, bits: ufi_flux_core.Bitstream,
+                      fmt: DiskFormat = DiskFormat.AMIGA_DD) -> bool:
+        """Amiga Format erkennen: 0x4489 0x4489 mit gültiger Header-Prüfsumme"""
+        return self.decoders[fmt].detect(bits)
     
-    def _detect_c64_gcr(self, track: FluxTrack) -> bool:
-        """C64 GCR Format erkennen"""
-        # TODO: GCR Sync suchen
-        return True
+    def _detect_c64_gcr(self, bits: ufi_flux_core.Bitstream,
+                        fmt: DiskFormat = DiskFormat.C64_GCR) -> bool:
+        """C64 GCR Format erkennen: Header-Block mit gültiger Prüfsumme (Zonen-Takt)"""
+        return self.decoders[fmt].detect(bits)
+    
+    def _detect_apple_gcr(self, bits: ufi_flux_core.Bitstream,
+                          fmt: DiskFormat = DiskFormat.APPLE_II_GCR) -> bool:
+        """Apple II GCR erkennen: Adressfeld mit gültiger Prüfsumme"""
+        return self.decoders[fmt].detect(bits)
+    
+    def decode_sectors(self, track: FluxTrack) -> DecodedTrack:
+        """Sektoren im erkannten Format dekodieren"""
+        decoder = self.decoders.get(track.format)
+        if decoder is None:
+            return DecodedTrack([])
+        return decoder.decode(track, format_clock_ns(track.format, track.track), track.clock_ns)
     
     # ========================================================================
     # QUALITÄTS-BEWERTUNG
@@ -458,13 +1693,12 @@ class FluxProcessor:
         errors = self.detect_errors(track)
         score -= len(errors) * 5
         
-        # Weak-Bits
-        weak_bits = self.detect_weak_bits(track)
-        score -= len(weak_bits) * 0.1
+        # Weak-Bits (je Bereich, nicht je Zelle)
+        score -= len(self.detect_weak_bits(track)) * 2
         
         # Konsistenz zwischen Revolutions
         if len(track.revolutions) > 1:
-            counts = [len(r.samples) for r in track.revolutions]
+            counts = [r.count for r in track.revolutions]
             variance = np.var(counts) / np.mean(counts) if np.mean(counts) > 0 else 0
             score -= variance * 10
         
@@ -488,8 +1722,8 @@ class FluxProcessor:
         # 3. Fehler erkennen
         warnings = self.detect_errors(track)
         
-        # 4. Multi-Read kombinieren
-        combined = self.combine_revolutions(track)
+        # 4. Multi-Read ausrichten und kombinieren
+        track.aligned = self.combine_revolutions(track)
         
         # 5. Kopierschutz analysieren
         protection = self.analyze_protection(track)
@@ -498,16 +1732,34 @@ class FluxProcessor:
         quality = self.calculate_quality(track)
         log.info(f"  Qualität: {quality:.1f}%")
         
+        # 7. Sektoren dekodieren
+        decoded = self.decode_sectors(track)
+        sectors = decoded.sectors
+        if sectors:
+            good = sum(s.crc_ok for s in sectors)
+            log.info(f"  Sektoren: {good}/{len(sectors)} CRC OK")
+        if decoded.info.get('long_track'):
+            protection['type'] = 'long_track'
+            protection['details']['track_cells'] = decoded.info['track_cells']
+        
+        # Abgeleitete Arrays freigeben: raw_flux behält Ticks und Ergebnisse
+        # (AlignedRevolutions allein ~1,6 MB je DD-Track, Disk-Puffer hält alle)
+        track.aligned = None
+        for rev in track.revolutions:
+            rev.deltas_ns = np.zeros(0, dtype=np.float32)
+            rev.stats = None
+        
         # Ergebnis
         return ProcessingResult(
             track=track.track,
             side=track.side,
             format=track.format,
             quality_score=quality,
-            sectors=[],  # TODO: Sektor-Dekodierung
+            sectors=sectors,
             raw_flux=track,
             warnings=warnings,
-            protection_info=protection
+            protection_info=protection,
+            track_raw=decoded.info.get('track_raw')
         )
 
 
@@ -516,7 +1768,12 @@ class FluxProcessor:
 # ============================================================================
 
 class DiskBuffer:
-    """Puffert eine komplette Disk im Speicher"""
+    """
+    Puffert eine komplette Disk im Speicher
+    
+    add_track kommt aus den Verarbeitungs-Threads (ReadPipeline), gelesen
+    wird über results() als Momentaufnahme.
+    """
     
     def __init__(self):
         self.tracks: Dict[Tuple[int, int], ProcessingResult] = {}
@@ -526,12 +1783,19 @@ class DiskBuffer:
             'sides': 2,
             'quality_avg': 0
         }
+        self._lock = threading.Lock()
     
     def add_track(self, result: ProcessingResult):
         """Track zum Buffer hinzufügen"""
         key = (result.track, result.side)
-        self.tracks[key] = result
-        self._update_disk_info()
+        with self._lock:
+            self.tracks[key] = result
+            self._update_disk_info()
+    
+    def results(self) -> List[ProcessingResult]:
+        """Alle Tracks (Momentaufnahme)"""
+        with self._lock:
+            return list(self.tracks.values())
     
     def get_track(self, track: int, side: int) -> Optional[ProcessingResult]:
         """Track aus Buffer holen"""
@@ -564,37 +1828,636 @@ class DiskBuffer:
                     'format': r.format.name,
                     'quality': r.quality_score,
                     'sectors': len(r.sectors),
+                    'bad_sectors': [s.number for s in r.sectors if not s.crc_ok],
                     'warnings': r.warnings,
                     'protection': r.protection_info
                 }
-                for r in self.tracks.values()
+                for r in self.results()
             ]
         }
 
 
+    def to_adf(self, cylinders: int = 80) -> bytes:
+        """
+        Amiga-Sektoren als ADF (Zylinder × Kopf × Sektor à 512 Byte)
+        
+        Position aus dem Sektor-Header; fehlende Sektoren bleiben genullt,
+        fehlerhafte (Prüfsumme) werden mit ihren Daten übernommen.
+        """
+        results = self.results()
+        formats = {r.format for r in results} & set(AMIGA_SECTORS)
+        if not formats:
+            raise ValueError("Keine Amiga-Tracks im Buffer")
+        per_track = max(AMIGA_SECTORS[f] for f in formats)
+        
+        image = bytearray(cylinders * 2 * per_track * 512)
+        for r in results:
+            if r.format not in AMIGA_SECTORS:
+                continue
+            for s in r.sectors:
+                if s.cylinder < cylinders and s.number < per_track:
+                    offset = ((s.cylinder * 2 + s.head) * per_track + s.number) * 512
+                    image[offset:offset + 512] = s.data
+        return bytes(image)
+    
+    def _c64_tracks(self) -> List[ProcessingResult]:
+        tracks = [r for r in self.results() if r.format in C64_FORMATS and r.side == 0]
+        if not tracks:
+            raise ValueError("Keine C64-Tracks im Buffer")
+        return tracks
+    
+    def to_d64(self) -> bytes:
+        """
+        C64-Sektoren als D64 (35 oder 40 Tracks, Sektoren je Zone à 256 Byte)
+        
+        Position aus dem Block-Header (Track 1-basiert); fehlende Sektoren
+        bleiben genullt, ohne Fehlerinfo-Block.
+        """
+        tracks = self._c64_tracks()
+        count = 40 if any(r.format == DiskFormat.C64_GCR_40 or r.track >= 35 for r in tracks) else 35
+        
+        offsets = [0]
+        for t in range(count):
+            offsets.append(offsets[-1] + c64_zone(t)[1] * 256)
+        
+        image = bytearray(offsets[-1])
+        for r in tracks:
+            for s in r.sectors:
+                t = s.cylinder - 1
+                if 0 <= t < count and s.number < c64_zone(t)[1]:
+                    offset = offsets[t] + s.number * 256
+                    image[offset:offset + 256] = s.data
+        return bytes(image)
+    
+    def to_g64(self) -> bytes:
+        """
+        C64-Tracks als G64 (rohe GCR-Bitzellen je Track, nur ganze Tracks)
+        
+        Erhält Kopierschutz und Nicht-Standard-Sektoren, die im D64 fehlen.
+        """
+        tracks = self._c64_tracks()
+        
+        header = struct.pack('<8sBBH', b'GCR-1541', 0, G64_HALF_TRACKS, G64_TRACK_MAX)
+        offsets = [0] * G64_HALF_TRACKS
+        speeds = [0] * G64_HALF_TRACKS
+        data = bytearray()
+        base = len(header) + G64_HALF_TRACKS * 8
+        
+        for r in sorted(tracks, key=lambda r: r.track):
+            half = r.track * 2
+            if not r.track_raw or half >= G64_HALF_TRACKS:
+                continue
+            zone = next(i for i, z in enumerate(C64_ZONES) if r.track < z[0])
+            offsets[half] = base + len(data)
+            speeds[half] = 3 - zone
+            data += struct.pack('<H', len(r.track_raw))
+            data += r.track_raw.ljust(G64_TRACK_MAX, b'\x00')
+        
+        return (header +
+                struct.pack(f'<{G64_HALF_TRACKS}I', *offsets) +
+                struct.pack(f'<{G64_HALF_TRACKS}I', *speeds) +
+                bytes(data))
+    
+    def _apple_tracks(self) -> List[ProcessingResult]:
+        tracks = [r for r in self.results()
+                  if r.format == DiskFormat.APPLE_II_GCR and r.side == 0]
+        if not tracks:
+            raise ValueError("Keine Apple-II-Tracks im Buffer")
+        return tracks
+    
+    def to_apple(self, order: str = 'dos') -> bytes:
+        """
+        Apple-II-Sektoren als Image (35 Tracks à 256-Byte-Sektoren)
+        
+        order: 'dos' (DOS 3.3 .dsk), 'prodos' (.po) oder 'physical'
+        (13-Sektor-Disks, .d13). Position aus dem Adressfeld.
+        """
+        tracks = self._apple_tracks()
+        per_track = 16 if any(s.number >= 13 for r in tracks for s in r.sectors) else 13
+        if per_track == 13 and order != 'physical':
+            raise ValueError("DOS-3.2-Disk (13 Sektoren): nur als D13")
+        
+        # Image-Sektor je physikalischem Sektor
+        slot = {phys: i for i, phys in enumerate(APPLE_SKEW[order][:per_track])}
+        image = bytearray(APPLE_TRACKS * per_track * 256)
+        for r in tracks:
+            for s in r.sectors:
+                if s.cylinder < APPLE_TRACKS and s.number in slot:
+                    offset = (s.cylinder * per_track + slot[s.number]) * 256
+                    image[offset:offset + 256] = s.data
+        return bytes(image)
+    
+    def to_nib(self) -> bytes:
+        """Apple-II-Nibble-Dump (NIB, 35 Tracks à 6656 Nibbles)"""
+        image = bytearray(b'\xff' * (APPLE_TRACKS * APPLE_NIB_TRACK))
+        for r in self._apple_tracks():
+            if r.track_raw and r.track < APPLE_TRACKS:
+                offset = r.track * APPLE_NIB_TRACK
+                image[offset:offset + APPLE_NIB_TRACK] = r.track_raw
+        return bytes(image)
+
+
+# ============================================================================
+# LESE-PIPELINE (Erfassung und Verarbeitung nebenläufig)
+# ============================================================================
+
+class ReadJob:
+    """
+    Lese-Auftrag (ein Track oder eine Disk) mit Fortschritt
+    
+    Erfassungs- und Verarbeitungs-Threads schreiben den Stand fort; jeder
+    Listener erhält jedes Event im Thread, der es auslöst (die Web-API
+    reicht es an ihren Event-Loop weiter). future wird mit dem Auftrag
+    erfüllt, sobald alle Lesevorgänge verarbeitet sind.
+    """
+    
+    _ids = itertools.count(1)
+    
+    def __init__(self, reads: List[Tuple[int, int, int]], disk: bool = False):
+        self.id = next(self._ids)
+        self.reads = reads              # (Track, Seite, Umdrehungen)
+        self.disk = disk                # Disk-Auftrag: neues Disk-Format, Wiederholungen
+        self.state = 'queued'           # queued, reading, done, failed, cancelled
+        self.captured = 0
+        self.processed = 0
+        self.retries = 0
+        self.error: Optional[str] = None
+        self.results: Dict[Tuple[int, int], ProcessingResult] = {}
+        self.future: Future = Future()
+        self._outstanding = len(reads)  # Lesevorgänge bis zum Ende der Verarbeitung
+        self._first = True
+        self._lock = threading.Lock()
+        self._listeners = []
+        if not reads:
+            self.state = 'done'
+            self.future.set_result(self)
+    
+    @property
+    def finished(self) -> bool:
+        return self.future.done()
+    
+    def snapshot(self) -> Dict:
+        """Aktueller Stand (JSON)"""
+        return {
+            'job': self.id,
+            'state': self.state,
+            'total': len(self.reads) + self.retries,
+            'captured': self.captured,
+            'processed': self.processed,
+            'retries': self.retries,
+            'error': self.error,
+        }
+    
+    def subscribe(self, listener) -> Dict:
+        """Listener für Events anmelden, liefert den Stand zum selben Zeitpunkt"""
+        with self._lock:
+            self._listeners.append(listener)
+            return self.snapshot()
+    
+    def unsubscribe(self, listener):
+        with self._lock:
+            if listener in self._listeners:
+                self._listeners.remove(listener)
+    
+    def cancel(self):
+        """Restliche Lesevorgänge verwerfen (bereits gelesene werden verarbeitet)"""
+        with self._lock:
+            if self.state in ('queued', 'reading'):
+                self.state = 'cancelled'
+    
+    def _event(self, event: str, **details):
+        # Mit gehaltenem Lock aufrufen
+        payload = dict(self.snapshot(), event=event, **details)
+        for listener in list(self._listeners):
+            listener(payload)
+    
+    def _done_one(self):
+        # Mit gehaltenem Lock: ein Lesevorgang abgeschlossen
+        self._outstanding -= 1
+        if self._outstanding == 0:
+            if self.state == 'reading' or self.state == 'queued':
+                self.state = 'done'
+            self._event('done')
+            self.future.set_result(self)
+    
+    def begin_read(self) -> bool:
+        """Erfassung: nächster Lesevorgang; False = verwerfen (abgebrochen, Fehler)"""
+        with self._lock:
+            if self.state == 'queued':
+                self.state = 'reading'
+            if self.state == 'reading':
+                return True
+            self._done_one()
+            return False
+    
+    def read_done(self, track: int, side: int):
+        with self._lock:
+            self.captured += 1
+            self._event('captured', track=track, side=side)
+    
+    def read_failed(self, error: str):
+        with self._lock:
+            if self.state in ('queued', 'reading'):
+                self.state = 'failed'
+                self.error = error
+            self._done_one()
+    
+    def first_track(self) -> bool:
+        """Verarbeitung: True genau einmal, beim ersten Track"""
+        with self._lock:
+            first, self._first = self._first, False
+            return first
+    
+    def track_processed(self, result: ProcessingResult, retry: bool):
+        """Verarbeitung: Ergebnis eines Lesevorgangs (retry = Wiederholung folgt)"""
+        with self._lock:
+            self.processed += 1
+            self.results[(result.track, result.side)] = result
+            if retry:
+                self.retries += 1
+                self._outstanding += 1
+            self._event('processed', track=result.track, side=result.side,
+                        format=result.format.name, quality=result.quality_score,
+                        sectors=len(result.sectors),
+                        bad_sectors=sum(not s.crc_ok for s in result.sectors))
+            self._done_one()
+    
+    def track_failed(self, track: int, side: int, error: str):
+        with self._lock:
+            self.processed += 1
+            self._event('error', track=track, side=side, message=error)
+            self._done_one()
+
+
+class SharedFlux:
+    """
+    Shared-Memory-Puffer für die Ticks eines Tracks
+    
+    Die Umdrehungen liegen hintereinander; ein Verarbeitungs-Prozess legt
+    seine Arrays direkt darüber (ohne Kopie). Übertragen werden nur Name
+    und Lage, nicht die Ticks selbst.
+    """
+    
+    def __init__(self, size: int = SHARED_FLUX_BYTES):
+        self._shm = shared_memory.SharedMemory(create=True, size=size)
+    
+    def store(self, flux: FluxTrack) -> Tuple[str, List[Tuple[int, int, int, int]]]:
+        """Ticks ablegen, liefert Name und (Offset, Flanken, Index-Zeit, Umdrehung) je Umdrehung"""
+        size = 4 * sum(rev.count for rev in flux.revolutions)
+        if size > self._shm.size:
+            self.close()
+            self._shm = shared_memory.SharedMemory(create=True, size=2 * size)
+        
+        layout = []
+        offset = 0
+        for rev in flux.revolutions:
+            np.frombuffer(self._shm.buf, dtype='<u4', count=rev.count, offset=offset)[:] = rev.ticks
+            layout.append((offset, rev.count, rev.index_time, rev.revolution))
+            offset += 4 * rev.count
+        return self._shm.name, layout
+    
+    def close(self):
+        self._shm.close()
+        self._shm.unlink()
+
+
+# Verarbeitungs-Prozess: eigener FluxProcessor (Flux-Core, Decoder)
+_worker_processor: Optional['FluxProcessor'] = None
+
+
+def _worker_init():
+    global _worker_processor
+    _worker_processor = FluxProcessor()
+
+
+def _worker_ready() -> bool:
+    return _worker_processor is not None
+
+
+def _worker_track(buf, layout, track: int, side: int, disk_format: DiskFormat):
+    revolutions = [
+        FluxRevolution(ticks=np.frombuffer(buf, dtype='<u4', count=count, offset=offset),
+                       index_time=index_time, revolution=revolution)
+        for offset, count, index_time, revolution in layout
+    ]
+    _worker_processor.disk_format = disk_format
+    result = _worker_processor.process_track(FluxTrack(track, side, revolutions))
+    result.raw_flux = None      # Ticks hat der Aufrufer, abgeleitete Arrays bleiben hier
+    return result, _worker_processor.disk_format
+
+
+def _worker_process(name: str, layout, track: int, side: int, disk_format: DiskFormat):
+    """Track aus dem Shared Memory verarbeiten, liefert (Ergebnis, Disk-Format)"""
+    shm = shared_memory.SharedMemory(name=name)
+    error = None
+    try:
+        result = _worker_track(shm.buf, layout, track, side, disk_format)
+    except Exception as e:
+        # Der Traceback hält Sichten auf den Puffer: hier protokollieren, nur die Meldung weitergeben
+        log.exception(f"Track {track}/{side}: Verarbeitung fehlgeschlagen")
+        error = f"{type(e).__name__}: {e}"
+    shm.close()
+    if error is not None:
+        raise RuntimeError(error)
+    return result
+
+
+class ProcessingPool:
+    """
+    Verarbeitung gelesener Tracks aus einer begrenzten Warteschlange
+    
+    put() blockiert, solange CAPTURE_QUEUE_TRACKS Tracks warten: die
+    Erfassung läuft der Verarbeitung höchstens so weit voraus (Speicher
+    bleibt begrenzt). Ergebnisse landen im DiskBuffer; Disk-Tracks mit
+    Qualität unter RETRY_QUALITY werden über retry() erneut gelesen.
+    
+    workers > 0: so viele Prozesse verarbeiten Tracks parallel (je ein
+    Kern, kein GIL). Je Prozess reicht ein Thread die Ticks über seinen
+    SharedFlux-Puffer weiter; gepickelt werden nur Lage, Disk-Format und
+    Ergebnis. workers = 0 oder Prozesse nicht verfügbar: ein Thread im
+    eigenen Prozess.
+    """
+    
+    def __init__(self, processor: FluxProcessor, buffer: DiskBuffer,
+                 workers: int = PROCESS_WORKERS, depth: int = CAPTURE_QUEUE_TRACKS):
+        self.processor = processor
+        self.buffer = buffer
+        self.workers = workers
+        self.retry = None               # (Auftrag, Track, Seite), von ReadPipeline gesetzt
+        self._queue: queue.Queue = queue.Queue(maxsize=depth)
+        self._executor: Optional[ProcessPoolExecutor] = None
+        self._lock = threading.Lock()   # Verarbeitung im eigenen Prozess
+        self._threads: List[threading.Thread] = []
+    
+    @property
+    def processes(self) -> int:
+        """Laufende Verarbeitungs-Prozesse (0 = Verarbeitung im eigenen Prozess)"""
+        return self.workers if self._executor is not None else 0
+    
+    def start(self):
+        if self.workers > 0:
+            self._executor = self._start_workers(self.workers)
+        if self._executor is not None:
+            slots = [SharedFlux() for _ in range(self.workers)]
+        else:
+            slots = [None]
+        self._threads = [threading.Thread(target=self._run, args=(slot,),
+                                          name=f'ufi-process-{i}', daemon=True)
+                         for i, slot in enumerate(slots)]
+        for t in self._threads:
+            t.start()
+    
+    def stop(self):
+        for _ in self._threads:
+            self._queue.put(None)
+        for t in self._threads:
+            t.join()
+        if self._executor is not None:
+            self._executor.shutdown()
+            self._executor = None
+    
+    def _start_workers(self, workers: int) -> Optional[ProcessPoolExecutor]:
+        # spawn: kein fork() eines Prozesses mit laufenden Threads (Erfassung, Event-Loop)
+        executor = ProcessPoolExecutor(workers, mp_context=multiprocessing.get_context('spawn'),
+                                       initializer=_worker_init)
+        try:
+            # Prozesse jetzt starten (Import, Flux-Core), nicht beim ersten Track
+            for future in [executor.submit(_worker_ready) for _ in range(workers)]:
+                future.result()
+        except Exception as e:
+            log.warning(f"Verarbeitungs-Prozesse nicht verfügbar ({e}), verarbeite im Prozess")
+            executor.shutdown(wait=False, cancel_futures=True)
+            return None
+        log.info(f"{workers} Verarbeitungs-Prozesse gestartet")
+        return executor
+    
+    def put(self, job: ReadJob, flux: FluxTrack, revolutions: int):
+        self._queue.put((job, flux, revolutions))
+    
+    def process(self, flux: FluxTrack, slot: Optional[SharedFlux]) -> ProcessingResult:
+        """Einen Track verarbeiten: im Verarbeitungs-Prozess (slot) oder im eigenen Prozess"""
+        executor = self._executor
+        if slot is not None and executor is not None:
+            name, layout = slot.store(flux)
+            try:
+                result, disk_format = executor.submit(
+                    _worker_process, name, layout, flux.track, flux.side,
+                    self.processor.disk_format).result()
+            except BrokenProcessPool:
+                # Prozess abgestürzt: restliche Tracks im eigenen Prozess
+                log.error("Verarbeitungs-Prozess beendet, verarbeite im Prozess weiter")
+                self._executor = None
+                executor.shutdown(wait=False)
+            else:
+                if self.processor.disk_format == DiskFormat.UNKNOWN:
+                    self.processor.disk_format = disk_format
+                flux.format = result.format
+                result.raw_flux = flux
+                return result
+        
+        with self._lock:
+            return self.processor.process_track(flux)
+    
+    def _run(self, slot: Optional[SharedFlux]):
+        try:
+            while (item := self._queue.get()) is not None:
+                self._handle(slot, *item)
+        finally:
+            if slot is not None:
+                slot.close()
+    
+    def _handle(self, slot: Optional[SharedFlux], job: ReadJob, flux: FluxTrack, revolutions: int):
+        if job.disk and job.first_track():
+            self.processor.new_disk()
+        try:
+            result = self.process(flux, slot)
+        except Exception as e:
+            log.exception(f"Track {flux.track}/{flux.side}: Verarbeitung fehlgeschlagen")
+            job.track_failed(flux.track, flux.side, str(e))
+            return
+        
+        self.buffer.add_track(result)
+        
+        retry = job.disk and revolutions < RETRY_REVOLUTIONS and \
+            result.quality_score < RETRY_QUALITY and job.state == 'reading'
+        if retry:
+            log.warning(f"Track {result.track}/{result.side}: "
+                        f"Retry wegen Qualität {result.quality_score:.0f}%")
+        job.track_processed(result, retry)
+        if retry:
+            self.retry(job, result.track, result.side)
+
+
+class AcquisitionWorker(threading.Thread):
+    """
+    Erfassungs-Thread: besitzt die Verbindung zum STM32
+    
+    Alle Gerätezugriffe laufen hier nacheinander: Track-Lesen aus Aufträgen
+    und einzelne Befehle (call, z.B. Motor, Telemetrie). Befehle und
+    Wiederholungen haben Vorrang vor den restlichen Tracks eines Auftrags.
+    Gelesene Tracks gehen an den ProcessingPool, der nächste Track wird
+    gelesen, während der vorige verarbeitet wird. stop() wird zuletzt
+    bearbeitet, damit jeder Auftrag (abgebrochen oder nicht) abgeschlossen wird.
+    """
+    
+    PRIO_CALL, PRIO_RETRY, PRIO_READ, PRIO_STOP = range(4)
+    
+    def __init__(self, stm32: STM32Connection, pool: ProcessingPool):
+        super().__init__(name='ufi-acquisition', daemon=True)
+        self.stm32 = stm32
+        self.pool = pool
+        self._queue: queue.PriorityQueue = queue.PriorityQueue()
+        self._seq = itertools.count()
+    
+    def _put(self, priority: int, item):
+        self._queue.put((priority, next(self._seq), item))
+    
+    def submit(self, job: ReadJob):
+        for track, side, revolutions in job.reads:
+            self._put(self.PRIO_READ, (job, track, side, revolutions))
+    
+    def retry(self, job: ReadJob, track: int, side: int):
+        self._put(self.PRIO_RETRY, (job, track, side, RETRY_REVOLUTIONS))
+    
+    def call(self, fn, *args) -> Future:
+        """Gerätebefehl im Erfassungs-Thread ausführen"""
+        future = Future()
+        self._put(self.PRIO_CALL, (fn, args, future))
+        return future
+    
+    def stop(self):
+        self._put(self.PRIO_STOP, None)
+        self.join()
+    
+    def run(self):
+        while (item := self._queue.get()[2]) is not None:
+            if isinstance(item[0], ReadJob):
+                self._read(*item)
+                continue
+            fn, args, future = item
+            if future.set_running_or_notify_cancel():
+                try:
+                    future.set_result(fn(*args))
+                except Exception as e:
+                    future.set_exception(e)
+    
+    def _read(self, job: ReadJob, track: int, side: int, revolutions: int):
+        if not job.begin_read():
+            return
+        try:
+            flux = self.stm32.read_track(track, side, revolutions)
+        except Exception as e:
+            log.error(f"Track {track}/{side}: Lesen fehlgeschlagen: {e}")
+            job.read_failed(str(e))
+            return
+        job.read_done(track, side)
+        self.pool.put(job, flux, revolutions)
+
+
+class ReadPipeline:
+    """Erfassungs-Thread und Verarbeitung, Aufträge mit Fortschritt"""
+    
+    def __init__(self, stm32: STM32Connection, processor: FluxProcessor, buffer: DiskBuffer,
+                 workers: int = PROCESS_WORKERS):
+        self.pool = ProcessingPool(processor, buffer, workers)
+        self.acquisition = AcquisitionWorker(stm32, self.pool)
+        self.pool.retry = self.acquisition.retry
+        self.jobs: Dict[int, ReadJob] = {}
+    
+    def start(self):
+        self.pool.start()
+        self.acquisition.start()
+    
+    def stop(self):
+        """Laufende Aufträge abbrechen, Threads beenden"""
+        for job in self.jobs.values():
+            job.cancel()
+        self.acquisition.stop()
+        self.pool.stop()
+    
+    def read(self, reads: List[Tuple[int, int, int]], disk: bool = False) -> ReadJob:
+        """Auftrag einreihen (kehrt sofort zurück)"""
+        job = ReadJob(reads, disk)
+        self.jobs[job.id] = job
+        finished = [j for j in self.jobs.values() if j.finished]
+        for old in finished[:max(0, len(finished) - JOB_HISTORY)]:
+            del self.jobs[old.id]
+        self.acquisition.submit(job)
+        return job
+    
+    def read_disk(self, tracks: int = 80, sides: int = 2,
+                  revolutions: int = READ_REVOLUTIONS) -> ReadJob:
+        return self.read([(t, s, revolutions) for t in range(tracks) for s in range(sides)],
+                         disk=True)
+    
+    def call(self, fn, *args) -> Future:
+        return self.acquisition.call(fn, *args)
+
+
+def read_disk(stm32: STM32Connection, processor: FluxProcessor, buffer: DiskBuffer,
+              tracks: int = 80, sides: int = 2, workers: int = PROCESS_WORKERS) -> DiskBuffer:
+    """Komplette Disk lesen und verarbeiten, blockierend"""
+    pipeline = ReadPipeline(stm32, processor, buffer, workers)
+    pipeline.start()
+    try:
+        job = pipeline.read_disk(tracks, sides).future.result()
+    finally:
+        pipeline.stop()
+    if job.error:
+        raise RuntimeError(job.error)
+    return buffer
+
+
 # ============================================================================
 # WEB API (für PC-Kommunikation)
 # ============================================================================
 
 class WebAPI:
-    """REST API für PC-Hauptprogramm"""
+    """
+    REST API für PC-Hauptprogramm
+    
+    Der Event-Loop greift nie selbst auf das Gerät zu: Lesen und Befehle
+    laufen im Erfassungs-Thread der ReadPipeline, die Handler warten nur
+    auf deren Futures. Disk-Aufträge kehren sofort zurück, der Fortschritt
+    kommt über /api/jobs/{id}/progress (NDJSON, ein Event je Zeile).
+    """
     
     def __init__(self, processor: FluxProcessor, buffer: DiskBuffer, stm32: STM32Connection):
         self.processor = processor
         self.buffer = buffer
         self.stm32 = stm32
+        self.pipeline = ReadPipeline(stm32, processor, buffer)
         self.app = web.Application()
+        self.app.on_startup.append(self._start_pipeline)
+        self.app.on_cleanup.append(self._stop_pipeline)
         self._setup_routes()
     
+    async def _start_pipeline(self, app):
+        self.pipeline.start()
+    
+    async def _stop_pipeline(self, app):
+        await asyncio.get_running_loop().run_in_executor(None, self.pipeline.stop)
+    
+    async def _device(self, fn, *args):
+        """Gerätezugriff im Erfassungs-Thread, ohne den Event-Loop zu blockieren"""
+        return await asyncio.wrap_future(self.pipeline.call(fn, *args))
+    
     def _setup_routes(self):
         """API Routen konfigurieren"""
         self.app.router.add_get('/api/status', self.get_status)
         self.app.router.add_get('/api/disk', self.get_disk_info)
+        self.app.router.add_get('/api/disk/{image:adf|d64|g64|dsk|po|d13|nib}', self.get_disk_image)
         self.app.router.add_get('/api/track/{track}/{side}', self.get_track)
         self.app.router.add_post('/api/read/track', self.read_track)
         self.app.router.add_post('/api/read/disk', self.read_disk)
+        self.app.router.add_get('/api/jobs', self.get_jobs)
+        self.app.router.add_get('/api/jobs/{job}', self.get_job)
+        self.app.router.add_get('/api/jobs/{job}/progress', self.job_progress)
+        self.app.router.add_delete('/api/jobs/{job}', self.cancel_job)
         self.app.router.add_post('/api/drive/select', self.drive_select)
         self.app.router.add_post('/api/drive/motor', self.drive_motor)
+        self.app.router.add_post('/api/iec/image', self.iec_image)
+        self.app.router.add_get('/api/metrics', self.get_metrics)
         
         # CORS für PC-Zugriff
         cors = aiohttp_cors.setup(self.app, defaults={
@@ -612,13 +2475,33 @@ class WebAPI:
         return web.json_response({
             'connected': self.stm32.dev is not None,
             'buffer_tracks': len(self.buffer.tracks),
-            'disk_info': self.buffer.disk_info
+            'disk_info': self.buffer.disk_info,
+            'jobs': [j.snapshot() for j in self.pipeline.jobs.values() if not j.finished]
         })
     
     async def get_disk_info(self, request):
         """Disk-Informationen abrufen"""
         return web.json_response(self.buffer.to_json())
     
+    async def get_disk_image(self, request):
+        """Gelesene Disk als Image (ADF, D64, G64, DSK, PO, D13, NIB)"""
+        kind = request.match_info['image']
+        export = {
+            'adf': self.buffer.to_adf,
+            'd64': self.buffer.to_d64,
+            'g64': self.buffer.to_g64,
+            'dsk': lambda: self.buffer.to_apple('dos'),
+            'po': lambda: self.buffer.to_apple('prodos'),
+            'd13': lambda: self.buffer.to_apple('physical'),
+            'nib': self.buffer.to_nib,
+        }[kind]
+        try:
+            image = export()
+        except ValueError as e:
+            return web.json_response({'error': str(e)}, status=400)
+        return web.Response(body=image, content_type='application/octet-stream',
+                            headers={'Content-Disposition': f'attachment; filename="disk.{kind}"'})
+    
     async def get_track(self, request):
         """Einzelnen Track abrufen"""
         track = int(request.match_info['track'])
@@ -643,16 +2526,14 @@ class WebAPI:
         data = await request.json()
         track = data.get('track', 0)
         side = data.get('side', 0)
-        revolutions = data.get('revolutions', 3)
-        
-        # Von STM32 lesen
-        flux_track = self.stm32.read_track(track, side, revolutions)
+        revolutions = data.get('revolutions', READ_REVOLUTIONS)
         
-        # Verarbeiten
-        result = self.processor.process_track(flux_track)
-        
-        # Puffern
-        self.buffer.add_track(result)
+        job = self.pipeline.read([(track, side, revolutions)])
+        await asyncio.wrap_future(job.future)
+        result = job.results.get((track, side))
+        if result is None:
+            return web.json_response({'error': job.error or 'Verarbeitung fehlgeschlagen'},
+                                     status=500)
         
         return web.json_response({
             'track': result.track,
@@ -662,32 +2543,74 @@ class WebAPI:
         })
     
     async def read_disk(self, request):
-        """Komplette Disk lesen"""
+        """Komplette Disk lesen: Auftrag einreihen (wait=true: bis zum Ende warten)"""
         data = await request.json()
         max_tracks = data.get('tracks', 80)
         sides = data.get('sides', 2)
+        revolutions = data.get('revolutions', READ_REVOLUTIONS)
         
-        # Disk lesen (async für Progress-Updates)
-        for track in range(max_tracks):
-            for side in range(sides):
-                flux_track = self.stm32.read_track(track, side, 3)
-                result = self.processor.process_track(flux_track)
-                self.buffer.add_track(result)
-                
-                # Bei schlechter Qualität: Retry
-                if result.quality_score < 80:
-                    log.warning(f"Track {track}/{side}: Retry wegen Qualität {result.quality_score:.0f}%")
-                    flux_track = self.stm32.read_track(track, side, 5)
-                    result = self.processor.process_track(flux_track)
-                    self.buffer.add_track(result)
+        job = self.pipeline.read_disk(max_tracks, sides, revolutions)
+        if data.get('wait'):
+            await asyncio.wrap_future(job.future)
+            return web.json_response(self.buffer.to_json())
         
-        return web.json_response(self.buffer.to_json())
+        return web.json_response(dict(job.snapshot(), progress=f'/api/jobs/{job.id}/progress'),
+                                 status=202)
+    
+    def _job(self, request) -> ReadJob:
+        try:
+            return self.pipeline.jobs[int(request.match_info['job'])]
+        except (KeyError, ValueError):
+            raise web.HTTPNotFound(text='Auftrag unbekannt')
+    
+    async def get_jobs(self, request):
+        """Aufträge (laufende und zuletzt abgeschlossene)"""
+        return web.json_response([j.snapshot() for j in self.pipeline.jobs.values()])
+    
+    async def get_job(self, request):
+        """Stand eines Auftrags"""
+        return web.json_response(self._job(request).snapshot())
+    
+    async def cancel_job(self, request):
+        """Auftrag abbrechen"""
+        job = self._job(request)
+        job.cancel()
+        return web.json_response(job.snapshot())
+    
+    async def job_progress(self, request):
+        """Fortschritt als NDJSON-Stream bis zum Ende des Auftrags"""
+        job = self._job(request)
+        loop = asyncio.get_running_loop()
+        events: asyncio.Queue = asyncio.Queue()
+        
+        def listener(event: Dict):
+            # Aus Erfassungs-/Verarbeitungs-Thread
+            try:
+                loop.call_soon_threadsafe(events.put_nowait, event)
+            except RuntimeError:
+                pass    # Event-Loop beendet
+        
+        event = dict(job.subscribe(listener), event='status')
+        if job.finished:
+            event = dict(job.snapshot(), event='done')
+        response = web.StreamResponse(headers={'Content-Type': 'application/x-ndjson'})
+        await response.prepare(request)
+        try:
+            while True:
+                await response.write(json.dumps(event).encode() + b'\n')
+                if event['event'] == 'done':
+                    break
+                event = await events.get()
+        finally:
+            job.unsubscribe(listener)
+        await response.write_eof()
+        return response
     
     async def drive_select(self, request):
         """Laufwerk auswählen"""
         data = await request.json()
         drive_type = data.get('drive', 1)
-        self.stm32.send_command(0x10, struct.pack('<B', drive_type))
+        await self._device(self.stm32.send_command, 0x10, struct.pack('<B', drive_type))
         return web.json_response({'ok': True})
     
     async def drive_motor(self, request):
@@ -695,9 +2618,30 @@ class WebAPI:
         data = await request.json()
         on = data.get('on', True)
         cmd = 0x11 if on else 0x12
-        self.stm32.send_command(cmd)
+        await self._device(self.stm32.send_command, cmd)
         return web.json_response({'ok': True})
     
+    async def iec_image(self, request):
+        """D64/D71/D81 über IEC lesen (ohne Flux)"""
+        data = await request.json()
+        device = data.get('device', 8)
+        fmt = data.get('format', 'd64').lower()
+        if fmt not in IEC_IMAGE_FORMATS:
+            return web.json_response({'error': f'Unbekanntes Format {fmt}'}, status=400)
+        
+        image = await self._device(self.stm32.iec_read_image, device, fmt)
+        return web.Response(body=image, content_type='application/octet-stream',
+                            headers={'Content-Disposition': f'attachment; filename="disk.{fmt}"'})
+    
+    async def get_metrics(self, request):
+        """Firmware-Telemetrie (?reset=1 nullt danach, ?format=prometheus)"""
+        reset = request.query.get('reset', '0') == '1'
+        telemetry = await self._device(self.stm32.get_telemetry, reset)
+        if request.query.get('format') == 'prometheus':
+            return web.Response(text=telemetry_to_prometheus(telemetry),
+                                content_type='text/plain')
+        return web.json_response(telemetry)
+    
     def run(self, host='0.0.0.0', port=5000):
         """Web-Server starten"""
         web.run_app(self.app, host=host, port=port)
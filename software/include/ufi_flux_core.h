@@ -0,0 +1,282 @@
+/**
+ * @file ufi_flux_core.h
+ * @brief Native flux decoding core for the CM5 processing layer
+ *
+ * Hot loops of the flux pipeline that numpy cannot express efficiently:
+ * - Revolution analysis: intervals, histogram, median, anomaly runs in one call
+ * - Data separator (PLL): flux intervals -> packed bit cells
+ * - Interval classification and histogram (SIMD)
+ * - Sync pattern search over packed bit streams (SIMD)
+ * - Raw/MFM bit extraction at any bit offset, CRC-CCITT (slicing-by-8)
+ * - Apple II nibble framing (disk controller shift register)
+ * - Revolution alignment (cell offset tracked window by window)
+ *
+ * Buffers are structure-of-arrays: the caller passes one contiguous
+ * array per field (intervals, bit positions, phase errors), exactly as
+ * numpy holds them, so the Python bindings (ufi_flux_core.py, ctypes)
+ * hand over pointers without copying.
+ *
+ * SIMD paths are selected at compile time: AVX2 or SSE2 on x86, NEON on
+ * ARM (CM5, Cortex-A76), scalar otherwise. All paths give identical results.
+ *
+ * Copyright (c) 2026 UFI Project
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef UFI_FLUX_CORE_H
+#define UFI_FLUX_CORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Constants and Definitions
+ *============================================================================*/
+
+/** API version, bumped on incompatible changes (checked by the bindings) */
+#define UFI_FLUX_CORE_VERSION   6
+
+/** Return codes */
+#define UFI_FLUX_OK             0
+#define UFI_FLUX_ERR_PARAM      (-1)    /**< Invalid argument */
+#define UFI_FLUX_ERR_OVERFLOW   (-2)    /**< Output buffer too small */
+
+/** Largest sync pattern for ufi_flux_find_sync() */
+#define UFI_FLUX_SYNC_MAX_WIDTH 32
+
+/** Exported symbols (library is built with hidden visibility) */
+#if defined(UFI_FLUX_BUILD)
+#define UFI_FLUX_API __attribute__((visibility("default")))
+#else
+#define UFI_FLUX_API
+#endif
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/**
+ * @brief Data separator parameters
+ *
+ * The PLL follows the bit cell clock within clock_ns * (1 +/- tolerance).
+ * After each transition the clock moves by period_adj of the phase error,
+ * and phase_adj of the error is removed from the running phase.
+ */
+typedef struct {
+    float clock_ns;         /**< Nominal bit cell (2000 = MFM DD, 1000 = HD) */
+    float period_adj;       /**< Clock correction per transition (0.05) */
+    float phase_adj;        /**< Phase correction per transition (0.60) */
+    float tolerance;        /**< Max. clock deviation from nominal (0.10) */
+} ufi_pll_params_t;
+
+/**
+ * @brief Decoded bit cells of one revolution (structure of arrays)
+ *
+ * bits is required. bit_pos and phase are optional (NULL) per-transition
+ * arrays with one entry per input interval.
+ */
+typedef struct {
+    uint8_t *bits;          /**< Packed bit cells, MSB first */
+    uint32_t capacity;      /**< Size of bits in bits */
+    uint32_t nbits;         /**< Out: bit cells written */
+    uint32_t *bit_pos;      /**< Out: bit cell of each transition (~0 = merged) */
+    int8_t *phase;          /**< Out: phase error per transition, +/-127 = +/-half cell */
+} ufi_bitstream_t;
+
+/**
+ * @brief Revolution analysis parameters
+ *
+ * Intervals below short_factor * median or above long_factor * median
+ * are anomalies; anomalies at most run_gap intervals apart form one run.
+ */
+typedef struct {
+    float ns_per_tick;      /**< Tick length including speed normalisation */
+    float bin_ns;           /**< Histogram bin width */
+    float short_factor;     /**< Short anomaly threshold (0.3) */
+    float long_factor;      /**< Long anomaly threshold (3.0) */
+    uint32_t run_gap;       /**< Max. intervals between anomalies of one run */
+} ufi_analyze_params_t;
+
+/**
+ * @brief Statistics of one revolution
+ *
+ * deltas_ns, hist and runs are caller buffers (runs is optional); the
+ * other fields are results.
+ */
+typedef struct {
+    float *deltas_ns;       /**< Out: interval before each transition in ns */
+    uint32_t *hist;         /**< Out: interval histogram, longer intervals in the last bin */
+    uint32_t bins;          /**< Size of hist */
+    uint32_t *runs;         /**< Out: anomaly runs as (first interval, intervals) pairs */
+    uint32_t max_runs;      /**< Capacity of runs in pairs */
+    double total_ns;        /**< Out: sum of all intervals */
+    float median_ns;        /**< Out: median interval, interpolated within its bin */
+    float max_ns;           /**< Out: longest interval */
+    uint32_t short_count;   /**< Out: short anomalies */
+    uint32_t long_count;    /**< Out: long anomalies */
+    uint32_t nruns;         /**< Out: anomaly runs (may exceed max_runs) */
+} ufi_flux_stats_t;
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+/**
+ * @brief API version of the loaded library
+ */
+UFI_FLUX_API uint32_t ufi_flux_version(void);
+
+/**
+ * @brief SIMD path compiled in ("avx2", "sse2", "neon" or "scalar")
+ */
+UFI_FLUX_API const char *ufi_flux_simd(void);
+
+/**
+ * @brief Analyse one revolution: intervals, histogram, median, anomalies
+ *
+ * Replaces separate passes (diff, histogram, median, outlier search):
+ * the first pass over the timer values writes the intervals and fills the
+ * histogram, the median comes from the histogram (no sort), and a second
+ * pass over the intervals, still in cache, counts anomalies and their runs.
+ * Timer differences are taken modulo 2^32 (counter wrap).
+ *
+ * @param ticks  Timer value of each transition since index
+ * @param count  Number of transitions
+ * @param params Analysis parameters
+ * @param stats  Buffers and results
+ * @return UFI_FLUX_OK or UFI_FLUX_ERR_PARAM
+ */
+UFI_FLUX_API int ufi_flux_analyze(const uint32_t *ticks, uint32_t count,
+                                  const ufi_analyze_params_t *params, ufi_flux_stats_t *stats);
+
+/**
+ * @brief Data separator: flux intervals to bit cells
+ *
+ * Every interval ends in a 1 cell preceded by the number of 0 cells that
+ * fit the current clock. Intervals shorter than half a cell are merged
+ * into the next one (noise).
+ *
+ * @param deltas_ns Flux intervals in ns (first one relative to index)
+ * @param count     Number of intervals
+ * @param params    PLL parameters
+ * @param out       Output buffers; out->nbits is set on return
+ * @return UFI_FLUX_OK or UFI_FLUX_ERR_*
+ */
+UFI_FLUX_API int ufi_flux_pll_decode(const float *deltas_ns, uint32_t count,
+                                     const ufi_pll_params_t *params, ufi_bitstream_t *out);
+
+/**
+ * @brief Classify intervals into whole bit cells
+ *
+ * cells[i] = round(deltas_ns[i] / clock_ns), clamped to [0, max_cells].
+ */
+UFI_FLUX_API void ufi_flux_classify(const float *deltas_ns, uint32_t count, float clock_ns,
+                                    uint8_t max_cells, uint8_t *cells);
+
+/**
+ * @brief Interval histogram
+ *
+ * hist[k] counts intervals in [k * bin_ns, (k + 1) * bin_ns); longer
+ * intervals go into the last bin. hist is cleared first.
+ */
+UFI_FLUX_API void ufi_flux_histogram(const float *deltas_ns, uint32_t count, float bin_ns,
+                                     uint32_t *hist, uint32_t bins);
+
+/**
+ * @brief Find a sync pattern at any bit offset
+ *
+ * @param bits          Packed bit cells, MSB first
+ * @param nbits         Valid bits
+ * @param pattern       Pattern, right-aligned (e.g. 0x4489)
+ * @param width         Pattern width in bits (1..32)
+ * @param positions     Out: bit offsets of the first pattern bit, ascending
+ * @param max_positions Capacity of positions
+ * @return Number of matches (may exceed max_positions; only the first
+ *         max_positions are stored)
+ */
+UFI_FLUX_API uint32_t ufi_flux_find_sync(const uint8_t *bits, uint32_t nbits, uint32_t pattern,
+                                         uint32_t width, uint32_t *positions, uint32_t max_positions);
+
+/**
+ * @brief Raw bit cells from any bit offset, byte aligned
+ *
+ * out[i] holds cells start_bit + 8 * i ... + 7, MSB first. Cells beyond
+ * nbits read as 0. Used where a decoder works on raw cells (Amiga
+ * longwords, GCR groups, Apple nibbles).
+ */
+UFI_FLUX_API void ufi_flux_get_bits(const uint8_t *bits, uint32_t nbits, uint32_t start_bit,
+                                    uint32_t nbytes, uint8_t *out);
+
+/**
+ * @brief MFM data bits to bytes
+ *
+ * Takes every second cell starting at start_bit + 1 (start_bit is the
+ * first clock cell, e.g. the offset of a 0x4489 sync) and packs 16 cells
+ * into one byte, MSB first. Cells beyond nbits read as 0.
+ *
+ * @param bits      Packed bit cells, MSB first
+ * @param nbits     Valid bits
+ * @param start_bit First clock cell
+ * @param nbytes    Bytes to decode (16 cells each)
+ * @param out       Output, nbytes
+ */
+UFI_FLUX_API void ufi_flux_mfm_data(const uint8_t *bits, uint32_t nbits, uint32_t start_bit,
+                                    uint32_t nbytes, uint8_t *out);
+
+/**
+ * @brief CRC-CCITT (polynomial 0x1021, MSB first, no final XOR)
+ *
+ * Chainable: pass 0xFFFF to start, or the CRC of preceding bytes. A block
+ * including its own big-endian CRC yields 0.
+ */
+UFI_FLUX_API uint16_t ufi_flux_crc16(uint16_t crc, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Apple II nibbles: frame bit cells like the disk controller
+ *
+ * Leading 0 cells are skipped, the next 8 cells (first one set) form a
+ * nibble. Self-sync FF nibbles (FF followed by 0 cells) align the stream
+ * by themselves. A nibble cut off by nbits is dropped.
+ *
+ * @param bits        Packed bit cells, MSB first
+ * @param nbits       Valid bits
+ * @param nibbles     Out: nibbles (bit 7 always set)
+ * @param positions   Out: bit offset of each nibble (optional, NULL)
+ * @param max_nibbles Capacity of nibbles/positions (nbits / 8 is always enough)
+ * @return Number of nibbles (may exceed max_nibbles; only the first
+ *         max_nibbles are stored)
+ */
+UFI_FLUX_API uint32_t ufi_flux_nibbles(const uint8_t *bits, uint32_t nbits, uint8_t *nibbles,
+                                       uint32_t *positions, uint32_t max_nibbles);
+
+/**
+ * @brief Align the bit cells of one revolution to a reference revolution
+ *
+ * The reference is split into windows of `window` cells. For each window
+ * the offset within prev +/- max_lag (prev = offset of the previous
+ * window, 0 for the first) with the fewest differing cells wins; ties
+ * keep the offset closest to prev, so repetitive gaps do not jump. Speed
+ * drift within a revolution is followed window by window.
+ *
+ * @param ref        Reference bit cells, packed, MSB first
+ * @param nref       Valid reference bits
+ * @param bits       Bit cells of the revolution to align
+ * @param nbits      Valid bits
+ * @param window     Window size in cells (multiple of 64)
+ * @param max_lag    Search radius per window in cells
+ * @param shifts     Out: offset per window, reference cell k ~ cell k + shift
+ * @param mismatches Out: differing cells per window at that offset (optional, NULL)
+ * @return Number of windows, (nref + window - 1) / window (0 on invalid arguments)
+ */
+UFI_FLUX_API uint32_t ufi_flux_align(const uint8_t *ref, uint32_t nref, const uint8_t *bits,
+                                     uint32_t nbits, uint32_t window, uint32_t max_lag,
+                                     int32_t *shifts, uint32_t *mismatches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UFI_FLUX_CORE_H */
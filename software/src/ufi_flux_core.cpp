@@ -0,0 +1,724 @@
+/**
+ * @file ufi_flux_core.cpp
+ * @brief Native flux decoding core: analysis, PLL, classification, sync search, nibbles, alignment
+ *
+ * Copyright (c) 2026 UFI Project
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ufi_flux_core.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UFI_FLUX_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define UFI_FLUX_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define UFI_FLUX_NEON 1
+#endif
+
+/*============================================================================
+ * Private Helpers
+ *============================================================================*/
+
+namespace {
+
+inline uint64_t load_be64(const uint8_t *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return __builtin_bswap64(v);
+}
+
+/** 64 cells from any bit offset; cells at or beyond nbits read as 0 */
+inline uint64_t load_bits64(const uint8_t *bits, uint32_t nbits, uint64_t pos)
+{
+    if (pos >= nbits) {
+        return 0;
+    }
+    const uint64_t nbytes = (nbits + 7) / 8;
+    const uint64_t byte = pos >> 3;
+    uint8_t tmp[9] = { 0 };
+    std::memcpy(tmp, bits + byte, (byte + 9 <= nbytes) ? 9 : nbytes - byte);
+
+    const unsigned sh = pos & 7;
+    uint64_t v = load_be64(tmp);
+    if (sh != 0) {
+        v = (v << sh) | (tmp[8] >> (8 - sh));
+    }
+    if (pos + 64 > nbits) {
+        v &= ~0ULL << (64 - (nbits - pos));
+    }
+    return v;
+}
+
+/** Every second cell of 64 (the data cells after each clock cell) */
+inline uint32_t mfm_odd_bits(uint64_t x)
+{
+    x &= 0x5555555555555555ULL;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return static_cast<uint32_t>(x);
+}
+
+/** CRC-CCITT tables: crc_table[k][b] = byte b followed by k zero bytes */
+using CrcTables = std::array<std::array<uint16_t, 256>, 8>;
+
+constexpr CrcTables make_crc_tables()
+{
+    CrcTables t{};
+    for (uint32_t b = 0; b < 256; b++) {
+        uint16_t crc = static_cast<uint16_t>(b << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+        }
+        t[0][b] = crc;
+    }
+    for (size_t k = 1; k < 8; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint16_t prev = t[k - 1][b];
+            t[k][b] = static_cast<uint16_t>((prev << 8) ^ t[0][prev >> 8]);
+        }
+    }
+    return t;
+}
+
+constexpr CrcTables crc_table = make_crc_tables();
+
+/** x + ROUND_MAGIC - ROUND_MAGIC rounds to the nearest integer (|x| < 2^22) */
+constexpr float ROUND_MAGIC = 12582912.0f;
+
+/** Nearest whole cell count, same rounding in every SIMD path */
+inline uint8_t classify_one(float delta, float inv_clock, float limit)
+{
+    float x = delta * inv_clock + 0.5f;
+    x = std::fmax(x, 0.0f);             // also maps NaN to 0
+    x = std::fmin(x, limit);
+    return static_cast<uint8_t>(x);
+}
+
+struct SyncMatcher {
+    uint32_t pattern;
+    uint32_t width;
+    uint32_t mask;
+    uint32_t *positions;
+    uint32_t max_positions;
+    uint32_t found = 0;
+
+    void emit(uint32_t pos)
+    {
+        if (found < max_positions) {
+            positions[found] = pos;
+        }
+        found++;
+    }
+
+    /** Emit hits of a bitmap (bit k = byte base + k / 8, shift k % 8) in order */
+    void emit_bitmap(uint32_t base_bit, uint32_t hits)
+    {
+        while (hits != 0) {
+            emit(base_bit + static_cast<uint32_t>(__builtin_ctz(hits)));
+            hits &= hits - 1;
+        }
+    }
+
+    /** One byte position, all 8 bit shifts */
+    uint32_t scan_window(uint64_t w) const
+    {
+        uint32_t hits = 0;
+        for (uint32_t s = 0; s < 8; s++) {
+            if (((w >> (64 - width - s)) & mask) == pattern) {
+                hits |= 1u << s;
+            }
+        }
+        return hits;
+    }
+};
+
+} // namespace
+
+/*============================================================================
+ * Version / Capabilities
+ *============================================================================*/
+
+uint32_t ufi_flux_version(void)
+{
+    return UFI_FLUX_CORE_VERSION;
+}
+
+const char *ufi_flux_simd(void)
+{
+#if defined(UFI_FLUX_AVX2)
+    return "avx2";
+#elif defined(UFI_FLUX_SSE2)
+    return "sse2";
+#elif defined(UFI_FLUX_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+/*============================================================================
+ * Revolution Analysis
+ *============================================================================*/
+
+int ufi_flux_analyze(const uint32_t *ticks, uint32_t count,
+                     const ufi_analyze_params_t *params, ufi_flux_stats_t *stats)
+{
+    if (params == nullptr || stats == nullptr || stats->deltas_ns == nullptr ||
+        stats->hist == nullptr || stats->bins == 0 || (ticks == nullptr && count != 0) ||
+        !(params->ns_per_tick > 0.0f) || !(params->bin_ns > 0.0f)) {
+        return UFI_FLUX_ERR_PARAM;
+    }
+
+    const uint32_t bins = stats->bins;
+    const float ns_per_tick = params->ns_per_tick;
+    const float inv_bin = 1.0f / params->bin_ns;
+    const float last = static_cast<float>(bins - 1);
+    float *deltas = stats->deltas_ns;
+
+    // Pass 1: intervals, histogram (four sub-histograms as in
+    // ufi_flux_histogram), sum and maximum
+    // (sum and maximum on the integer intervals: no float dependency chain)
+    std::vector<uint32_t> sub(4 * static_cast<size_t>(bins), 0);
+    uint64_t total = 0;
+    uint32_t max_ticks = 0;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t t = ticks[i] - prev;
+        const float d = static_cast<float>(t) * ns_per_tick;
+        prev = ticks[i];
+        deltas[i] = d;
+        total += t;
+        max_ticks = std::max(max_ticks, t);
+        sub[(i & 3) * bins + static_cast<uint32_t>(std::min(d * inv_bin, last))]++;
+    }
+    for (uint32_t k = 0; k < bins; k++) {
+        stats->hist[k] = sub[k] + sub[bins + k] + sub[2 * bins + k] + sub[3 * bins + k];
+    }
+
+    // Median from the histogram
+    float median = 0.0f;
+    uint32_t cum = 0;
+    const uint32_t half = count / 2;
+    for (uint32_t k = 0; k < bins && count != 0; k++) {
+        const uint32_t h = stats->hist[k];
+        if (cum + h > half) {
+            median = (static_cast<float>(k) +
+                      (static_cast<float>(half - cum) + 0.5f) / static_cast<float>(h)) * params->bin_ns;
+            break;
+        }
+        cum += h;
+    }
+
+    // Pass 2: anomalies and their runs. Anomalies are rare: each block is
+    // counted branch-free (vectorised) and only scanned if it has any
+    const float lo = params->short_factor * median;
+    const float hi = params->long_factor * median;
+    const uint32_t run_gap = params->run_gap;
+    uint32_t *runs = stats->runs;
+    const uint32_t max_runs = (runs != nullptr) ? stats->max_runs : 0;
+    uint32_t nshort = 0;
+    uint32_t nlong = 0;
+    uint32_t nruns = 0;
+    uint32_t run_first = 0;
+    uint32_t run_last = 0;
+    bool in_run = false;
+    auto emit = [&]() {
+        if (nruns < max_runs) {
+            runs[2 * nruns] = run_first;
+            runs[2 * nruns + 1] = run_last - run_first + 1;
+        }
+        nruns++;
+    };
+    for (uint32_t base = 0; base < count; base += 64) {
+        const uint32_t end = std::min(count, base + 64);
+        uint32_t block_short = 0;
+        uint32_t block_long = 0;
+        for (uint32_t i = base; i < end; i++) {
+            block_short += deltas[i] < lo;
+            block_long += deltas[i] > hi;
+        }
+        nshort += block_short;
+        nlong += block_long;
+        if (block_short + block_long == 0) {
+            continue;
+        }
+        for (uint32_t i = base; i < end; i++) {
+            if (!(deltas[i] < lo || deltas[i] > hi)) {
+                continue;
+            }
+            if (in_run && i - run_last <= run_gap) {
+                run_last = i;
+                continue;
+            }
+            if (in_run) {
+                emit();
+            }
+            run_first = run_last = i;
+            in_run = true;
+        }
+    }
+    if (in_run) {
+        emit();
+    }
+
+    stats->total_ns = static_cast<double>(total) * ns_per_tick;
+    stats->median_ns = median;
+    stats->max_ns = static_cast<float>(max_ticks) * ns_per_tick;
+    stats->short_count = nshort;
+    stats->long_count = nlong;
+    stats->nruns = nruns;
+    return UFI_FLUX_OK;
+}
+
+/*============================================================================
+ * Data Separator (PLL)
+ *============================================================================*/
+
+/*
+ * Inherently sequential (each cell depends on the clock after the previous
+ * transition), so this stays scalar; it is a handful of float operations
+ * per transition.
+ */
+int ufi_flux_pll_decode(const float *deltas_ns, uint32_t count,
+                        const ufi_pll_params_t *params, ufi_bitstream_t *out)
+{
+    if (params == nullptr || out == nullptr || out->bits == nullptr ||
+        (deltas_ns == nullptr && count != 0) || !(params->clock_ns > 0.0f)) {
+        return UFI_FLUX_ERR_PARAM;
+    }
+
+    const float centre = params->clock_ns;
+    const float clock_min = centre * (1.0f - params->tolerance);
+    const float clock_max = centre * (1.0f + params->tolerance);
+    const float period_adj = params->period_adj;
+    const float phase_keep = 1.0f - params->phase_adj;
+
+    std::memset(out->bits, 0, (out->capacity + 7) / 8);
+
+    float clock = centre;
+    float inv_clock = 1.0f / centre;
+    float ticks = 0.0f;         // Time since the last emitted cell boundary
+    uint32_t nbits = 0;
+
+    // Loop-carried latency (ticks, clock) bounds the speed: plain
+    // multiply/compare on that path, no libm calls
+    for (uint32_t i = 0; i < count; i++) {
+        ticks += deltas_ns[i];
+        float cells_f = ticks * inv_clock;
+        if (cells_f <= 0.5f) {
+            // Up to half a cell: noise, merge into next interval (exactly
+            // 0.5 would round to 0 cells below)
+            if (out->bit_pos != nullptr) out->bit_pos[i] = UINT32_MAX;
+            if (out->phase != nullptr) out->phase[i] = 0;
+            continue;
+        }
+        if (cells_f > static_cast<float>(out->capacity - nbits)) {
+            // Would overrun bits (also catches absurd gaps, e.g. timer wrap)
+            out->nbits = nbits;
+            return UFI_FLUX_ERR_OVERFLOW;
+        }
+
+        // Cells up to this transition; remainder is the phase error.
+        // Rounding by the 1.5 * 2^23 trick keeps the int conversion off
+        // the critical path.
+        float cells_r = (cells_f + ROUND_MAGIC) - ROUND_MAGIC;
+        ticks -= cells_r * clock;
+        uint32_t cells = static_cast<uint32_t>(cells_r);
+
+        uint32_t pos = nbits + cells - 1;
+        out->bits[pos >> 3] |= static_cast<uint8_t>(0x80u >> (pos & 7));
+        nbits += cells;
+
+        if (out->bit_pos != nullptr) {
+            out->bit_pos[i] = pos;
+        }
+        if (out->phase != nullptr) {
+            // |ticks| <= clock / 2, so this stays within +/-127
+            float ph = ticks * inv_clock * 254.0f;
+            out->phase[i] = static_cast<int8_t>(ph + (ph < 0.0f ? -0.5f : 0.5f));
+        }
+
+        // Clock follows the phase error within normal run lengths; long
+        // gaps (sync marks, unformatted areas) pull it back to nominal
+        if (cells <= 4) {
+            clock += ticks * period_adj;
+        } else {
+            clock += (centre - clock) * period_adj;
+        }
+        clock = std::min(std::max(clock, clock_min), clock_max);
+        inv_clock = inv_clock * (2.0f - clock * inv_clock);    // Newton step, clock moves little
+        ticks *= phase_keep;
+    }
+
+    out->nbits = nbits;
+    return UFI_FLUX_OK;
+}
+
+/*============================================================================
+ * Interval Classification
+ *============================================================================*/
+
+void ufi_flux_classify(const float *deltas_ns, uint32_t count, float clock_ns,
+                       uint8_t max_cells, uint8_t *cells)
+{
+    const float inv = 1.0f / clock_ns;
+    const float limit = static_cast<float>(max_cells) + 0.5f;
+    uint32_t i = 0;
+
+#if defined(UFI_FLUX_AVX2)
+    const __m256 vinv = _mm256_set1_ps(inv);
+    const __m256 vhalf = _mm256_set1_ps(0.5f);
+    const __m256 vzero = _mm256_setzero_ps();
+    const __m256 vlimit = _mm256_set1_ps(limit);
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(deltas_ns + i), vinv), vhalf);
+        x = _mm256_min_ps(_mm256_max_ps(x, vzero), vlimit);
+        __m256i r = _mm256_cvttps_epi32(x);
+        __m128i r16 = _mm_packus_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(cells + i), _mm_packus_epi16(r16, r16));
+    }
+#elif defined(UFI_FLUX_SSE2)
+    const __m128 vinv = _mm_set1_ps(inv);
+    const __m128 vhalf = _mm_set1_ps(0.5f);
+    const __m128 vzero = _mm_setzero_ps();
+    const __m128 vlimit = _mm_set1_ps(limit);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(deltas_ns + i), vinv), vhalf);
+        x = _mm_min_ps(_mm_max_ps(x, vzero), vlimit);
+        __m128i r = _mm_cvttps_epi32(x);
+        __m128i r16 = _mm_packs_epi32(r, r);
+        int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(r16, r16));
+        std::memcpy(cells + i, &packed, 4);
+    }
+#elif defined(UFI_FLUX_NEON)
+    const float32x4_t vinv = vdupq_n_f32(inv);
+    const float32x4_t vhalf = vdupq_n_f32(0.5f);
+    const float32x4_t vzero = vdupq_n_f32(0.0f);
+    const float32x4_t vlimit = vdupq_n_f32(limit);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vfmaq_f32(vhalf, vld1q_f32(deltas_ns + i), vinv);
+        float32x4_t b = vfmaq_f32(vhalf, vld1q_f32(deltas_ns + i + 4), vinv);
+        a = vminq_f32(vmaxnmq_f32(a, vzero), vlimit);
+        b = vminq_f32(vmaxnmq_f32(b, vzero), vlimit);
+        uint16x8_t r16 = vcombine_u16(vmovn_u32(vcvtq_u32_f32(a)), vmovn_u32(vcvtq_u32_f32(b)));
+        vst1_u8(cells + i, vmovn_u16(r16));
+    }
+#endif
+
+    for (; i < count; i++) {
+        cells[i] = classify_one(deltas_ns[i], inv, limit);
+    }
+}
+
+/*============================================================================
+ * Histogram
+ *============================================================================*/
+
+void ufi_flux_histogram(const float *deltas_ns, uint32_t count, float bin_ns,
+                        uint32_t *hist, uint32_t bins)
+{
+    if (bins == 0) {
+        return;
+    }
+
+    // Four sub-histograms avoid store-to-load stalls on runs of equal bins
+    std::vector<uint32_t> sub(4 * static_cast<size_t>(bins), 0);
+    const float inv = 1.0f / bin_ns;
+    const float last = static_cast<float>(bins - 1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        float k = std::fmin(std::fmax(deltas_ns[i] * inv, 0.0f), last);
+        sub[(i & 3) * bins + static_cast<uint32_t>(k)]++;
+    }
+    for (uint32_t k = 0; k < bins; k++) {
+        hist[k] = sub[k] + sub[bins + k] + sub[2 * bins + k] + sub[3 * bins + k];
+    }
+}
+
+/*============================================================================
+ * Sync Search
+ *============================================================================*/
+
+uint32_t ufi_flux_find_sync(const uint8_t *bits, uint32_t nbits, uint32_t pattern,
+                            uint32_t width, uint32_t *positions, uint32_t max_positions)
+{
+    if (bits == nullptr || width == 0 || width > UFI_FLUX_SYNC_MAX_WIDTH || nbits < width) {
+        return 0;
+    }
+
+    SyncMatcher m;
+    m.width = width;
+    m.mask = (width == 32) ? 0xFFFFFFFFu : ((1u << width) - 1);
+    m.pattern = pattern & m.mask;
+    m.positions = positions;
+    m.max_positions = (positions != nullptr) ? max_positions : 0;
+
+    // Byte positions with a full 64-bit window inside the buffer; any
+    // match starting there ends inside the valid bits (width <= 32)
+    const uint32_t nbytes = (nbits + 7) / 8;
+    const uint32_t full = (nbytes >= 8) ? nbytes - 7 : 0;
+    uint32_t b = 0;
+
+#if defined(UFI_FLUX_AVX2)
+    const __m256i vmask = _mm256_set1_epi64x(m.mask);
+    const __m256i vpat = _mm256_set1_epi64x(m.pattern);
+    for (; b + 4 <= full; b += 4) {
+        __m256i w = _mm256_set_epi64x(
+            static_cast<long long>(load_be64(bits + b + 3)), static_cast<long long>(load_be64(bits + b + 2)),
+            static_cast<long long>(load_be64(bits + b + 1)), static_cast<long long>(load_be64(bits + b)));
+        uint32_t hits = 0;
+        for (uint32_t s = 0; s < 8; s++) {
+            __m256i v = _mm256_and_si256(_mm256_srl_epi64(w, _mm_cvtsi32_si128(64 - width - s)), vmask);
+            uint32_t lanes = static_cast<uint32_t>(
+                _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, vpat))));
+            while (lanes != 0) {
+                uint32_t lane = static_cast<uint32_t>(__builtin_ctz(lanes));
+                hits |= 1u << (lane * 8 + s);
+                lanes &= lanes - 1;
+            }
+        }
+        m.emit_bitmap(b * 8, hits);
+    }
+#elif defined(UFI_FLUX_SSE2)
+    const __m128i vmask = _mm_set1_epi64x(m.mask);
+    const __m128i vpat = _mm_set1_epi64x(m.pattern);
+    for (; b + 2 <= full; b += 2) {
+        __m128i w = _mm_set_epi64x(static_cast<long long>(load_be64(bits + b + 1)),
+                                   static_cast<long long>(load_be64(bits + b)));
+        uint32_t hits = 0;
+        for (uint32_t s = 0; s < 8; s++) {
+            __m128i v = _mm_and_si128(_mm_srl_epi64(w, _mm_cvtsi32_si128(64 - width - s)), vmask);
+            __m128i eq = _mm_cmpeq_epi32(v, vpat);
+            eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            uint32_t lanes = static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+            if (lanes & 1) hits |= 1u << s;
+            if (lanes & 2) hits |= 1u << (8 + s);
+        }
+        m.emit_bitmap(b * 8, hits);
+    }
+#elif defined(UFI_FLUX_NEON)
+    const uint64x2_t vmask = vdupq_n_u64(m.mask);
+    const uint64x2_t vpat = vdupq_n_u64(m.pattern);
+    for (; b + 2 <= full; b += 2) {
+        uint64x2_t w = vcombine_u64(vcreate_u64(load_be64(bits + b)), vcreate_u64(load_be64(bits + b + 1)));
+        uint32_t hits = 0;
+        for (uint32_t s = 0; s < 8; s++) {
+            int64x2_t shift = vdupq_n_s64(-static_cast<int64_t>(64 - width - s));
+            uint64x2_t eq = vceqq_u64(vandq_u64(vshlq_u64(w, shift), vmask), vpat);
+            if (vgetq_lane_u64(eq, 0)) hits |= 1u << s;
+            if (vgetq_lane_u64(eq, 1)) hits |= 1u << (8 + s);
+        }
+        m.emit_bitmap(b * 8, hits);
+    }
+#endif
+
+    for (; b < full; b++) {
+        m.emit_bitmap(b * 8, m.scan_window(load_be64(bits + b)));
+    }
+
+    // Tail: zero-padded window, matches must end inside nbits
+    for (; b < nbytes; b++) {
+        uint8_t tmp[8] = { 0 };
+        std::memcpy(tmp, bits + b, nbytes - b);
+        uint32_t hits = m.scan_window(load_be64(tmp));
+        while (hits != 0) {
+            uint32_t s = static_cast<uint32_t>(__builtin_ctz(hits));
+            if (b * 8 + s + width <= nbits) {
+                m.emit(b * 8 + s);
+            }
+            hits &= hits - 1;
+        }
+    }
+
+    return m.found;
+}
+
+/*============================================================================
+ * MFM / CRC
+ *============================================================================*/
+
+void ufi_flux_get_bits(const uint8_t *bits, uint32_t nbits, uint32_t start_bit,
+                       uint32_t nbytes, uint8_t *out)
+{
+    uint64_t pos = static_cast<uint64_t>(start_bit);
+    for (uint32_t i = 0; i < nbytes; i += 8, pos += 64) {
+        uint64_t w = load_bits64(bits, nbits, pos);
+        uint32_t n = (nbytes - i < 8) ? nbytes - i : 8;
+        for (uint32_t k = 0; k < n; k++) {
+            out[i + k] = static_cast<uint8_t>(w >> (56 - 8 * k));
+        }
+    }
+}
+
+void ufi_flux_mfm_data(const uint8_t *bits, uint32_t nbits, uint32_t start_bit,
+                       uint32_t nbytes, uint8_t *out)
+{
+    // 64 cells = 4 data bytes per step
+    uint64_t pos = static_cast<uint64_t>(start_bit);
+    for (uint32_t i = 0; i < nbytes; i += 4, pos += 64) {
+        uint32_t w = mfm_odd_bits(load_bits64(bits, nbits, pos));
+        uint32_t n = (nbytes - i < 4) ? nbytes - i : 4;
+        for (uint32_t k = 0; k < n; k++) {
+            out[i + k] = static_cast<uint8_t>(w >> (24 - 8 * k));
+        }
+    }
+}
+
+/*
+ * Slicing-by-8: eight table lookups per 8 input bytes instead of one
+ * lookup per byte, no dependency between the lookups of one block.
+ */
+uint16_t ufi_flux_crc16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    const auto &t = crc_table;
+
+    while (len >= 8) {
+        crc = static_cast<uint16_t>(
+            t[7][data[0] ^ (crc >> 8)] ^ t[6][data[1] ^ (crc & 0xFF)] ^
+            t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^
+            t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]]);
+        data += 8;
+        len -= 8;
+    }
+    while (len-- != 0) {
+        crc = static_cast<uint16_t>((crc << 8) ^ t[0][(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+/*============================================================================
+ * Apple II Nibbles
+ *============================================================================*/
+
+/*
+ * Sequential like the controller's shift register (each nibble starts at
+ * the first 1 after the previous one), but a 64-cell window yields
+ * several nibbles per load and skips zero runs with one clz.
+ */
+uint32_t ufi_flux_nibbles(const uint8_t *bits, uint32_t nbits, uint8_t *nibbles,
+                          uint32_t *positions, uint32_t max_nibbles)
+{
+    if (bits == nullptr || nibbles == nullptr) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    uint64_t pos = 0;
+    while (pos < nbits) {
+        const uint64_t w = load_bits64(bits, nbits, pos);
+        unsigned used = 0;
+        while (used < 64) {
+            const uint64_t rest = w << used;
+            if (rest == 0) {
+                used = 64;
+                break;
+            }
+            const unsigned lz = static_cast<unsigned>(__builtin_clzll(rest));
+            if (used + lz + 8 > 64) {
+                used += lz;         // Nibble crosses the window: reload there
+                break;
+            }
+            const uint64_t start = pos + used + lz;
+            if (start + 8 > nbits) {
+                return count;
+            }
+            if (count < max_nibbles) {
+                nibbles[count] = static_cast<uint8_t>((rest << lz) >> 56);
+                if (positions != nullptr) {
+                    positions[count] = static_cast<uint32_t>(start);
+                }
+            }
+            count++;
+            used += lz + 8;
+        }
+        pos += used;
+    }
+    return count;
+}
+
+/*============================================================================
+ * Revolution Alignment
+ *============================================================================*/
+
+/*
+ * Each window depends on the offset of the previous one (drift is
+ * tracked, not searched globally), so this is a scalar loop; comparing a
+ * window at one offset is window / 64 XOR + popcount steps.
+ */
+uint32_t ufi_flux_align(const uint8_t *ref, uint32_t nref, const uint8_t *bits,
+                        uint32_t nbits, uint32_t window, uint32_t max_lag,
+                        int32_t *shifts, uint32_t *mismatches)
+{
+    if (ref == nullptr || bits == nullptr || shifts == nullptr ||
+        window == 0 || window % 64 != 0) {
+        return 0;
+    }
+
+    const uint32_t nwin = static_cast<uint32_t>((static_cast<uint64_t>(nref) + window - 1) / window);
+    std::vector<uint64_t> ref_words(window / 64);
+    int64_t prev = 0;
+
+    for (uint32_t w = 0; w < nwin; w++) {
+        const uint64_t start = static_cast<uint64_t>(w) * window;
+        const uint32_t len = static_cast<uint32_t>(std::min<uint64_t>(window, nref - start));
+        const uint32_t words = (len + 63) / 64;
+        for (uint32_t i = 0; i < words; i++) {
+            ref_words[i] = load_bits64(ref, nref, start + 64 * i);
+        }
+        const uint64_t last_mask = (len % 64 == 0) ? ~0ULL : ~0ULL << (64 - len % 64);
+
+        uint32_t best = UINT32_MAX;
+        int64_t best_lag = prev;
+        // prev, prev + 1, prev - 1, prev + 2, ... (ties keep the nearest)
+        for (uint32_t d = 0; d <= 2 * max_lag; d++) {
+            const int64_t lag = prev + ((d & 1) ? static_cast<int64_t>((d + 1) / 2)
+                                                : -static_cast<int64_t>(d / 2));
+            const int64_t pos = static_cast<int64_t>(start) + lag;
+            uint32_t miss = 0;
+            for (uint32_t i = 0; i < words && miss < best; i++) {
+                const int64_t p = pos + 64 * static_cast<int64_t>(i);
+                uint64_t b;
+                if (p >= 0) {
+                    b = load_bits64(bits, nbits, static_cast<uint64_t>(p));
+                } else if (p > -64) {
+                    b = load_bits64(bits, nbits, 0) >> (-p);
+                } else {
+                    b = 0;
+                }
+                uint64_t diff = ref_words[i] ^ b;
+                if (i == words - 1) {
+                    diff &= last_mask;
+                }
+                miss += static_cast<uint32_t>(__builtin_popcountll(diff));
+            }
+            if (miss < best) {
+                best = miss;
+                best_lag = lag;
+                if (miss == 0) {
+                    break;
+                }
+            }
+        }
+
+        shifts[w] = static_cast<int32_t>(best_lag);
+        if (mismatches != nullptr) {
+            mismatches[w] = best;
+        }
+        prev = best_lag;
+    }
+    return nwin;
+}
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+UFI Format-Decoder - Regressionstest
+
+Synthetische Tracks je Format (IBM MFM, Amiga, 1541 GCR, Apple 6-and-2 und
+5-and-3) laufen als Flux durch FluxProcessor.process_track: Format-
+Erkennung, Datenseparator, Ausrichtung und Dekodierung. Geprüft werden
+Format, Sektornummern, Daten und CRC-Status; je Track ist ein Sektor mit
+falscher Prüfsumme geschrieben.
+
+    cmake -S software -B software/build && cmake --build software/build
+    ctest --test-dir software/build
+
+oder direkt: UFI_FLUX_CORE=software/build/libufi_flux.so python3 -m unittest discover software/tests
+"""
+
+import binascii
+import logging
+import os
+import struct
+import sys
+import unittest
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'cm5'))
+
+import ufi_processor as up  # noqa: E402
+
+TICK_NS = up.FLUX_NS_PER_TICK
+JITTER_NS = 50              # Flanken-Jitter (gleichverteilt ±)
+REVOLUTIONS = 3
+
+
+# ============================================================================
+# BITZELLEN → FLUX
+# ============================================================================
+
+def cells_to_revolution(cells: np.ndarray, cell_ns: float, rng,
+                        revolution: int) -> up.FluxRevolution:
+    """Bitzellen (1 = Flusswechsel) als Timer-Ticks seit Index, 300 RPM"""
+    t = (np.flatnonzero(cells) + 1) * cell_ns
+    t = t + rng.uniform(-JITTER_NS, JITTER_NS, t.size)
+    return up.FluxRevolution(ticks=np.round(t / TICK_NS).astype(np.uint32),
+                             index_time=int(round(cells.size * cell_ns / TICK_NS)),
+                             revolution=revolution)
+
+
+def byte_cells(data: bytes) -> list:
+    """Bytes unkodiert als Zellen (GCR-Sync, Apple-Nibbles), MSB zuerst"""
+    return [(b >> k) & 1 for b in data for k in range(7, -1, -1)]
+
+
+# ============================================================================
+# MFM (IBM, Amiga)
+# ============================================================================
+
+def mfm_cells(data: bytes, syncs=()) -> list:
+    """MFM-Kodierung; Bytes an den Positionen in syncs als A1 ohne Takt (4489)"""
+    out, prev = [], 0
+    for i, b in enumerate(data):
+        for k in range(7, -1, -1):
+            d = (b >> k) & 1
+            out += [1 if prev == 0 and d == 0 else 0, d]
+            prev = d
+        if i in syncs:
+            out[-6] = 0     # fehlender Takt zwischen Bit 4 und 5
+    return out
+
+
+def ibm_track(cyl: int, head: int, sectors: int, bad: int, rng):
+    """IBM System/34 Track, 512-Byte Sektoren ab 1, DD 100000 Zellen"""
+    buf, syncs, payloads = bytearray(b'\x4e' * 80 + b'\x00' * 12 + b'\xc2' * 3 + b'\xfc'
+                                     + b'\x4e' * 50), set(), {}
+
+    def mark(block: bytes, flip: bool = False):
+        buf.extend(b'\x00' * 12)
+        syncs.update(range(len(buf), len(buf) + 3))
+        crc = binascii.crc_hqx(b'\xa1\xa1\xa1' + block, 0xFFFF) ^ (1 if flip else 0)
+        buf.extend(b'\xa1\xa1\xa1' + block + struct.pack('>H', crc))
+
+    for r in range(1, sectors + 1):
+        mark(bytes([0xFE, cyl, head, r, 2]))
+        buf.extend(b'\x4e' * 22)
+        payloads[r] = rng.integers(0, 256, 512, dtype=np.uint8).tobytes()
+        mark(b'\xfb' + payloads[r], flip=(r == bad))
+        buf.extend(b'\x4e' * 84)
+    buf.extend(b'\x4e' * (100000 // 16 - len(buf)))
+    return np.array(mfm_cells(bytes(buf), syncs), np.uint8), payloads
+
+
+def amiga_track(cyl: int, head: int, bad: int, rng):
+    """AmigaDOS Track, 11 Sektoren, Odd/Even-Langworte mit XOR-Prüfsummen"""
+    def odd_even(longs):
+        # Je Langwort 16 ungerade, dann 16 gerade Bits; ganze Blöcke nacheinander
+        def squeeze(x):
+            return sum(((x >> (2 * k)) & 1) << k for k in range(16))
+        return ([squeeze(v >> 1) for v in longs], [squeeze(v) for v in longs])
+
+    def checksum(halves):
+        x = 0
+        for h in halves:
+            x ^= h
+        return sum(((x >> k) & 1) << (2 * k) for k in range(16))
+
+    def words(halves):
+        return b''.join(struct.pack('>H', h) for h in halves)
+
+    buf, syncs, payloads = bytearray(), set(), {}
+    for s in range(11):
+        buf.extend(b'\x00\x00')
+        syncs.update((len(buf), len(buf) + 1))
+        buf.extend(b'\xa1\xa1')
+        info = odd_even([(0xFF << 24) | ((cyl * 2 + head) << 16) | (s << 8) | (11 - s)])
+        label = odd_even([0, 0, 0, 0])
+        payloads[s] = rng.integers(0, 256, 512, dtype=np.uint8).tobytes()
+        data = odd_even(list(struct.unpack('>128I', payloads[s])))
+        header_sum = odd_even([checksum(info[0] + info[1] + label[0] + label[1])])
+        data_sum = odd_even([checksum(data[0] + data[1]) ^ (1 if s == bad else 0)])
+        for odd, even in (info, label, header_sum, data_sum, data):
+            buf.extend(words(odd) + words(even))
+    buf.extend(b'\x00' * (100000 // 16 - len(buf)))
+    return np.array(mfm_cells(bytes(buf), syncs), np.uint8), payloads
+
+
+# ============================================================================
+# 1541 GCR
+# ============================================================================
+
+GCR_1541 = (0x0A, 0x0B, 0x12, 0x13, 0x0E, 0x0F, 0x16, 0x17,
+            0x09, 0x19, 0x1A, 0x1B, 0x0D, 0x1D, 0x1E, 0x15)
+
+
+def gcr_cells(data: bytes) -> list:
+    return [(GCR_1541[n] >> k) & 1 for b in data for n in (b >> 4, b & 15)
+            for k in range(4, -1, -1)]
+
+
+def c64_track(track: int, bad: int, rng, disk_id: bytes = b'AB'):
+    """1541 Track (0-basiert, Header trägt track + 1), Zone 2: 19 Sektoren à 3500 ns"""
+    cells, payloads = [], {}
+    for s in range(19):
+        chk = s ^ (track + 1) ^ disk_id[1] ^ disk_id[0]
+        cells += byte_cells(b'\xff' * 5)
+        cells += gcr_cells(bytes([0x08, chk, s, track + 1, disk_id[1], disk_id[0], 0x0F, 0x0F]))
+        cells += byte_cells(b'\x55' * 9 + b'\xff' * 5)
+        payloads[s] = rng.integers(0, 256, 256, dtype=np.uint8).tobytes()
+        x = np.bitwise_xor.reduce(np.frombuffer(payloads[s], np.uint8)) ^ (1 if s == bad else 0)
+        cells += gcr_cells(b'\x07' + payloads[s] + bytes([x, 0, 0]))
+        cells += byte_cells(b'\x55' * 8)
+    n = int(200e6 / 3500)
+    cells += byte_cells(b'\x55' * ((n - len(cells)) // 8 + 1))
+    return np.array(cells[:n], np.uint8), payloads
+
+
+# ============================================================================
+# APPLE II (6-and-2 / 5-and-3)
+# ============================================================================
+
+WRITE_62 = (
+    0x96, 0x97, 0x9A, 0x9B, 0x9D, 0x9E, 0x9F, 0xA6, 0xA7, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB2, 0xB3,
+    0xB4, 0xB5, 0xB6, 0xB7, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xCB, 0xCD, 0xCE, 0xCF, 0xD3,
+    0xD6, 0xD7, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE5, 0xE6, 0xE7, 0xE9, 0xEA, 0xEB, 0xEC,
+    0xED, 0xEE, 0xEF, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF)
+WRITE_53 = (
+    0xAB, 0xAD, 0xAE, 0xAF, 0xB5, 0xB6, 0xB7, 0xBA, 0xBB, 0xBD, 0xBE, 0xBF, 0xD6, 0xD7, 0xDA, 0xDB,
+    0xDD, 0xDE, 0xDF, 0xEA, 0xEB, 0xED, 0xEE, 0xEF, 0xF5, 0xF6, 0xF7, 0xFA, 0xFB, 0xFD, 0xFE, 0xFF)
+
+
+def prenibble_62(d: bytes) -> list:
+    """DOS 3.3 RWTS: 86 Hilfswerte (je 3 × 2 Bit vertauscht), dann 256 × obere 6 Bit"""
+    def swap(v):
+        return ((v & 1) << 1) | ((v & 2) >> 1)
+    aux = [swap(d[i] & 3) | (swap(d[i + 86] & 3) << 2) |
+           ((swap(d[i + 172] & 3) << 4) if i + 172 < 256 else 0) for i in range(86)]
+    return aux + [b >> 2 for b in d]
+
+
+def prenibble_53(d: bytes) -> list:
+    """DOS 3.2 RWTS: 154 Drei-Bit-Werte (rückwärts), dann 256 × obere 5 Bit"""
+    top, low = [0] * 256, [0] * 154
+    for j in range(50, -1, -1):
+        b = d[(50 - j) * 5:(50 - j) * 5 + 5]
+        top[j], top[j + 51], top[j + 102], top[j + 153], top[j + 204] = (x >> 3 for x in b)
+        low[j] = (b[0] & 7) << 2 | (b[3] & 4) >> 1 | (b[4] & 4) >> 2
+        low[j + 51] = (b[1] & 7) << 2 | (b[3] & 2) | (b[4] & 2) >> 1
+        low[j + 102] = (b[2] & 7) << 2 | (b[3] & 1) << 1 | (b[4] & 1)
+    top[255], low[153] = d[255] >> 3, d[255] & 7
+    return low[::-1] + top
+
+
+def apple_track(track: int, sectors: int, bad: int, rng, volume: int = 254):
+    """Disk II Track, 16 (6-and-2) oder 13 (5-and-3) Sektoren, 4 µs Zellen"""
+    cells, payloads = [], {}
+
+    def sync(n):
+        for _ in range(n):
+            cells.extend(byte_cells(b'\xff') + [0, 0])
+
+    def four_four(v):
+        return bytes([(v >> 1) | 0xAA, v | 0xAA])
+
+    prenibble, table = (prenibble_62, WRITE_62) if sectors == 16 else (prenibble_53, WRITE_53)
+    sync(30 if sectors == 16 else 40)
+    for s in range(sectors):
+        cells.extend(byte_cells(bytes([0xD5, 0xAA, 0x96 if sectors == 16 else 0xB5])
+                                + four_four(volume) + four_four(track) + four_four(s)
+                                + four_four(volume ^ track ^ s) + b'\xde\xaa\xeb'))
+        sync(6)
+        payloads[s] = rng.integers(0, 256, 256, dtype=np.uint8).tobytes()
+        prev, nibbles = 0, []
+        for v in prenibble(payloads[s]):
+            nibbles.append(table[v ^ prev])
+            prev = v
+        nibbles.append(table[prev ^ (1 if s == bad else 0)])
+        cells.extend(byte_cells(b'\xd5\xaa\xad' + bytes(nibbles) + b'\xde\xaa\xeb'))
+        sync(14)
+    while len(cells) < 50000:
+        sync(1)
+    return np.array(cells[:50000], np.uint8), payloads
+
+
+# ============================================================================
+# TESTS
+# ============================================================================
+
+class DecoderRegressionTest(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        logging.getLogger('ufi-cm5').setLevel(logging.WARNING)
+        cls.processor = up.FluxProcessor()
+        if cls.processor.core is None:
+            raise unittest.SkipTest('libufi_flux nicht gefunden (UFI_FLUX_CORE)')
+
+    def decode(self, track: int, cells: np.ndarray, cell_ns: float, seed: int):
+        rng = np.random.default_rng(seed)
+        revolutions = [cells_to_revolution(cells, cell_ns, rng, r) for r in range(REVOLUTIONS)]
+        self.processor.new_disk()
+        return self.processor.process_track(up.FluxTrack(track, 0, revolutions))
+
+    def check(self, result, fmt: up.DiskFormat, payloads: dict, bad: int):
+        self.assertEqual(result.format, fmt)
+        self.assertEqual(sorted(s.number for s in result.sectors), sorted(payloads))
+        for sector in result.sectors:
+            with self.subTest(sector=sector.number):
+                self.assertEqual(sector.crc_ok, sector.number != bad)
+                if sector.crc_ok:
+                    self.assertEqual(sector.data, payloads[sector.number])
+
+    def test_ibm_mfm_dd(self):
+        cells, payloads = ibm_track(2, 0, 9, bad=4, rng=np.random.default_rng(1))
+        self.check(self.decode(2, cells, 2000, seed=11), up.DiskFormat.PC_MFM_DD, payloads, bad=4)
+
+    def test_amiga_dd(self):
+        cells, payloads = amiga_track(2, 0, bad=3, rng=np.random.default_rng(2))
+        self.check(self.decode(2, cells, 2000, seed=12), up.DiskFormat.AMIGA_DD, payloads, bad=3)
+
+    def test_c64_gcr(self):
+        cells, payloads = c64_track(20, bad=5, rng=np.random.default_rng(3))
+        self.check(self.decode(20, cells, 3500, seed=13), up.DiskFormat.C64_GCR, payloads, bad=5)
+
+    def test_apple_62(self):
+        cells, payloads = apple_track(3, 16, bad=7, rng=np.random.default_rng(4))
+        self.check(self.decode(3, cells, 4000, seed=14), up.DiskFormat.APPLE_II_GCR, payloads, bad=7)
+
+    def test_apple_53(self):
+        cells, payloads = apple_track(3, 13, bad=2, rng=np.random.default_rng(5))
+        self.check(self.decode(3, cells, 4000, seed=15), up.DiskFormat.APPLE_II_GCR, payloads, bad=2)
+
+
+if __name__ == '__main__':
+    unittest.main()